@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Bump allocator for short-lived scratch data (typically reset once per frame).
+//
+// Allocations are never freed individually; arena_reset() releases everything at
+// once. When the current block is full a larger block is chained in, so pointers
+// stay valid until the next reset. On reset, a chain is coalesced into one block
+// sized for the peak, so steady-state frames allocate nothing.
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct Arena {
+	ArenaBlock* head; // owned, newest block first
+	size_t used;      // bytes used in head
+	size_t peak;      // bytes used across all blocks since the last reset
+	size_t min_block; // minimum size of a new block
+} Arena;
+
+void arena_init(Arena* self, size_t min_block);
+void arena_destroy(Arena* self);
+
+// Frees all allocations made since the last reset.
+void arena_reset(Arena* self);
+
+// Returns `size` bytes aligned to `align` (a power of two), or NULL on OOM.
+void* arena_alloc(Arena* self, size_t size, size_t align);
+
+// Typed helper: arena_alloc for `count` elements of `type`.
+#define ARENA_ALLOC_ARRAY(arena, type, count) ((type*)arena_alloc((arena), sizeof(type) * (size_t)(count), _Alignof(type)))
+
+// Bytes reserved by the arena's blocks.
+size_t arena_capacity(const Arena* self);
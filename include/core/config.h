@@ -74,6 +74,17 @@ typedef struct LightingConfig {
 	float quantize_low_cutoff;
 } LightingConfig;
 
+// Dynamic resolution: the 3D view renders at `scale` * internal size and is upscaled.
+// The controller steps `scale` within [min_scale, max_scale] to keep the 3D pass
+// under `target_ms`.
+typedef struct DynamicResolutionConfig {
+	bool enabled;
+	float target_ms;
+	float min_scale;
+	float max_scale;
+	float step;
+} DynamicResolutionConfig;
+
 typedef struct WeaponBalanceConfig {
 	int ammo_per_shot;
 	float shot_cooldown_s;
@@ -123,8 +134,24 @@ typedef struct RenderConfig {
 	int internal_height;
 	float fov_deg;
 	bool vga_mode;
+	// Color key precision of the VGA palette remap: 15 (RGB555), 16 (RGB565) or 18 (RGB666).
+	int vga_lut_bits;
 	bool point_lights_enabled;
+	// Keep a full float-per-pixel world depth buffer for billboard occlusion instead of
+	// the compact per-column depth spans (debugging/comparison).
+	bool depth_pixels;
+	// Draw the 3D view and the UI (weapon, HUD, console, ...) as separate layers that
+	// are composited at present time; the 3D layer keeps its own (dynamic) size.
+	bool ui_layer;
+	// Draw game frames directly into a locked streaming texture (two in rotation) instead
+	// of copying the framebuffer with SDL_UpdateTexture. Ignored while ui_layer is on.
+	bool present_lock;
+	// Threads rasterizing gore and particles (render/compositor.h); 0 = one per CPU.
+	int composite_threads;
+	// Memory budget of the pre-scaled particle image cache (render/image_cache.h); 0 = off.
+	int image_cache_kb;
 	LightingConfig lighting;
+	DynamicResolutionConfig dynamic_resolution;
 } RenderConfig;
 
 typedef struct AudioConfig {
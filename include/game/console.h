@@ -2,6 +2,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "platform/input.h"
 #include "render/framebuffer.h"
@@ -63,6 +64,9 @@ struct Console {
 
 	ConsoleCommand commands[64];
 	int command_count;
+
+	// Bumped whenever what console_draw shows may have changed.
+	uint32_t version;
 };
 
 void console_init(Console* con);
@@ -28,6 +28,8 @@ typedef struct TextureRegistry TextureRegistry;
 typedef struct HudSystem HudSystem;
 typedef struct Notifications Notifications;
 typedef struct Doors Doors;
+typedef struct DynRes DynRes;
+typedef struct Compositor Compositor;
 
 // Command wiring context. Commands call into engine systems through pointers here.
 // Keep this POD and owned by main.
@@ -85,7 +87,10 @@ typedef struct ConsoleCommandContext {
 	Doors* doors;
 	PerfTrace* perf;
 	Framebuffer* fb;
+	// wall_depth covers the world pass, which renders at dynres->width x height.
 	float* wall_depth;
+	const DynRes* dynres;
+	Compositor* compositor;
 	float* gameplay_time_s;
 
 	// Music bookkeeping.
@@ -101,3 +106,8 @@ typedef struct ConsoleCommandContext {
 // Registers the built-in Mortum console commands onto `con`.
 // `ctx` is not captured; it is passed via console_update()'s user_ctx.
 void console_commands_register_all(Console* con);
+
+// Applies the render settings that take more than reading the config each frame (VGA
+// palette mode and its lookup tables, compositor threads). Called once wired up, and
+// after every config change or reload.
+void console_commands_apply_render_config(ConsoleCommandContext* ctx);
@@ -6,6 +6,7 @@
 #include "game/entities.h"
 #include "game/player.h"
 #include "game/world.h"
+#include "render/dynres.h"
 #include "render/framebuffer.h"
 
-void debug_overlay_draw(FontSystem* font, Framebuffer* fb, const Player* player, const World* world, const EntitySystem* entities, int fps);
+void debug_overlay_draw(FontSystem* font, Framebuffer* fb, const Player* player, const World* world, const EntitySystem* entities, const DynRes* dynres, int fps);
@@ -5,12 +5,15 @@
 
 #include "assets/asset_paths.h"
 #include "assets/map_loader.h"
+#include "core/arena.h"
 #include "core/base.h"
 #include "game/ammo.h"
 #include "game/physics_body.h"
 #include "game/particle_emitters.h"
 
 #include "render/camera.h"
+#include "render/depth_pyramid.h"
+#include "render/depth_spans.h"
 #include "render/framebuffer.h"
 #include "render/lighting.h"
 #include "render/texture.h"
@@ -458,7 +461,14 @@ uint32_t entity_system_query_circle(EntitySystem* es, float x, float y, float ra
 // Renders billboard sprites for entities with def.sprite set.
 // Uses depth buffers for occlusion against the already-rendered world:
 // - wall_depth: per-column nearest wall distance
-// - depth_pixels: per-pixel nearest world distance (walls + floors + ceilings)
+// - depth_pixels: per-pixel nearest world distance (walls + floors + ceilings), optional
+// - depth_spans: per-column depth spans for the same pixels; used when depth_pixels is NULL
+// - depth_pyramid: optional coarse tile/column depth used to reject or accept whole sprites
+// - frame_arena: per-frame scratch for the draw list (no cap on sprite count); required
+// Sprites outside the horizontal FOV are culled before sorting; the rest are drawn back to
+// front (stable radix sort on depth).
+// Drawn sprite pixels are written back to whichever per-pixel representation is in use (and
+// to the pyramid) so later billboards (particles, gore) also occlude against sprites.
 void entity_system_draw_sprites(
 	const EntitySystem* es,
 	Framebuffer* fb,
@@ -468,7 +478,10 @@ void entity_system_draw_sprites(
 	TextureRegistry* texreg,
 	const AssetPaths* paths,
 	const float* wall_depth,
-	float* depth_pixels
+	float* depth_pixels,
+	DepthSpans* depth_spans,
+	DepthPyramid* depth_pyramid,
+	Arena* frame_arena
 );
 
 uint32_t entity_system_alive_count(const EntitySystem* es);
@@ -8,6 +8,9 @@
 // Purpose-built gore/blood system (separate from particles) for persistent, "sticky" splats.
 // Gore stamps are procedurally generated blobs that currently stamp onto floors only (no wall/ceiling decals)
 // and are pooled separately from the particle emitter pipeline.
+// Persistent stamps resting on a floor are baked into the world's floor decal layer on the
+// next gore_tick and leave the pool, so the pool only bounds stamps that are still live
+// (timed ones, and any that could not be baked); baked gore is bounded by the decal atlas.
 
 #define GORE_STAMP_MAX_DEFAULT 512
 #define GORE_CHUNK_MAX_DEFAULT 768
@@ -17,6 +20,8 @@ typedef struct World World;
 typedef struct Camera Camera;
 typedef struct TextureRegistry TextureRegistry;
 typedef struct AssetPaths AssetPaths;
+typedef struct Compositor Compositor;
+typedef struct FloorDecals FloorDecals;
 
 typedef struct GoreSample {
         float off_x;      // offset along world X (world units)
@@ -31,6 +36,7 @@ typedef struct GoreStamp {
         bool alive;
         uint32_t age_ms;
         uint32_t life_ms; // 0 => persistent
+        bool bake_failed; // not on a floor or the decal atlas is full; stays live
 
         float x;
         float y;
@@ -70,11 +76,16 @@ typedef struct GoreSystem {
         GoreChunk* chunks; // owned
         int chunk_alive;
 
+        bool bake_fail_logged; // the first failed floor decal bake was logged
+
         // Per-frame stats (cleared by gore_begin_frame).
         uint32_t stats_spawned;
         uint32_t stats_dropped;
-        uint32_t stats_drawn_samples;
-        uint32_t stats_pixels_written;
+        uint32_t stats_early_rejected; // samples/chunks hidden per the depth pyramid
+        uint32_t stats_early_accepted; // samples/chunks drawn without per-pixel depth tests
+        uint32_t stats_chunks_settled; // chunks resolved by gore_settle_chunk instead of flown
+        uint32_t stats_baked;          // stamps baked into the floor decal layer
+        uint32_t stats_bake_failed;    // stamps on a floor that did not fit in the decal atlas
 } GoreSystem;
 
 typedef struct GoreSpawnParams {
@@ -96,7 +107,8 @@ void gore_shutdown(GoreSystem* self);
 void gore_reset(GoreSystem* self);
 
 void gore_begin_frame(GoreSystem* self);
-void gore_tick(GoreSystem* self, const World* world, uint32_t dt_ms);
+// Ages stamps, flies chunks, and bakes persistent stamps into `decals` (may be NULL).
+void gore_tick(GoreSystem* self, const World* world, FloorDecals* decals, uint32_t dt_ms);
 
 // Spawns a procedural gore stamp. Drops newest when pool is full.
 bool gore_spawn(GoreSystem* self, const GoreSpawnParams* params);
@@ -118,13 +130,28 @@ bool gore_spawn_chunk(
         uint32_t life_ms,
         int last_valid_sector);
 
-// Draws all alive gore stamps using procedural droplets; respects depth/wall occlusion.
-void gore_draw(
+// Same parameters as gore_spawn_chunk, for chunks nobody can see in flight: solves the
+// ballistic arc against the floor in closed form and stamps where the chunk would land.
+// Returns false (and stamps nothing) when the chunk would die on a wall or the ceiling,
+// or outlive `life_ms` before landing. Walls are only tested along the straight path.
+bool gore_settle_chunk(
         GoreSystem* self,
-        Framebuffer* fb,
         const World* world,
-        const Camera* cam,
-        int start_sector,
-        const float* wall_depth,
-        const float* depth_pixels);
+        float x,
+        float y,
+        float z,
+        float vx,
+        float vy,
+        float vz,
+        float radius,
+        float r,
+        float g,
+        float b,
+        uint32_t life_ms,
+        int last_valid_sector);
 
+// Projects all live chunks and stamp samples as opaque squares and pushes them to `comp`
+// (opened with compositor_begin), which draws them on compositor_flush, depth-tested
+// against the world. Samples hidden per the compositor's depth pyramid are dropped here.
+// Pixel and drawn counts are reported by the compositor.
+void gore_submit(GoreSystem* self, Compositor* comp, const World* world, const Camera* cam, int start_sector);
@@ -12,6 +12,20 @@
 #include "assets/asset_paths.h"
 #include "render/texture.h"
 
+// The player values the HUD widgets show (see hud_version).
+typedef struct HudView {
+	int health;
+	int health_max;
+	int mortum_pct;
+	int ammo;
+	int ammo_max;
+	int keys;
+	int weapon;
+	bool undead_active;
+	int undead_shards_collected;
+	int undead_shards_required;
+} HudView;
+
 typedef struct HudSystem {
 	HudAsset asset;
 	bool loaded;
@@ -23,6 +37,9 @@ typedef struct HudSystem {
 	const Texture* panel_bg_tex; // optional cached (if widgets.panel.background.mode == image)
 
 	char hud_filename[64];
+
+	HudView view;     // values as of the last hud_version call
+	uint32_t version; // bumped when `view` changes or the HUD is reloaded
 } HudSystem;
 
 // Startup: loads and validates the HUD asset referenced by cfg->ui.hud.file.
@@ -35,5 +52,9 @@ bool hud_system_reload(HudSystem* hud, const CoreConfig* cfg, const AssetPaths*
 
 void hud_system_shutdown(HudSystem* hud);
 
+// Returns a counter that changes whenever hud_draw would draw something different for
+// `player` (at the same framebuffer size).
+uint32_t hud_version(HudSystem* hud, const Player* player);
+
 // Immediate-mode draw (no per-frame allocations, no disk I/O).
 void hud_draw(HudSystem* hud, Framebuffer* fb, const Player* player, const GameState* state, int fps, TextureRegistry* texreg, const AssetPaths* paths);
@@ -4,8 +4,11 @@
 #include <stdint.h>
 
 #include "game/particles.h"
+#include "game/sector_visibility.h"
 
 #define PARTICLE_EMITTER_MAX 256
+// Upper bound on particles spawned at once when a gated emitter fast-forwards.
+#define PARTICLE_EMITTER_FAST_FORWARD_MAX 128
 
 typedef struct ParticleVec3 {
 	float x;
@@ -64,7 +67,9 @@ typedef struct ParticleEmitters {
 	// Per-frame stats (cleared by particle_emitters_begin_frame).
 	uint32_t stats_emitters_updated;
 	uint32_t stats_emitters_gated;
+	uint32_t stats_emitters_offscreen; // gated because their sector is not visible
 	uint32_t stats_particles_spawn_attempted;
+	uint32_t stats_particles_fast_forwarded;
 
 	// Runtime state.
 	float x[PARTICLE_EMITTER_MAX];
@@ -73,7 +78,15 @@ typedef struct ParticleEmitters {
 	int sector[PARTICLE_EMITTER_MAX];
 	int last_valid_sector[PARTICLE_EMITTER_MAX];
 	uint32_t emit_accum_ms[PARTICLE_EMITTER_MAX];
+	// Time spent gated (capped at one particle lifetime plus an interval) and whether the
+	// emitter moved meanwhile; used to fast-forward when it is visible again.
+	uint32_t gated_ms[PARTICLE_EMITTER_MAX];
+	bool moved_while_gated[PARTICLE_EMITTER_MAX];
 	uint32_t spawn_counter[PARTICLE_EMITTER_MAX];
+	// Interned particle template per emitter, valid while template_epoch matches
+	// Particles.template_epoch (0 = not interned yet).
+	uint16_t template_id[PARTICLE_EMITTER_MAX];
+	uint32_t template_epoch[PARTICLE_EMITTER_MAX];
 
 	ParticleEmitterDef def[PARTICLE_EMITTER_MAX];
 } ParticleEmitters;
@@ -106,6 +119,10 @@ void particle_emitter_set_pos(
 	float y,
 	float z);
 
+// Emits from every alive emitter that may be seen: its sector is in `vis` (NULL = no
+// visibility data) and it shares the player's sector or has line of sight to the player.
+// Gated emitters are not simulated; when they pass again they fast-forward, spawning the
+// particles a steady emitter would have alive by then (see emitter_fast_forward).
 void particle_emitters_update(
 	ParticleEmitters* self,
 	const World* world,
@@ -113,4 +130,5 @@ void particle_emitters_update(
 	float player_x,
 	float player_y,
 	int player_sector,
+	const SectorVisibility* vis,
 	uint32_t dt_ms);
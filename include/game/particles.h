@@ -6,6 +6,16 @@
 // World-owned particle pool.
 // Particles are lightweight, pool-allocated, and always run their lifecycle to completion.
 // Rendering is allowed to cull/occlude particles without affecting lifecycle.
+//
+// The pool is dense: slots [0 .. alive_count) are exactly the live particles. Spawning
+// appends and expiry swap-removes, so spawn is O(1) and tick/draw cost scales with
+// alive_count rather than capacity. Slots are not stable across ticks; nothing holds
+// on to individual particles.
+//
+// Instances are stored as parallel arrays (SoA). Tick advances ages and finds expired
+// particles with the dispatched array kernels (render/simd.h); submit evaluates
+// keyframes and projects each particle into a screen-space item for the compositor
+// (render/compositor.h), which rasterizes them.
 
 #define PARTICLE_MAX_DEFAULT 4096
 
@@ -26,51 +36,75 @@ typedef struct ParticleKeyframe {
 	float off_z;
 } ParticleKeyframe;
 
-typedef struct Particle {
-	bool alive;
+// Everything particles from one emitter have in common. Interned in the pool (see
+// particles_template_intern), so each live particle only stores a 16-bit id.
+// Zero-initialize before filling: templates are compared bytewise.
+typedef struct ParticleTemplate {
+	uint32_t life_ms;
 	bool has_image;
 	ParticleShape shape;
 	char image[64]; // filename under Assets/Images/Particles/ (no path)
 
-	uint32_t age_ms;
-	uint32_t life_ms;
-
-	// Spawn-time origin in world space (emitter position at spawn).
-	float origin_x;
-	float origin_y;
-	float origin_z;
-
 	// Keyframes (start/end values).
 	ParticleKeyframe start;
 	ParticleKeyframe end;
 
-	// Offset jitter sampled once at spawn.
-	float jitter_start_x;
-	float jitter_start_y;
-	float jitter_start_z;
-	float jitter_end_x;
-	float jitter_end_y;
-	float jitter_end_z;
+	// Per-particle offset jitter amplitude; the offsets come from Particle.jitter_seed.
+	float offset_jitter;
 
-	// Optional discrete screen-space rotation.
+	// Optional discrete screen-space rotation: rot_step_deg every rot_step_ms of age.
 	bool rotate_enabled;
-	float rot_deg;
 	float rot_step_deg;
 	uint32_t rot_step_ms;
-	uint32_t rot_accum_ms;
+} ParticleTemplate;
+
+#define PARTICLE_TEMPLATE_MAX 256
+
+// Per-instance state (the spawn record; the pool stores it split into arrays).
+// Keyframes, image, shape and rotation live in the template; jitter offsets and the
+// rotation angle are derived from the seed and age when drawn.
+typedef struct Particle {
+	// Spawn-time origin in world space (emitter position at spawn).
+	float origin_x;
+	float origin_y;
+	float origin_z;
+
+	uint32_t age_ms;
+	uint32_t life_ms; // copied from the template so ticking never touches templates
+	uint32_t jitter_seed;
+	uint16_t template_id;
 } Particle;
 
 typedef struct Particles {
 	bool initialized;
 	int capacity;
-	Particle* items; // owned, length=capacity
 	int alive_count;
 
+	// Live particles, slots [0 .. alive_count) of each owned array (length=capacity).
+	float* origin_x;
+	float* origin_y;
+	float* origin_z;
+	uint32_t* age_ms;
+	uint32_t* life_ms;
+	uint32_t* jitter_seed;
+	uint16_t* template_id;
+
+	ParticleTemplate* templates; // owned, PARTICLE_TEMPLATE_MAX
+	uint32_t* template_hash;     // owned, parallel to templates
+	int template_count;
+	// Changes whenever the template table is cleared (init/reset), so callers caching
+	// template ids can tell they are stale. Never 0.
+	uint32_t template_epoch;
+	// Per-submit texture lookups, one per template (owned scratch).
+	const struct Texture** template_tex;
+	bool* template_tex_valid;
+
 	// Per-frame stats (cleared by particles_begin_frame).
 	uint32_t stats_spawned;
 	uint32_t stats_dropped;
-	uint32_t stats_drawn_particles;
-	uint32_t stats_pixels_written;
+	uint32_t stats_listed; // particles projected on screen (in front, visible keyframe)
+	uint32_t stats_early_rejected; // whole particle hidden per the depth pyramid
+	uint32_t stats_early_accepted; // whole particle visible; drawn without per-pixel depth tests
 } Particles;
 
 bool particles_init(Particles* self, int capacity);
@@ -84,27 +118,35 @@ void particles_begin_frame(Particles* self);
 // Advances all particles by dt_ms. Particles always advance even if later culled from rendering.
 void particles_tick(Particles* self, uint32_t dt_ms);
 
-// Spawns a particle into the pool. If the pool is full, the particle is dropped.
+// Returns the id of a template equal to `tpl`, adding it if needed, or -1 when the
+// table is full. Ids stay valid until the next particles_reset.
+int particles_template_intern(Particles* self, const ParticleTemplate* tpl);
+
+// Spawns a particle into the pool. p->template_id must come from
+// particles_template_intern on this pool. If the pool is full, the particle is dropped.
 void particles_spawn(Particles* self, const Particle* p);
 
 // Rendering API forward decls (kept here to avoid pulling render headers into World headers).
-typedef struct Framebuffer Framebuffer;
 typedef struct World World;
 typedef struct Camera Camera;
 typedef struct TextureRegistry TextureRegistry;
 typedef struct AssetPaths AssetPaths;
-
-// Draws all alive particles as sprite-like billboards.
-// Occlusion behavior matches entity sprites:
-// - `wall_depth` prevents drawing particles behind solid walls in a column.
-// - `depth_pixels` prevents drawing particles behind already-rendered world pixels.
-void particles_draw(
+typedef struct Compositor Compositor;
+typedef struct ImageCache ImageCache;
+
+// Projects all alive particles as sprite-like billboards and pushes them to `comp`
+// (opened with compositor_begin), which draws them on compositor_flush.
+// Occlusion behavior matches entity sprites: whole particles hidden per the compositor's
+// depth pyramid are dropped here, the rest are depth-tested per column and pixel when
+// rasterized. Pixel and drawn counts are reported by the compositor.
+// With `images` (may be NULL), image particles snap to a size bucket and draw a
+// pre-scaled variant from the cache (render/image_cache.h).
+void particles_submit(
 	Particles* self,
-	Framebuffer* fb,
+	Compositor* comp,
 	const World* world,
 	const Camera* cam,
 	int start_sector,
 	TextureRegistry* texreg,
 	const AssetPaths* paths,
-	const float* wall_depth,
-	const float* depth_pixels);
+	ImageCache* images);
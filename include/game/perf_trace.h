@@ -25,11 +25,16 @@ typedef struct PerfTraceFrame {
         int pe_emitters_updated;
         int pe_emitters_gated;
         int pe_spawn_attempted;
+        int pe_emitters_offscreen;
+        int pe_fast_forwarded;
         int p_alive;
         int p_capacity;
         int p_spawned;
         int p_dropped;
+        int p_listed;
         int p_drawn_particles;
+        int p_early_rejected;
+        int p_early_accepted;
         int p_pixels_written;
 
         // Gore breakdown (captured during perf trace only).
@@ -39,9 +44,45 @@ typedef struct PerfTraceFrame {
         int g_capacity;
         int g_spawned;
         int g_dropped;
+        int g_settled;
+        int g_baked;
+        int g_bake_failed;
+        int g_decal_pages;
+        int g_decal_evicted;
+        double g_decal_kb;
         int g_drawn_samples;
+        int g_early_rejected;
+        int g_early_accepted;
         int g_pixels_written;
 
+        // Gore/particle compositor (render/compositor.h): flush time, items, busy tiles.
+        double c_flush_ms;
+        int c_items;
+        int c_tiles;
+        int c_threads;
+
+        // Pre-scaled particle image cache (render/image_cache.h), per frame except the gauges.
+        int ic_hits;
+        int ic_misses;
+        int ic_evictions;
+        int ic_bypassed;
+        int ic_used_kb;
+        int ic_entries;
+
+	// Dynamic resolution (render.dynamic_resolution): scale/size the world was rendered
+	// at and the controller decision taken after it (DynResDecision).
+	float dr_scale;
+	int dr_width;
+	int dr_height;
+	int dr_decision;
+
+	// UI layer (render.ui_layer): whether it was on, re-uploaded, or CPU-composited.
+	bool ui_layer;
+	bool ui_layer_uploaded;
+	bool ui_layer_cpu_composite;
+	// Frame was drawn into a locked texture (render.present_lock) rather than copied.
+	bool present_locked;
+
 	// Renderer breakdown (captured during perf trace only).
 	double rc_planes_ms;
 	double rc_hit_test_ms;
@@ -64,6 +105,8 @@ typedef struct PerfTraceFrame {
 	int rc_lighting_mul_calls;
 	int rc_lighting_apply_light_iters;
 	int rc_lighting_mul_light_iters;
+	int rc_wall_light_lookups;
+	int rc_wall_light_unique;
 } PerfTraceFrame;
 
 typedef struct PerfTrace {
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Potentially visible sectors, used to stop simulating effects nobody can see
+// (particle emitters, gore chunk flight). Filled from the renderer's portal traversal
+// of the previous frame (raycast_visible_sectors), so it lags the camera by one frame.
+typedef struct SectorVisibility {
+	const uint8_t* visible; // borrowed, one byte per sector (non-zero = visible); NULL = no data
+	int sector_count;
+} SectorVisibility;
+
+// True when `sector` may be visible. Without data, or for sectors outside the set
+// (invalid or unknown), nothing is gated.
+static inline bool sector_visibility_contains(const SectorVisibility* v, int sector) {
+	if (!v || !v->visible || (unsigned)sector >= (unsigned)v->sector_count) {
+		return true;
+	}
+	return v->visible[sector] != 0u;
+}
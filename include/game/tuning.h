@@ -13,12 +13,19 @@
 
 // --- Audio (SFX) tuning ---
 
-// Max concurrent SFX voices mixed at once.
-#define SFX_MAX_VOICES 16
+// Max concurrent SFX voices mixed at once (idle slots cost nothing to mix).
+#define SFX_MAX_VOICES 64
 
 // Max distinct WAV samples kept cached at once.
 #define SFX_MAX_SAMPLES 128
 
+// WAVs whose decoded int16 data at the device rate would exceed this many bytes are not
+// loaded; they are streamed from disk while they play (see platform/sfx_stream.h).
+#define SFX_STREAM_MIN_BYTES (1024 * 1024)
+
+// Streamed sounds that can play at once (each holds one SFX_STREAM_RING_FRAMES buffer).
+#define SFX_MAX_STREAMS 16
+
 // Global spatial attenuation distances (world units).
 // If distance <= MIN: full gain. If >= MAX: silent. Squared falloff between.
 #define SFX_ATTEN_MIN_DIST 6.0f
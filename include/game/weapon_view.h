@@ -7,4 +7,8 @@
 
 // Draw the first-person weapon viewmodel (currently IDLE only).
 // Intended to be rendered before HUD, so the HUD can obscure its bottom edge.
-void weapon_view_draw(Framebuffer* fb, const Player* player, TextureRegistry* texreg, const AssetPaths* paths);
+// `scale` multiplies the sprite size and bob (1 at the internal resolution).
+void weapon_view_draw(Framebuffer* fb, const Player* player, TextureRegistry* texreg, const AssetPaths* paths, float scale);
+
+// Bob offset of the viewmodel in pixels at `scale`.
+void weapon_view_bob_offset(const Player* player, float scale, int* out_x, int* out_y);
@@ -6,7 +6,9 @@
 #include "core/base.h"
 #include "game/gore.h"
 #include "game/particles.h"
+#include "render/floor_decals.h"
 #include "render/lighting.h"
+#include "render/lightmap.h"
 
 typedef struct Vertex {
 	float x;
@@ -88,6 +90,12 @@ typedef struct World {
         int light_count; // total slots in use in lights[] (may include free slots)
         int light_capacity;
 
+        // Static floor/ceiling lighting baked from the map-authored lights at load time.
+        PlaneLightmaps lightmaps;
+
+        // Settled gore baked into the floors (see gore_tick); sampled by the floor renderer.
+        FloorDecals floor_decals;
+
         // World-owned particle pool. Particles always run their lifecycle to completion
         // even if their originating emitter is destroyed.
         Particles particles;
@@ -119,6 +127,10 @@ bool world_build_sector_wall_index(World* self);
 void world_set_sector_tex(Sector* s, StringView floor_tex, StringView ceil_tex);
 void world_set_wall_tex(Wall* w, StringView tex);
 
+// Axis-aligned bounds of the vertices of every wall on the sector's boundary (front or
+// back side). Returns false when the sector has no such walls.
+bool world_sector_bounds(const World* world, int sector, float* min_x, float* min_y, float* max_x, float* max_y);
+
 // Point-in-sector queries.
 // Uses an even-odd test on wall edges belonging to the sector.
 bool world_sector_contains_point(const World* world, int sector, float x, float y);
@@ -6,6 +6,7 @@
 // The SFX core owns an SDL audio device and mixes WAV samples into it.
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "assets/asset_paths.h"
@@ -34,6 +35,9 @@ void sfx_shutdown(void);
 void sfx_set_master_volume(float volume);
 
 // Loads (or returns a cached) WAV sample from Assets/Sounds/Effects/<filename>.
+// Samples are kept as int16 at the device rate in their own channel count. WAVs that
+// would take more than SFX_STREAM_MIN_BYTES that way are streamed from disk instead
+// (at most SFX_MAX_STREAMS playing at once).
 // Returns {0,0} on failure.
 SfxSampleId sfx_load_effect_wav(const char* filename);
 
@@ -46,9 +50,34 @@ SfxSampleId sfx_load_menu_wav(const char* filename);
 // Returns {0,0} when audio is disabled or on failure.
 SfxVoiceId sfx_play(SfxSampleId sample, float gain, bool looping);
 
+// Voice calls never block on the audio device: they queue a command that the audio
+// callback applies at the start of its next buffer.
+
 // Updates a playing voice gain. Safe to call even if voice is invalid/stale.
 void sfx_voice_set_gain(SfxVoiceId voice, float gain);
 
+// Updates a playing voice pan in [-1,1] (-1 = left only, 0 = center, 1 = right only).
+// Safe to call even if voice is invalid/stale.
+void sfx_voice_set_pan(SfxVoiceId voice, float pan);
+
 // Stops a playing voice. Safe to call even if voice is invalid/stale.
 void sfx_voice_stop(SfxVoiceId voice);
 
+
+// Audio memory and streaming counters (see the `sfx_stats` console command).
+typedef struct SfxMemoryStats {
+	int resident_samples;
+	size_t resident_bytes;        // decoded int16 sample data
+	size_t resident_float_bytes;  // what the same samples would take as stereo float32
+	int streamed_samples;
+	size_t streamed_source_bytes; // WAV data left on disk
+	size_t stream_buffer_bytes;   // stream rings, allocated at init
+	int stream_slots;
+	int streams_active;
+	uint32_t stream_underruns;    // mixer buffers a stream could not fill
+	uint32_t stream_rejects;      // plays refused because every stream slot was busy
+	int voices_playing;
+	int voice_slots;
+} SfxMemoryStats;
+
+void sfx_get_memory_stats(SfxMemoryStats* out);
@@ -0,0 +1,140 @@
+#pragma once
+
+// SFX mixing core (no SDL; driven by the audio callback in audio_sdl.c and by
+// tools/bench_sfx_mixer.c).
+//
+// Live voices are kept in a packed active list, so a buffer costs nothing for idle
+// slots. Each voice is mixed block-wise: the output is split only where the voice
+// reaches the end of its sample (wrap or stop), and every run in between is one
+// kernel call that widens the source's int16 frames (mono or interleaved stereo) to
+// float and multiply-adds them into the stereo float mix. The mix is clamped to
+// [-1, 1] with a second vector pass. Kernels use SSE2 on x86-64 and NEON on ARM64,
+// scalar otherwise. Nothing here allocates.
+//
+// A voice either reads a resident sample or consumes an SfxStreamRing filled by the
+// stream reader thread (platform/sfx_stream.h). A stream that runs dry plays silence
+// for the rest of the buffer and counts an underrun; it never blocks the callback.
+//
+// The game thread never touches the mixer directly. It pushes SfxCommands into a
+// single-producer/single-consumer ring, and the audio callback drains the ring at the
+// start of every buffer. The only state flowing back is each slot's ended generation,
+// which lets the game side reuse the slots of one-shots that finished.
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game/tuning.h"
+
+// Commands the ring can hold (power of two). A full ring makes the producer drain it
+// itself under the device lock (see sfx_push_command in audio_sdl.c).
+#define SFX_COMMAND_RING_SIZE 1024
+
+// Single-producer/single-consumer frame ring between the stream reader thread
+// (producer) and the mixer (consumer). Each playback of a streamed sample is a
+// session: the reader resets the ring for a new session and only then publishes it in
+// ready_session, so the mixer never reads frames left over from the previous one.
+typedef struct SfxStreamRing {
+	int16_t* frames;   // capacity frames of up to two channels; owned by the streamer
+	uint32_t capacity; // frames, power of two
+	_Atomic uint32_t ready_session;    // reader: ring holds this session's frames
+	_Atomic uint32_t finished_session; // reader: last frame of this (one-shot) session written
+	atomic_bool in_use;                // set when a voice is started on it, cleared by the mixer when it lets go
+	atomic_uint underruns;             // mixer: buffers that ran out of frames
+	alignas(64) atomic_uint write_pos; // frames written; advanced by the reader
+	alignas(64) atomic_uint read_pos;  // frames consumed; advanced by the mixer
+} SfxStreamRing;
+
+// What a voice plays: a resident sample (frames) or a stream (stream + session).
+typedef struct SfxMixSource {
+	const int16_t* frames;  // borrowed interleaved int16; NULL for streams
+	uint32_t frame_count;
+	SfxStreamRing* stream;  // borrowed; NULL for resident samples
+	uint32_t session;
+	uint8_t channels;       // 1 (played on both sides) or 2
+} SfxMixSource;
+
+typedef struct SfxMixVoice {
+	SfxMixSource src;
+	uint32_t frame_pos;   // resident samples only; streams loop in the reader
+	float gain;           // linear [0,1]
+	float pan;            // [-1,1]; 0 plays both channels at full gain
+	uint16_t generation;  // of the SfxVoiceId that started it
+	bool looping;
+	bool live;            // false when the slot is free
+} SfxMixVoice;
+
+typedef struct SfxMixer {
+	SfxMixVoice voices[SFX_MAX_VOICES];
+	uint16_t active[SFX_MAX_VOICES];      // packed indices of live voices
+	uint16_t active_slot[SFX_MAX_VOICES]; // position of each live voice in active[]
+	int active_count;
+	// Generation of the last voice that finished or was stopped, per slot. Written by
+	// the consumer, read by the producer.
+	_Atomic uint16_t ended[SFX_MAX_VOICES];
+} SfxMixer;
+
+typedef enum SfxCommandKind {
+	SFX_CMD_PLAY = 0,
+	SFX_CMD_STOP,
+	SFX_CMD_SET_GAIN,
+	SFX_CMD_SET_PAN,
+} SfxCommandKind;
+
+typedef struct SfxCommand {
+	uint8_t kind; // SfxCommandKind
+	bool looping; // PLAY
+	uint16_t voice;
+	uint16_t generation;
+	float value;      // PLAY/SET_GAIN: gain, SET_PAN: pan
+	SfxMixSource src; // PLAY
+} SfxCommand;
+
+typedef struct SfxCommandRing {
+	SfxCommand items[SFX_COMMAND_RING_SIZE];
+	alignas(64) atomic_uint head; // next slot to write; advanced by the producer
+	alignas(64) atomic_uint tail; // next slot to read; advanced by the consumer
+} SfxCommandRing;
+
+void sfx_command_ring_init(SfxCommandRing* self);
+
+// Producer side. Returns false when the ring is full.
+bool sfx_command_ring_push(SfxCommandRing* self, const SfxCommand* cmd);
+
+// Consumer side. Returns false when the ring is empty.
+bool sfx_command_ring_pop(SfxCommandRing* self, SfxCommand* out);
+
+void sfx_mixer_init(SfxMixer* self);
+
+// Consumer side: applies every queued command, in order. Returns how many were applied.
+int sfx_mixer_drain(SfxMixer* self, SfxCommandRing* ring);
+
+// Applies one command. Gain/pan/stop for a voice that has since ended or was restarted
+// under a newer generation are ignored.
+void sfx_mixer_apply(SfxMixer* self, const SfxCommand* cmd);
+
+// Starts `voice` from frame 0 at pan 0, replacing whatever it was playing. A stream the
+// voice was reading is released (in_use cleared).
+void sfx_mixer_start(SfxMixer* self, uint16_t voice, uint16_t generation, const SfxMixSource* src, float gain, bool looping);
+
+// Silences `voice`; no-op when it is not playing.
+void sfx_mixer_stop(SfxMixer* self, uint16_t voice);
+
+// Consumer side: false once a one-shot voice has played to the end or was stopped.
+bool sfx_mixer_voice_active(const SfxMixer* self, uint16_t voice);
+
+// Producer side: true once the voice started as `generation` has finished or was stopped.
+bool sfx_mixer_voice_ended(const SfxMixer* self, uint16_t voice, uint16_t generation);
+
+// Mixes every live voice into out[0 .. frames*2) (interleaved stereo, overwritten),
+// scaled by `master`, and retires one-shot voices that finish. Voices too quiet to
+// hear still advance so they stay in time.
+void sfx_mixer_mix(SfxMixer* self, float* out, int frames, float master);
+
+// Kernels, exposed for the benchmark: stereo float dst += src / 32768 * (gain_l, gain_r)
+// over `frames` frames of interleaved stereo or mono int16 (a mono frame feeds both
+// channels), and dst[i] clamped to [-1, 1].
+void sfx_mix_madd_s16_stereo(float* dst, const int16_t* src, int frames, float gain_l, float gain_r);
+void sfx_mix_madd_s16_mono(float* dst, const int16_t* src, int frames, float gain_l, float gain_r);
+void sfx_mix_clamp_f32(float* dst, int n);
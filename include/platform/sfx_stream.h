@@ -0,0 +1,108 @@
+#pragma once
+
+// Disk streaming for long SFX (ambience loops, long one-shots).
+//
+// A streamed sample keeps only its WAV header in memory. Each playback claims one of
+// SFX_MAX_STREAMS slots; a reader thread owns the slot's file handle and SDL_AudioStream,
+// converts the WAV data to int16 at the device rate (mono stays mono) and keeps the
+// slot's SfxStreamRing topped up, while the mixer consumes it on the audio thread.
+// Looping streams seek back to the start of the data chunk without flushing the
+// resampler, so the loop point is seamless.
+//
+// The game thread only claims idle slots and posts a new session under the streamer
+// lock, which the reader holds just long enough to copy requests (never across file
+// I/O). The mixer and the reader never wait on each other.
+
+#include <SDL.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "game/tuning.h"
+#include "platform/sfx_mixer.h"
+
+// Frames per stream ring (power of two): ~0.34 s at 48 kHz, 64 KB in stereo.
+#define SFX_STREAM_RING_FRAMES 16384
+
+// Layout of a WAV file's sample data, read from its header.
+typedef struct SfxWavInfo {
+	uint16_t format;      // 1 = PCM, 3 = IEEE float (WAVE_FORMAT_EXTENSIBLE resolved)
+	uint16_t channels;
+	uint32_t rate;
+	uint16_t bits;
+	uint16_t block_align; // bytes per frame
+	uint32_t data_offset; // file offset of the first sample
+	uint32_t data_bytes;
+} SfxWavInfo;
+
+// Reads the fmt and data chunk headers of a RIFF/WAVE file. Returns false when the file
+// cannot be read or is not a WAV.
+bool sfx_wav_probe(const char* path, SfxWavInfo* out);
+
+// True when the reader can decode `info`: mono or stereo PCM of 8, 16, 24 or 32 bits,
+// or 32-bit float.
+bool sfx_wav_streamable(const SfxWavInfo* info);
+
+// Bytes `info` takes once converted to int16 at `rate` (stereo or mono, as streamed).
+uint64_t sfx_wav_decoded_bytes(const SfxWavInfo* info, int rate);
+
+// Reader-side state of one slot.
+typedef struct SfxStreamCursor {
+	uint32_t session;      // session the ring was last reset for
+	const char* path;      // copied from the request
+	SfxWavInfo info;
+	uint8_t channels;
+	bool looping;
+	FILE* file;            // NULL when idle or failed
+	SDL_AudioStream* convert;
+	uint32_t data_left;    // bytes of the data chunk not yet read in this pass
+	bool flushed;          // one-shot: end of data handed to the converter
+} SfxStreamCursor;
+
+typedef struct SfxStreamSlot {
+	SfxStreamRing ring;
+	// Request, written by the game thread under the streamer lock.
+	const char* path; // borrowed; the sample outlives its playbacks
+	SfxWavInfo info;
+	uint8_t channels;
+	bool looping;
+	uint32_t requested; // latest session asked for
+	SfxStreamCursor cursor; // reader thread only
+} SfxStreamSlot;
+
+typedef struct SfxStreamer {
+	bool running;
+	int rate; // device rate
+	SfxStreamSlot slots[SFX_MAX_STREAMS];
+	int16_t* ring_frames; // owned, one ring per slot
+	size_t ring_bytes;
+	uint8_t* read_buf;    // reader scratch: raw file bytes
+	int32_t* widen_buf;   // reader scratch: 24-bit PCM widened to 32
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t wake; // a session was posted (or quit)
+	bool pending;        // under lock
+	bool quit;           // under lock
+} SfxStreamer;
+
+// Allocates the rings and starts the reader thread. On failure nothing is left running
+// and long sounds are loaded like any other.
+bool sfx_streamer_init(SfxStreamer* self, int rate);
+
+// Stops the reader and frees everything. Call only after the mixer stopped reading
+// (device closed), before freeing the samples whose paths the slots borrow.
+void sfx_streamer_destroy(SfxStreamer* self);
+
+// Game thread: claims an idle slot and asks the reader to start `path` from the top as
+// a new session. The caller puts the returned ring and *out_session in the voice's
+// PLAY command; the mixer frees the slot again when the voice stops or ends. Returns
+// NULL when every slot is busy.
+SfxStreamRing* sfx_streamer_open(SfxStreamer* self, const char* path, const SfxWavInfo* info, uint8_t channels, bool looping, uint32_t* out_session);
+
+// Slots currently claimed, and buffers that ran dry across all slots since init.
+int sfx_streamer_active(SfxStreamer* self);
+uint32_t sfx_streamer_underruns(SfxStreamer* self);
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "render/depth_pyramid.h"
+#include "render/depth_spans.h"
+#include "render/framebuffer.h"
+#include "render/texture.h"
+
+// Screen-tiled compositor for small world billboards (gore chunks and stamps, particles).
+//
+// Systems project their instances into screen-space items (compositor_push) instead of
+// drawing them. compositor_flush then:
+// - sorts all items back to front (stable: equal depths keep submission order)
+// - bins them into COMPOSITOR_TILE x COMPOSITOR_TILE screen tiles
+// - rasterizes the tiles on a small worker pool, each tile walking its items in order
+// Every pixel sees the same sequence of depth tests and writes as a single-threaded pass
+// over the sorted list, so the output does not depend on the thread count. With one
+// thread, or fewer than COMPOSITOR_TILED_MIN_ITEMS items, the sorted list is drawn on
+// the calling thread without binning.
+//
+// Items are depth-tested against the world depth given to compositor_begin; they do not
+// test against each other.
+
+#define COMPOSITOR_TILE 64
+#define COMPOSITOR_TILE_SHIFT 6
+#define COMPOSITOR_MAX_THREADS 16
+#define COMPOSITOR_TILED_MIN_ITEMS 256
+
+typedef enum CompositeShape {
+	COMPOSITE_SHAPE_SOLID = 0, // fill the rect with `color` (opaque gore)
+	COMPOSITE_SHAPE_SQUARE,
+	COMPOSITE_SHAPE_CIRCLE,
+} CompositeShape;
+
+// Stats bucket an item is counted under.
+typedef enum CompositeLayer {
+	COMPOSITE_LAYER_GORE = 0,
+	COMPOSITE_LAYER_PARTICLES,
+	COMPOSITE_LAYER_COUNT,
+} CompositeLayer;
+
+typedef struct CompositeItem {
+	float depth;      // view depth, also the sort key
+	float depth_bias; // added to world depth before comparing (gore sits on surfaces)
+	// Screen rects fit in 16 bits: framebuffers are at most 4096 wide/high and submitters
+	// clamp item sizes to twice that, so an on-screen rect starts no further out than -8193.
+	int16_t x0; // unclipped screen rect [x0, x0 + w) x [y0, y0 + h)
+	int16_t y0;
+	int16_t w;
+	int16_t h;
+	int16_t clip_x0; // clipped to the framebuffer, non-empty
+	int16_t clip_y0;
+	int16_t clip_x1;
+	int16_t clip_y1;
+	uint32_t color;       // ABGR; SOLID writes it as is, shapes blend it over
+	float tint_blend;     // image items: how far texels are pulled toward `color`
+	float rot_cos;        // rotation (cos 1, sin 0 when not rotated)
+	float rot_sin;
+	const Texture* tex;   // optional image (square/circle items); magenta is transparent
+	uint8_t shape;        // CompositeShape
+	uint8_t layer;        // CompositeLayer
+	bool rotate;
+	bool test_pixels;     // false when the depth pyramid found the whole rect visible
+} CompositeItem;
+
+typedef struct CompositorWorkers CompositorWorkers;
+
+typedef struct Compositor {
+	// Frame inputs (compositor_begin).
+	Framebuffer* fb;
+	const float* wall_depth;
+	const float* depth_pixels;
+	const DepthSpans* depth_spans;
+	const DepthPyramid* depth_pyramid;
+	bool ready; // a frame is open and has some world depth to test against
+
+	CompositeItem* items;  // owned; in submission order until the flush sorts them
+	CompositeItem* sorted; // owned scratch, swapped with items by the sort
+	uint8_t* drawn;        // owned, parallel to items: wrote at least one pixel
+	int item_count;
+	int item_cap;
+
+	uint64_t* keys; // owned radix sort scratch: inverted depth bits << 32 | index
+	int keys_cap;
+	uint32_t* bins;     // owned, per-tile item indices, tile-major
+	uint8_t* bin_drawn; // owned, parallel to bins: the item wrote a pixel in that tile
+	int bins_cap;
+	int* bin_start;     // owned, tiles + 1 offsets into bins
+	int bin_start_cap;
+	int tiles_x;
+	int tiles_y;
+
+	int threads;                // including the calling thread
+	int threads_requested;      // as passed to init/set_threads, before resolving
+	CompositorWorkers* workers; // owned, NULL when single-threaded
+
+	// Stats of the last flush.
+	uint32_t stats_items[COMPOSITE_LAYER_COUNT];
+	uint32_t stats_items_drawn[COMPOSITE_LAYER_COUNT];
+	uint32_t stats_pixels_written[COMPOSITE_LAYER_COUNT];
+	uint32_t stats_tiles; // non-empty tiles (0 unless the tiles were used)
+} Compositor;
+
+// `threads` <= 0 picks one per online CPU (capped at COMPOSITOR_MAX_THREADS).
+bool compositor_init(Compositor* self, int threads);
+void compositor_destroy(Compositor* self);
+
+// Restarts the worker pool when the resolved thread count changes. Meant for config
+// changes; a repeated request is a no-op. Returns false (and falls back to a single
+// thread) if workers cannot be started.
+bool compositor_set_threads(Compositor* self, int threads);
+
+// Opens a frame: clears the item list and records the world depth. At least one of
+// wall_depth/depth_pixels/depth_spans is needed; otherwise pushes are ignored.
+void compositor_begin(
+	Compositor* self,
+	Framebuffer* fb,
+	const float* wall_depth,
+	const float* depth_pixels,
+	const DepthSpans* depth_spans,
+	const DepthPyramid* depth_pyramid);
+
+// Returns a slot for one item, or NULL when no frame is open or on OOM.
+CompositeItem* compositor_push(Compositor* self);
+
+// Sorts, bins and rasterizes the pushed items into the framebuffer, then closes the frame.
+void compositor_flush(Compositor* self);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "render/depth_spans.h"
+
+// Coarse occlusion levels over the world depth, built once per frame after the world
+// pass and used to classify whole billboards (sprites, particles, gore stamps) before
+// any per-pixel depth test:
+// - per DEPTH_PYRAMID_TILE x DEPTH_PYRAMID_TILE tile, and per screen column, the
+//   nearest and farthest world depth
+// - a billboard at or behind the farthest depth of every tile it overlaps is hidden
+// - a billboard in front of the nearest depth of every tile it overlaps is fully
+//   visible and can be drawn without per-pixel tests
+// Pixels with no world depth (sky) count as DEPTH_SPANS_FAR.
+
+#define DEPTH_PYRAMID_TILE 8
+#define DEPTH_PYRAMID_TILE_SHIFT 3
+
+typedef enum DepthPyramidResult {
+	DEPTH_PYRAMID_PARTIAL = 0, // needs per-column / per-pixel tests
+	DEPTH_PYRAMID_HIDDEN = 1,
+	DEPTH_PYRAMID_VISIBLE = 2,
+} DepthPyramidResult;
+
+typedef struct DepthPyramid {
+	bool valid;
+	int width;
+	int height;
+	int tiles_x;
+	int tiles_y;
+	float* tile_min; // owned, tiles_x * tiles_y
+	float* tile_max; // owned, tiles_x * tiles_y
+	float* col_min;  // owned, width
+	float* col_max;  // owned, width
+	int tile_cap;
+	int col_cap;
+} DepthPyramid;
+
+void depth_pyramid_init(DepthPyramid* self);
+void depth_pyramid_destroy(DepthPyramid* self);
+
+// Rebuilds from whichever world depth is in use: `depth_pixels` (width*height floats)
+// if non-NULL, else `spans` (folded per span from its end rows, no per-pixel work). With neither, the pyramid is left invalid and every test
+// returns DEPTH_PYRAMID_PARTIAL.
+bool depth_pyramid_build(DepthPyramid* self, int width, int height, const float* depth_pixels, const DepthSpans* spans);
+
+// Classifies a screen rect [x0, x1) x [y0, y1) at a single billboard depth.
+DepthPyramidResult depth_pyramid_test_rect(const DepthPyramid* self, int x0, int y0, int x1, int y1, float depth);
+
+// Per-column variant of the same test (rows are not considered).
+DepthPyramidResult depth_pyramid_test_column(const DepthPyramid* self, int x, float depth);
+
+// Records a nearer occluder drawn after the build (sprite depth write-back) so later
+// "fully visible" classifications stay correct.
+void depth_pyramid_lower(DepthPyramid* self, int x, int y0, int y1, float depth);
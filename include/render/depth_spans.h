@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Compact per-column depth for billboard occlusion (sprites, particles, gore).
+//
+// Instead of one float per pixel, the wall and plane drawers record one span per
+// column segment they fill: a y-range plus inverse depth as a linear function of y.
+// Inverse depth is used because it is exactly linear in screen y for both cases the
+// raycaster produces: constant for a wall slice, and (y - horizon) / k for a floor or
+// ceiling row. Spans of a column are kept sorted by y0 in a singly linked list inside
+// one shared pool, so a frame costs a few spans per column instead of width*height
+// floats.
+//
+// Spans may overlap; the depth at a pixel is the nearest (largest inverse depth) of
+// all spans covering it. Pixels covered by no span have no world depth (the sky).
+
+#define DEPTH_SPANS_FAR 1e30f
+
+typedef struct DepthSpan {
+	float inv_a; // inverse depth at y = inv_a + inv_b * y
+	float inv_b;
+	int16_t y0; // inclusive
+	int16_t y1; // exclusive
+	int32_t next; // next span in this column (by y0), or -1
+} DepthSpan;
+
+typedef struct DepthSpans {
+	int width;
+	int height;
+	int32_t* head; // owned, per-column first span index or -1
+	int head_cap;
+	DepthSpan* spans; // owned pool, reused across frames
+	int count;
+	int capacity;
+	uint32_t dropped; // spans lost to allocation failure this frame
+} DepthSpans;
+
+void depth_spans_init(DepthSpans* self);
+void depth_spans_destroy(DepthSpans* self);
+
+// Clears all columns for a new frame of the given size. Returns false on allocation failure.
+bool depth_spans_begin(DepthSpans* self, int width, int height);
+
+// Adds a span covering rows [y0, y1) of column x with inverse depth inv_a + inv_b * y.
+void depth_spans_push_linear(DepthSpans* self, int x, int y0, int y1, float inv_a, float inv_b);
+
+// Adds a span of constant depth (e.g. a wall slice or a sprite run).
+void depth_spans_push_const(DepthSpans* self, int x, int y0, int y1, float depth);
+
+// Nearest recorded depth at (x, y), or DEPTH_SPANS_FAR when nothing covers the pixel.
+float depth_spans_depth_at(const DepthSpans* self, int x, int y);
+
+size_t depth_spans_bytes(const DepthSpans* self);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "core/config.h"
+#include "render/framebuffer.h"
+
+// Dynamic resolution for the 3D view.
+//
+// The world pass (raycast, sprites, gore, particles) renders into a scratch framebuffer
+// of scale * the main framebuffer size, which is then upscaled (nearest) into the main
+// framebuffer before the weapon view, HUD and UI draw at full resolution (or, with
+// render.ui_layer, presented as its own layer without the CPU upscale). The scale is
+// adjusted in fixed steps between render.dynamic_resolution.min_scale and max_scale
+// from a smoothed render3d time:
+// - above target_ms: one step down
+// - predicted cost of the next step up (time scales with pixel count) below
+//   DYNRES_UP_HEADROOM * target_ms: one step up
+// After each change the controller holds for DYNRES_COOLDOWN_FRAMES frames. The first
+// frame rendered at a new size is not sampled.
+
+#define DYNRES_COOLDOWN_FRAMES 15
+#define DYNRES_UP_HEADROOM 0.85
+
+typedef enum DynResDecision {
+	DYNRES_HOLD = 0,
+	DYNRES_DOWN = 1,
+	DYNRES_UP = 2,
+} DynResDecision;
+
+typedef struct DynRes {
+	float scale;       // current 3D scale (1 = full internal resolution)
+	double avg_ms;     // smoothed render3d time at the current scale (<0 until first sample)
+	int cooldown;      // frames left before the next change is allowed
+	DynResDecision last_decision; // decision of the most recent update
+	unsigned steps_down; // total changes since init
+	unsigned steps_up;
+	int width;         // size the world was rendered at this frame
+	int height;
+	bool resized;      // width/height differ from the previous frame
+	Framebuffer scratch; // owned, width/height follow the current scale
+	size_t scratch_cap;  // pixels allocated in scratch
+} DynRes;
+
+void dynres_init(DynRes* self);
+void dynres_destroy(DynRes* self);
+
+// Returns the framebuffer the world pass should render into this frame: `fb` itself at
+// full scale (or when disabled / on allocation failure), else the scratch buffer.
+Framebuffer* dynres_begin_frame(DynRes* self, const DynamicResolutionConfig* cfg, Framebuffer* fb);
+
+// Upscales `world_fb` into `fb` when they differ.
+void dynres_end_frame(DynRes* self, const Framebuffer* world_fb, Framebuffer* fb);
+
+// Feeds the measured world-pass time and picks the scale for the next frame.
+DynResDecision dynres_update(DynRes* self, const DynamicResolutionConfig* cfg, double render3d_ms);
+
+const char* dynres_decision_name(DynResDecision d);
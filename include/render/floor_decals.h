@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Persistent floor decals (settled gore) baked into a world-space layer.
+//
+// Each sector that receives a decal gets a sparse page table over its bounding box at
+// FLOOR_DECAL_TEXELS_PER_UNIT. Pages of FLOOR_DECAL_PAGE_DIM^2 texels are handed out on
+// first write from a shared atlas that grows in fixed blocks (blocks never move, so page
+// pointers stay valid), so only floor area that was actually splattered costs memory.
+// Once the atlas is at FLOOR_DECAL_MAX_PAGES, the sector baked into least recently gives
+// its pages back (its decals disappear) to make room.
+// Texels are ABGR; 0 means "no decal" and written texels are opaque. The floor span
+// renderer looks the layer up while texturing (see draw_sector_floor_column) and lights
+// decal texels like the floor under them, so baked decals cost one lookup per floor pixel
+// in sectors that have any, and nothing per decal.
+
+#define FLOOR_DECAL_TEXELS_PER_UNIT 64
+#define FLOOR_DECAL_PAGE_SHIFT 5
+#define FLOOR_DECAL_PAGE_DIM (1 << FLOOR_DECAL_PAGE_SHIFT)
+#define FLOOR_DECAL_PAGE_TEXELS (FLOOR_DECAL_PAGE_DIM * FLOOR_DECAL_PAGE_DIM)
+// Pages per atlas block (256 KB).
+#define FLOOR_DECAL_BLOCK_PAGES 64
+// Atlas cap: 2048 pages of 4 KB (8 MB) covers 512 square world units of floor.
+#define FLOOR_DECAL_MAX_PAGES 2048
+
+typedef struct World World;
+
+typedef struct SectorFloorDecals {
+	float origin_x; // world position of the first texel's corner
+	float origin_y;
+	int pages_w;
+	int pages_h;
+	uint32_t** pages; // owned table, pages_w*pages_h; entries point into the atlas or are NULL
+	int page_count;   // non-NULL entries
+	uint32_t last_splat; // FloorDecals.splat_clock at the sector's latest splat
+} SectorFloorDecals;
+
+typedef struct FloorDecals {
+	SectorFloorDecals* sectors; // owned, length sector_count; allocated on first splat
+	int sector_count;
+	uint32_t** blocks; // owned atlas blocks of FLOOR_DECAL_BLOCK_PAGES pages each
+	int block_count;
+	int block_cap;
+	int page_count;    // pages in use
+	int pages_carved;  // pages ever handed out of the blocks (in use or free)
+	uint32_t* free_pages; // evicted pages; each holds the pointer to the next in its first texels
+	uint32_t splat_clock;
+	uint32_t evictions; // sectors evicted since init
+	size_t bytes;
+} FloorDecals;
+
+void floor_decals_init(FloorDecals* self);
+void floor_decals_destroy(FloorDecals* self);
+
+// Stamps an opaque disc of `abgr` (alpha forced to 255) into `sector`'s layer. Texels
+// outside the sector's bounding box are skipped. When the atlas is full, other sectors
+// are evicted least recently splatted first. Returns false when a page still could not
+// be allocated (the sector alone fills the atlas, or out of memory); texels already
+// written stay.
+bool floor_decals_splat(FloorDecals* self, const World* world, int sector, float x, float y, float radius, uint32_t abgr);
+
+// Returns the sector's layer, or NULL when nothing was baked into it.
+const SectorFloorDecals* floor_decals_sector(const FloorDecals* self, int sector);
+
+// Decal texel at a world position, or 0 when there is none.
+static inline uint32_t sector_floor_decals_sample(const SectorFloorDecals* sd, float wx, float wy) {
+	float fx = (wx - sd->origin_x) * (float)FLOOR_DECAL_TEXELS_PER_UNIT;
+	float fy = (wy - sd->origin_y) * (float)FLOOR_DECAL_TEXELS_PER_UNIT;
+	if (fx < 0.0f || fy < 0.0f || fx >= (float)(sd->pages_w << FLOOR_DECAL_PAGE_SHIFT) || fy >= (float)(sd->pages_h << FLOOR_DECAL_PAGE_SHIFT)) {
+		return 0u;
+	}
+	int tx = (int)fx;
+	int ty = (int)fy;
+	const uint32_t* page = sd->pages[(ty >> FLOOR_DECAL_PAGE_SHIFT) * sd->pages_w + (tx >> FLOOR_DECAL_PAGE_SHIFT)];
+	if (!page) {
+		return 0u;
+	}
+	const int mask = FLOOR_DECAL_PAGE_DIM - 1;
+	return page[((ty & mask) << FLOOR_DECAL_PAGE_SHIFT) | (tx & mask)];
+}
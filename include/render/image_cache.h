@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "render/texture.h"
+
+// Pre-scaled image cache for billboards drawn from a texture (image particles).
+//
+// Instead of nearest-scaling the source texture per pixel every frame, a billboard
+// snaps its on-screen size to the nearest power-of-sqrt(2) bucket (2, 3, 4, 6, 8, 11,
+// 16, ..., 256 px) and asks for a variant of the texture already scaled to that size,
+// and rotated when the billboard rotates in discrete steps. The compositor then copies
+// texels straight across (see composite_item_raster).
+//
+// Variants are baked with the same sampling math as the per-pixel path, so a variant
+// blitted at its bucket size matches what that path would draw at that size. Texels
+// outside a rotated image are the FF00FF colorkey.
+//
+// The cache is an LRU bounded by a byte budget. Entries used in the current frame are
+// never evicted (items referencing them are still queued); when no room can be made
+// the request is bypassed and the caller falls back to the per-pixel path.
+
+#define IMAGE_CACHE_MIN_SIZE 2
+#define IMAGE_CACHE_MAX_SIZE 256
+// rot_key for images drawn without rotation.
+#define IMAGE_CACHE_NO_ROTATION 0xFFFFu
+
+typedef struct ImageCacheEntry {
+	const Texture* source; // borrowed (registry-owned, stable); NULL when the slot is free
+	uint16_t size;
+	uint16_t rot_key;
+	Texture* image;        // owned, size x size row-major (pixels share its allocation)
+	uint32_t last_frame;
+	int hash_next;         // chain within a hash bucket, or the free list
+	int lru_prev;          // toward the most recently used entry
+	int lru_next;
+} ImageCacheEntry;
+
+typedef struct ImageCache {
+	ImageCacheEntry* entries; // owned
+	int entry_count;          // slots in use or on the free list
+	int entry_cap;
+	int free_head;
+	int* heads; // owned hash buckets, head_count is a power of two
+	int head_count;
+	int lru_head; // most recently used
+	int lru_tail; // eviction candidate
+	int live;
+
+	size_t budget_bytes;
+	size_t used_bytes;
+	uint32_t frame;
+
+	// Per-frame stats (cleared by image_cache_begin_frame).
+	uint32_t stats_hits;
+	uint32_t stats_misses;
+	uint32_t stats_evictions;
+	uint32_t stats_bypassed; // no room within the budget, or the image is too large
+} ImageCache;
+
+bool image_cache_init(ImageCache* self, size_t budget_bytes);
+void image_cache_destroy(ImageCache* self);
+
+// Drops every variant. Must not be called while queued items still reference them.
+void image_cache_clear(ImageCache* self);
+
+// Evicts down to the new budget (entries used this frame are kept).
+void image_cache_set_budget(ImageCache* self, size_t budget_bytes);
+
+// Starts a frame: clears per-frame stats. Entries used before this call may be evicted.
+void image_cache_begin_frame(ImageCache* self);
+
+// Nearest bucket size for a billboard `px` pixels wide, or 0 when it is too large to cache.
+int image_cache_bucket_size(int px);
+
+// Returns `source` scaled to size x size (a bucket size) and rotated by (rot_cos, rot_sin)
+// unless rot_key is IMAGE_CACHE_NO_ROTATION. rot_key identifies the rotation, e.g. the
+// angle in hundredths of a degree. Returns NULL when the variant cannot be cached.
+const Texture* image_cache_get(ImageCache* self, const Texture* source, int size, uint16_t rot_key, float rot_cos, float rot_sin);
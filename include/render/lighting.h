@@ -49,6 +49,21 @@ LightColor lighting_compute_multipliers(
 	float sample_x,
 	float sample_y);
 
+// Same as lighting_compute_multipliers, plus an additive `baked` point-light term
+// in multiplier space (e.g. a plane lightmap sample) applied before clamping.
+LightColor lighting_compute_multipliers_baked(
+	float dist,
+	float sector_intensity,
+	LightColor sector_tint,
+	const PointLight* lights,
+	int light_count,
+	float sample_x,
+	float sample_y,
+	LightColor baked);
+
+// Runtime brightness modulation for a light's flicker mode (>= 0; 1 for LIGHT_FLICKER_NONE).
+float lighting_flicker_factor(LightFlicker flicker, uint32_t seed, float time_s);
+
 // Quantizes a scalar lighting factor in [0,1] to a small number of steps.
 // This produces the classic PS1/N64-style banding.
 float lighting_quantize_factor(float v);
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "render/lighting.h"
+
+// Baked static point lighting for sector floors and ceilings.
+//
+// Map-authored lights never move; they only flicker in intensity. At map load each
+// sector gets a world-space lightmap (PLANE_LIGHTMAP_TEXEL_SIZE units per texel over
+// the sector's bounding box) holding the point-light contribution in multiplier space:
+// - non-flickering lights are summed into one RGB `steady` channel
+// - each flickering light keeps its own scalar weight channel, scaled per frame by
+//   color * flicker (see plane_lightmaps_frame_gains)
+// The lighting model is 2D (light falloff ignores height), so floor and ceiling of a
+// sector share the same map. Runtime-spawned lights (entities, projectiles) are not
+// baked and stay on the per-pixel plane path.
+
+#define PLANE_LIGHTMAP_TEXEL_SIZE 0.25f
+// Caps a single sector map's side; very large sectors get coarser texels instead.
+#define PLANE_LIGHTMAP_MAX_DIM 1024
+// Flicker weights are stored as u8 in [0, PLANE_LIGHTMAP_WEIGHT_MAX].
+#define PLANE_LIGHTMAP_WEIGHT_MAX 2.0f
+
+typedef struct World World;
+
+typedef struct SectorLightmap {
+	float origin_x;
+	float origin_y;
+	float inv_texel; // texels per world unit
+	int w;
+	int h;            // 0x0 when no static light reaches the sector
+	uint32_t* steady; // owned, w*h; packed r | g<<8 | b<<16 where 255 == 1.0
+	int channel_count;
+	int* channel_light;      // owned, world light index per flicker channel
+	uint8_t* channel_weight; // owned, channel_count planes of w*h
+} SectorLightmap;
+
+typedef struct PlaneLightmaps {
+	SectorLightmap* sectors; // owned, length sector_count
+	int sector_count;
+	// World lights [0, baked_light_count) are baked; higher indices are dynamic.
+	int baked_light_count;
+	size_t bytes;
+} PlaneLightmaps;
+
+void plane_lightmaps_init(PlaneLightmaps* self);
+void plane_lightmaps_destroy(PlaneLightmaps* self);
+
+// Bakes every live light currently in `world` into per-sector maps. Call once after
+// map load (lights spawned later are treated as dynamic). Replaces any previous bake.
+bool plane_lightmaps_bake(PlaneLightmaps* self, const World* world);
+
+// Fills out[0..baked_light_count) with this frame's per-light gain (color * flicker,
+// pre-scaled for u8 weights). Entries for non-flickering lights are zero.
+void plane_lightmaps_frame_gains(const PlaneLightmaps* self, const World* world, float time_s, LightColor* out);
+
+// Returns the sector's map, or NULL when it has none.
+const SectorLightmap* plane_lightmaps_sector(const PlaneLightmaps* self, int sector);
+
+// Baked point-light contribution (multiplier space, unclamped) at a world position.
+LightColor sector_lightmap_sample(const SectorLightmap* lm, const LightColor* gains, float wx, float wy);
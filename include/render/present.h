@@ -1,15 +1,65 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "platform/window.h"
 #include "render/framebuffer.h"
 
 typedef struct Presenter {
-	void* texture; // SDL_Texture* stored opaquely
+	void* texture; // SDL_Texture* stored opaquely (whole frame, or the 3D layer)
+	int tex_w;
+	int tex_h;
+
+	// UI layer (render.ui_layer): premultiplied-alpha texture blended over the 3D layer.
+	void* ui_texture;      // SDL_Texture*, (re)created at the UI layer size
+	int ui_w;              // size ui_texture was last created for (also after a failure)
+	int ui_h;
+	bool ui_premultiplied; // renderer blends ui_texture; otherwise it holds CPU composites
+	bool ui_current;       // ui_texture holds the last uploaded UI layer
+	Framebuffer composite; // CPU scratch (UI composite, VGA remap); stride == width
+	size_t composite_cap;  // pixels allocated in composite
+
+	// Locked present (render.present_lock): the frame is drawn straight into one of two
+	// streaming textures (used in rotation) instead of being copied in by SDL_UpdateTexture.
+	void* lock_textures[2]; // SDL_Texture*, created on first use
+	int lock_index;         // texture to lock next
+	bool lock_active;       // lock_view currently maps a locked texture
+	bool lock_disabled;     // locking failed or the pitch did not match; copy path only
+	Framebuffer lock_view;  // borrowed view of the locked pixels (never freed)
+
+	// Per-present counters (reset by present_frame / present_frame_layers).
+	bool stats_ui_uploaded;
+	bool stats_ui_cpu_composite;
+	bool stats_locked;
 } Presenter;
 
 bool present_init(Presenter* self, Window* window, const Framebuffer* fb);
 void present_shutdown(Presenter* self);
 
+// Presents `fb` (up to the init size, scaled to the window). If `fb` is the view
+// returned by present_lock_frame, the texture is unlocked and shown without a copy.
 bool present_frame(Presenter* self, Window* window, const Framebuffer* fb);
+
+// Same as present_frame with the VGA palette remap (render.vga_mode) fused into the
+// upload: pixels are remapped while being written into the locked texture, so `fb`
+// is read once and not modified (except for a present_lock_frame view, which is
+// remapped in place). When the texture cannot be locked or `fb` is not the init size,
+// the remap goes through a scratch copy sized to `fb`.
+bool present_frame_vga(Presenter* self, Window* window, const Framebuffer* fb);
+
+// Locks the next streaming texture and returns a framebuffer view of its pixels (same
+// size as `fb`) for the caller to draw the whole frame into; present it with
+// present_frame. Returns `fb` itself when locking is unavailable (the texture pitch does
+// not match the framebuffer stride, or SDL_LockTexture failed), in which case
+// present_frame takes the usual copy path. The view's contents are undefined on return:
+// every pixel must be written before it is read.
+Framebuffer* present_lock_frame(Presenter* self, Window* window, Framebuffer* fb);
+
+// Presents two layers: `world` (any size up to the init size, scaled to the window)
+// and `ui` (normally the window size, premultiplied alpha: ABGR with color already
+// multiplied by alpha, as produced by the draw_* blends on a cleared transparent
+// framebuffer) on top. The UI texture is re-uploaded only when `ui_changed` (or after it
+// had to be recreated), so a caller can skip redrawing an unchanged UI layer entirely.
+bool present_frame_layers(Presenter* self, Window* window, const Framebuffer* world, const Framebuffer* ui, bool ui_changed);
@@ -2,6 +2,7 @@
 
 #include "game/world.h"
 #include "render/camera.h"
+#include "render/depth_spans.h"
 #include "render/framebuffer.h"
 
 #include "render/texture.h"
@@ -22,6 +23,8 @@ typedef struct RaycastPerf {
 	uint64_t lighting_apply_light_iters;
 	uint64_t lighting_mul_calls;
 	uint64_t lighting_mul_light_iters;
+	uint32_t wall_light_lookups; // wall hits that needed Gouraud endpoint multipliers
+	uint32_t wall_light_unique;  // wall sides actually lit this frame (cache misses)
 
 	// Texture registry work.
 	double tex_lookup_ms;
@@ -42,6 +45,20 @@ typedef struct RaycastPerf {
 // iterate point-light emitters at all.
 void raycast_set_point_lights_enabled(bool enabled);
 
+// VGA mode: walls and lit planes whose texture has palette indices (see
+// texture_registry_set_indexed) are lit through the palette colormap instead of
+// per-channel multiplies. Colored light still takes the RGB path.
+void raycast_set_palette_mode(bool enabled);
+
+// Releases renderer-owned caches (sky strip, etc.). Safe to call more than once.
+void raycast_shutdown(void);
+
+// Sectors the last textured render of `world` reached through its portal traversal with
+// some of their screen area visible (one byte per sector, non-zero = visible). Valid until
+// the next render. Returns NULL if `world` was not the last world rendered, or if it has
+// changed sector count since. *out_count receives the number of entries.
+const uint8_t* raycast_visible_sectors(const World* world, int* out_count);
+
 // Builds a per-frame list of visible point lights for the given camera.
 // The returned lights include runtime flicker modulation and are capped similarly to the
 // main textured wall lighting path.
@@ -84,6 +101,9 @@ void raycast_render_textured_from_sector(
 );
 
 // Profiled version: fills `out_perf` when non-NULL.
+// If `out_depth_spans` is non-NULL, it is reset and filled with the per-column depth spans
+// of every drawn wall and plane pixel (see render/depth_spans.h). This is the compact
+// alternative to `out_depth_pixels`; either, both or neither may be requested.
 void raycast_render_textured_from_sector_profiled(
 	Framebuffer* fb,
 	const World* world,
@@ -93,6 +113,7 @@ void raycast_render_textured_from_sector_profiled(
 	const char* sky_filename,
 	float* out_depth,
 	float* out_depth_pixels,
+	DepthSpans* out_depth_spans,
 	int start_sector,
 	RaycastPerf* out_perf
 );
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Small SIMD kernel layer for the software renderer's per-pixel hot loops (and a few
+// array kernels for other per-element passes, such as particle aging).
+//
+// Kernels operate on contiguous runs of 32-bit values and are bit-exact with the
+// scalar reference implementation. The best available implementation is chosen once
+// at runtime (AVX2 > SSE2 on x86-64, NEON on ARM64, scalar otherwise); callers go
+// through simd_kernels() and never test CPU features themselves.
+
+typedef enum SimdLevel {
+	SIMD_LEVEL_SCALAR = 0,
+	SIMD_LEVEL_SSE2 = 1,
+	SIMD_LEVEL_AVX2 = 2,
+	SIMD_LEVEL_NEON = 3,
+} SimdLevel;
+
+typedef struct SimdKernels {
+	SimdLevel level;
+	const char* name;
+
+	// dst[i] = src[i] with byte lanes 0..2 scaled by (c * mul + 128) >> 8, byte 3 kept.
+	// mul0/mul1/mul2 apply to bits 0-7 / 8-15 / 16-23 and must be in [0, 256].
+	// dst may alias src.
+	void (*mul_u8x3)(uint32_t* dst, const uint32_t* src, int n, int mul0, int mul1, int mul2);
+
+	// Source-over blend of one ABGR8888 color onto dst[0..n):
+	// rgb = (src * a + dst * (255 - a) + 127) / 255,
+	// alpha = (255 * a + dst_a * (255 - a) + 127) / 255 (255 on opaque dst; on a
+	// transparent layer this accumulates premultiplied color). a == 0 leaves dst untouched.
+	void (*blend_const)(uint32_t* dst, int n, uint32_t abgr);
+
+	// Same blend with per-pixel source: dst[i] = src[i] over dst[i].
+	void (*blend_over)(uint32_t* dst, const uint32_t* src, int n);
+
+	// 15-bit color lookup: dst[i] = (lut[k] & 0x00FFFFFF) | (src[i] & 0xFF000000), with
+	// k = ((c0 >> 3) << 10) | ((c1 >> 3) << 5) | (c2 >> 3) for bytes c0..c2 of src[i].
+	// lut has 32768 entries. dst may alias src.
+	void (*remap_rgb555)(uint32_t* dst, const uint32_t* src, int n, const uint32_t* lut);
+
+	// v[i] += add (wrapping), for i in [0, n).
+	void (*add_u32)(uint32_t* v, int n, uint32_t add);
+
+	// Index of the first i in [0, n) with a[i] >= b[i] (unsigned), or n if there is none.
+	int (*find_ge_u32)(const uint32_t* a, const uint32_t* b, int n);
+} SimdKernels;
+
+// Returns the active kernel set (selects the best supported level on first use).
+const SimdKernels* simd_kernels(void);
+
+// True if `level` is compiled in and supported by this CPU.
+bool simd_level_supported(SimdLevel level);
+
+// Forces a specific level (benchmarks/diagnostics). Returns false and keeps the
+// current selection if the level is unsupported.
+bool simd_select(SimdLevel level);
+
+const char* simd_level_name(SimdLevel level);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "render/texture.h"
+
+// Pre-resampled sky panorama.
+//
+// The visible sky only depends on camera yaw, FOV and framebuffer size, so the
+// panorama is resampled once (whenever the sky texture, FOV or resolution
+// changes) into a column-major strip: `height` = fb_height / 2 rows, and
+// `columns` angular columns covering 360 degrees at the current pixel density
+// (fb_width pixels per FOV). Drawing sky then becomes a per-column copy.
+typedef struct SkyCache {
+	// Cache key.
+	const Texture* source; // borrowed (registry-owned, stable)
+	float fov_deg;
+	int fb_width;
+	int fb_height;
+
+	int columns;
+	int height;
+	uint32_t* pixels; // owned, column-major: pixels[col * height + y]
+
+	// Per-frame: angular column for each screen x (filled by the raycaster).
+	int* x_to_column; // owned, length x_capacity
+	int x_capacity;
+} SkyCache;
+
+void sky_cache_init(SkyCache* self);
+void sky_cache_destroy(SkyCache* self);
+
+// Rebuilds the strip if the key changed. Returns false (and leaves the cache
+// unusable for this frame) when `sky` is NULL or allocation fails.
+bool sky_cache_update(SkyCache* self, const Texture* sky, float fov_deg, int fb_width, int fb_height);
+
+// Maps a ray angle (radians, any range) to an angular column in [0, columns).
+int sky_cache_column_for_angle(const SkyCache* self, float ang_rad);
+
+static inline const uint32_t* sky_cache_column(const SkyCache* self, int column) {
+	return &self->pixels[(size_t)column * (size_t)self->height];
+}
@@ -1,21 +1,52 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "assets/asset_paths.h"
 
+// In-memory texel order. Chosen by the registry at load time to match how the
+// renderer walks the texture; callers that only use the sampler API never need
+// to care. Callers that read `pixels` directly (HUD, blitters) must request
+// TEXTURE_LAYOUT_ROW_MAJOR, which is what texture_registry_get returns.
+typedef enum TextureLayout {
+	TEXTURE_LAYOUT_ROW_MAJOR = 0,    // pixels[y * width + x]
+	TEXTURE_LAYOUT_COLUMN_MAJOR = 1, // pixels[x * height + y] (walls, sky: sampled down a column)
+	TEXTURE_LAYOUT_MORTON = 2,       // Z-order curve (floors/ceilings: sampled along arbitrary lines)
+	// Request-only: column-major texels plus DOOM-style posts (see TexturePost). The
+	// loaded Texture reports TEXTURE_LAYOUT_COLUMN_MAJOR.
+	TEXTURE_LAYOUT_SPRITE_POSTS = 3,
+} TextureLayout;
+
+// One vertical run of opaque texels in a source column: rows [top, top + length).
+// Texels are transparent when they are the FF00FF colorkey or have zero alpha.
+typedef struct TexturePost {
+	uint16_t top;
+	uint16_t length;
+} TexturePost;
+
 typedef struct Texture {
 	int width;
 	int height;
-	uint32_t* pixels; // owned ABGR8888 (matches framebuffer)
+	uint32_t* pixels; // owned ABGR8888 (matches framebuffer), ordered per `layout`
+	TextureLayout layout;
+	// Opaque runs per column, sorted by `top` (NULL unless requested with
+	// TEXTURE_LAYOUT_SPRITE_POSTS). Column x owns posts[post_start[x] .. post_start[x + 1]).
+	int* post_start; // owned, width + 1
+	TexturePost* posts; // owned
+	// VGA palette index per texel, in the same order as `pixels` (NULL unless the
+	// registry is indexed, see texture_registry_set_indexed).
+	uint8_t* indices; // owned
 	char name[64];
 } Texture;
 
 typedef struct TextureRegistry {
 	Texture** items; // owned pointers; each Texture is heap-allocated and stable
+	TextureLayout* requested; // owned, parallel to items: layout each entry was requested with
 	int count;
 	int capacity;
+	bool indexed; // build Texture.indices for every loaded texture
 } TextureRegistry;
 
 // Optional perf counters for profiling. Only active when explicitly enabled.
@@ -40,5 +71,81 @@ void texture_registry_destroy(TextureRegistry* self);
 // Returns NULL on failure.
 const Texture* texture_registry_get(TextureRegistry* self, const AssetPaths* paths, const char* filename);
 
+// Like texture_registry_get, but stores the texels in the requested layout.
+// Each (filename, layout) pair is cached separately, so a texture used both as a
+// wall and as a floor is converted once per use. Morton order requires a square
+// power-of-two texture; other sizes fall back to row-major (see Texture.layout).
+const Texture* texture_registry_get_layout(TextureRegistry* self, const AssetPaths* paths, const char* filename, TextureLayout layout);
+
+// Quantizes every loaded texture (and every texture loaded from now on) to the VGA
+// palette so the renderer can take the paletted path. Turning it off keeps the
+// already-built index planes; they are only released with the registry.
+void texture_registry_set_indexed(TextureRegistry* self, bool indexed);
+
+// Spreads the low 16 bits of v so bit i lands on bit 2*i (Morton helper).
+static inline uint32_t texture_morton_spread(uint32_t v) {
+	v &= 0x0000FFFFu;
+	v = (v | (v << 8)) & 0x00FF00FFu;
+	v = (v | (v << 4)) & 0x0F0F0F0Fu;
+	v = (v | (v << 2)) & 0x33333333u;
+	v = (v | (v << 1)) & 0x55555555u;
+	return v;
+}
+
+// Storage offset of texel (x, y) (must be in range), independent of layout.
+static inline size_t texture_texel_offset(const Texture* t, int x, int y) {
+	switch (t->layout) {
+		case TEXTURE_LAYOUT_COLUMN_MAJOR:
+			return (size_t)x * (size_t)t->height + (size_t)y;
+		case TEXTURE_LAYOUT_MORTON:
+			return texture_morton_spread((uint32_t)x) | (texture_morton_spread((uint32_t)y) << 1);
+		default:
+			return (size_t)y * (size_t)t->width + (size_t)x;
+	}
+}
+
+// Texel fetch at integer coordinates (must be in range), independent of layout.
+static inline uint32_t texture_texel(const Texture* t, int x, int y) {
+	return t->pixels[texture_texel_offset(t, x, y)];
+}
+
 // Nearest sampling, u/v in [0,1].
 uint32_t texture_sample_nearest(const Texture* t, float u, float v);
+
+// Palette index of the texel texture_sample_nearest would return. Requires t->indices.
+uint8_t texture_sample_index_nearest(const Texture* t, float u, float v);
+
+// Vertical-span sampler: resolves the texel column for `u` once so a span of
+// samples at varying v only pays for the v lookup. For column-major textures
+// the column is contiguous and `col` points straight at it.
+typedef struct TextureColumn {
+	const Texture* t;
+	const uint32_t* col; // non-NULL when the column is contiguous
+	const uint8_t* col_index; // palette indices of `col` (NULL without t->indices)
+	int x;
+} TextureColumn;
+
+// Returns false if the texture has no pixels.
+bool texture_column_nearest(const Texture* t, float u, TextureColumn* out);
+
+// Nearest sampling along a column, v in [0,1]. Same rounding as texture_sample_nearest.
+static inline uint32_t texture_column_sample_nearest(const TextureColumn* c, float v) {
+	const Texture* t = c->t;
+	v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+	int y = (int)(v * (float)(t->height - 1) + 0.5f);
+	if (y > t->height - 1) {
+		y = t->height - 1;
+	}
+	return c->col ? c->col[y] : texture_texel(t, c->x, y);
+}
+
+// Palette-index variant of texture_column_sample_nearest. Requires t->indices.
+static inline uint8_t texture_column_sample_index_nearest(const TextureColumn* c, float v) {
+	const Texture* t = c->t;
+	v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+	int y = (int)(v * (float)(t->height - 1) + 0.5f);
+	if (y > t->height - 1) {
+		y = t->height - 1;
+	}
+	return c->col_index ? c->col_index[y] : t->indices[texture_texel_offset(t, c->x, y)];
+}
@@ -1,7 +1,42 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "render/framebuffer.h"
 
 // Clamps the framebuffer's RGB colors to a fixed 256-color VGA palette.
 // Operates in-place on the full screen (including UI).
 void vga_palette_apply(Framebuffer* fb);
+
+// Precision of the remap's color key: 15 (RGB555, 32K-entry table, SIMD gather),
+// 16 (RGB565) or 18 (RGB666, 256K entries). Finer keys pick the nearest palette
+// color more accurately for dark and near-gray colors; other values mean 15.
+#define VGA_LUT_BITS_DEFAULT 15
+void vga_palette_set_lut_bits(int bits);
+
+// Builds the lookup table for the current key precision now instead of on the first
+// remap (a few milliseconds; call when VGA mode is switched on).
+void vga_palette_prepare(void);
+
+// Writes the remapped colors of src[0..count) to dst (dst may alias src). Used to fuse
+// the remap with the copy into the present texture.
+void vga_palette_remap(uint32_t* dst, const uint32_t* src, size_t count);
+
+// Palette-indexed rendering (DOOM-style COLORMAP): textures carry one palette index
+// per texel and a light level selects a row mapping each index to its lit color.
+// Level L scales by L / (VGA_COLORMAP_LEVELS - 1), i.e. the renderer's 0..256 light
+// multiplier >> 3; the last level is unlit.
+#define VGA_COLORMAP_LEVELS 33
+
+// The 256 palette colors as opaque ABGR.
+const uint32_t* vga_palette_colors(void);
+
+// Palette index nearest to an ABGR color (exact search, independent of the key precision).
+uint8_t vga_palette_index_of(uint32_t abgr);
+
+// Lit palette index for each of the 256 indices at `level` (clamped).
+const uint8_t* vga_colormap_indices(int level);
+
+// Same row expanded to ABGR, for writing straight into a 32-bit target.
+const uint32_t* vga_colormap_row(int level);
@@ -1380,6 +1380,10 @@ bool map_load(MapLoadResult* out, const AssetPaths* paths, const char* map_filen
 	}
 
 	(void)world_build_sector_wall_index(&out->world);
+	if (!plane_lightmaps_bake(&out->world.lightmaps, &out->world)) {
+		// Non-fatal: planes fall back to per-pixel evaluation of every light.
+		log_warn("failed to bake plane lightmaps");
+	}
 
 	return true;
 }
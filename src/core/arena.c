@@ -0,0 +1,98 @@
+#include "core/arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ArenaBlock {
+	ArenaBlock* next;
+	size_t size; // usable bytes after the header
+	max_align_t data[];
+};
+
+static ArenaBlock* arena_block_new(size_t size) {
+	ArenaBlock* b = (ArenaBlock*)malloc(sizeof(ArenaBlock) + size);
+	if (!b) {
+		return NULL;
+	}
+	b->next = NULL;
+	b->size = size;
+	return b;
+}
+
+static void arena_free_chain(ArenaBlock* b) {
+	while (b) {
+		ArenaBlock* next = b->next;
+		free(b);
+		b = next;
+	}
+}
+
+void arena_init(Arena* self, size_t min_block) {
+	memset(self, 0, sizeof(*self));
+	self->min_block = min_block > 0 ? min_block : 64u * 1024u;
+}
+
+void arena_destroy(Arena* self) {
+	if (!self) {
+		return;
+	}
+	arena_free_chain(self->head);
+	memset(self, 0, sizeof(*self));
+}
+
+void arena_reset(Arena* self) {
+	if (!self) {
+		return;
+	}
+	if (self->head && self->head->next) {
+		// Several blocks were needed: replace them with one block that fits the peak.
+		size_t want = self->peak > self->min_block ? self->peak : self->min_block;
+		arena_free_chain(self->head);
+		self->head = arena_block_new(want);
+	}
+	self->used = 0;
+	self->peak = 0;
+}
+
+void* arena_alloc(Arena* self, size_t size, size_t align) {
+	if (!self || align == 0 || (align & (align - 1)) != 0) {
+		return NULL;
+	}
+	if (size == 0) {
+		size = 1;
+	}
+	if (self->head) {
+		uintptr_t base = (uintptr_t)self->head->data;
+		size_t off = (size_t)(((base + self->used + (align - 1)) & ~(uintptr_t)(align - 1)) - base);
+		if (off <= self->head->size && size <= self->head->size - off) {
+			self->peak += off + size - self->used;
+			self->used = off + size;
+			return (unsigned char*)self->head->data + off;
+		}
+	}
+	size_t want = size + align;
+	size_t grow = self->head ? self->head->size * 2u : self->min_block;
+	if (want < grow) {
+		want = grow;
+	}
+	ArenaBlock* b = arena_block_new(want);
+	if (!b) {
+		return NULL;
+	}
+	b->next = self->head;
+	self->head = b;
+	uintptr_t base = (uintptr_t)b->data;
+	size_t off = (size_t)(((base + (align - 1)) & ~(uintptr_t)(align - 1)) - base);
+	self->used = off + size;
+	self->peak += self->used;
+	return (unsigned char*)b->data + off;
+}
+
+size_t arena_capacity(const Arena* self) {
+	size_t total = 0;
+	for (const ArenaBlock* b = self ? self->head : NULL; b; b = b->next) {
+		total += b->size;
+	}
+	return total;
+}
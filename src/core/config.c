@@ -27,7 +27,13 @@ static CoreConfig g_cfg = {
 		.internal_height = 400,
 		.fov_deg = 75.0f,
 		.vga_mode = false,
+		.vga_lut_bits = 15,
 		.point_lights_enabled = true,
+		.depth_pixels = false,
+		.ui_layer = false,
+		.present_lock = false,
+		.composite_threads = 0,
+		.image_cache_kb = 2048,
 		.lighting = {
 			.enabled = true,
 			.fog_start = 6.0f,
@@ -37,6 +43,13 @@ static CoreConfig g_cfg = {
 			.quantize_steps = 16,
 			.quantize_low_cutoff = 0.08f,
 		},
+		.dynamic_resolution = {
+			.enabled = false,
+			.target_ms = 8.0f,
+			.min_scale = 0.5f,
+			.max_scale = 1.0f,
+			.step = 0.125f,
+		},
 	},
 	.audio = {
 		.enabled = true,
@@ -508,7 +521,7 @@ bool core_config_load_from_file(const char* path, const AssetPaths* assets, Conf
 				log_error("Config: %s: render must be an object", path);
 				ok = false;
 			} else {
-				static const char* const allowed_render[] = {"internal_width", "internal_height", "fov_deg", "vga_mode", "point_lights_enabled", "lighting"};
+				static const char* const allowed_render[] = {"internal_width", "internal_height", "fov_deg", "vga_mode", "vga_lut_bits", "point_lights_enabled", "depth_pixels", "ui_layer", "present_lock", "composite_threads", "image_cache_kb", "lighting", "dynamic_resolution"};
 				warn_unknown_keys(&doc, t_render, allowed_render, (int)(sizeof(allowed_render) / sizeof(allowed_render[0])), "render");
 
 				int t_iw = -1;
@@ -551,6 +564,16 @@ bool core_config_load_from_file(const char* path, const AssetPaths* assets, Conf
 						next.render.vga_mode = b;
 					}
 				}
+				int t_vlb = -1;
+				if (json_object_get(&doc, t_render, "vga_lut_bits", &t_vlb)) {
+					int v = 0;
+					if (!json_get_int(&doc, t_vlb, &v) || (v != 15 && v != 16 && v != 18)) {
+						log_error("Config: %s: render.vga_lut_bits must be 15, 16 or 18", path);
+						ok = false;
+					} else {
+						next.render.vga_lut_bits = v;
+					}
+				}
 				int t_pl = -1;
 				if (json_object_get(&doc, t_render, "point_lights_enabled", &t_pl)) {
 					bool b = false;
@@ -561,6 +584,56 @@ bool core_config_load_from_file(const char* path, const AssetPaths* assets, Conf
 						next.render.point_lights_enabled = b;
 					}
 				}
+				int t_dp = -1;
+				if (json_object_get(&doc, t_render, "depth_pixels", &t_dp)) {
+					bool b = false;
+					if (!json_get_bool_any(&doc, t_dp, &b)) {
+						log_error("Config: %s: render.depth_pixels must be bool", path);
+						ok = false;
+					} else {
+						next.render.depth_pixels = b;
+					}
+				}
+				int t_ul = -1;
+				if (json_object_get(&doc, t_render, "ui_layer", &t_ul)) {
+					bool b = false;
+					if (!json_get_bool_any(&doc, t_ul, &b)) {
+						log_error("Config: %s: render.ui_layer must be bool", path);
+						ok = false;
+					} else {
+						next.render.ui_layer = b;
+					}
+				}
+				int t_plk = -1;
+				if (json_object_get(&doc, t_render, "present_lock", &t_plk)) {
+					bool b = false;
+					if (!json_get_bool_any(&doc, t_plk, &b)) {
+						log_error("Config: %s: render.present_lock must be bool", path);
+						ok = false;
+					} else {
+						next.render.present_lock = b;
+					}
+				}
+				int t_ct = -1;
+				if (json_object_get(&doc, t_render, "composite_threads", &t_ct)) {
+					int v = 0;
+					if (!json_get_int(&doc, t_ct, &v) || v < 0 || v > 16) {
+						log_error("Config: %s: render.composite_threads must be int in [0..16]", path);
+						ok = false;
+					} else {
+						next.render.composite_threads = v;
+					}
+				}
+				int t_ic = -1;
+				if (json_object_get(&doc, t_render, "image_cache_kb", &t_ic)) {
+					int v = 0;
+					if (!json_get_int(&doc, t_ic, &v) || v < 0 || v > 262144) {
+						log_error("Config: %s: render.image_cache_kb must be int in [0..262144]", path);
+						ok = false;
+					} else {
+						next.render.image_cache_kb = v;
+					}
+				}
 
 				int t_light = -1;
 				if (json_object_get(&doc, t_render, "lighting", &t_light)) {
@@ -655,6 +728,72 @@ bool core_config_load_from_file(const char* path, const AssetPaths* assets, Conf
 						}
 					}
 				}
+
+				int t_dr = -1;
+				if (json_object_get(&doc, t_render, "dynamic_resolution", &t_dr)) {
+					if (!json_token_is_object(&doc, t_dr)) {
+						log_error("Config: %s: render.dynamic_resolution must be an object", path);
+						ok = false;
+					} else {
+						static const char* const allowed_dr[] = {"enabled", "target_ms", "min_scale", "max_scale", "step"};
+						warn_unknown_keys(&doc, t_dr, allowed_dr, (int)(sizeof(allowed_dr) / sizeof(allowed_dr[0])), "render.dynamic_resolution");
+
+						int t_en = -1;
+						if (json_object_get(&doc, t_dr, "enabled", &t_en)) {
+							bool b = false;
+							if (!json_get_bool_any(&doc, t_en, &b)) {
+								log_error("Config: %s: render.dynamic_resolution.enabled must be bool", path);
+								ok = false;
+							} else {
+								next.render.dynamic_resolution.enabled = b;
+							}
+						}
+						int t_tm = -1;
+						if (json_object_get(&doc, t_dr, "target_ms", &t_tm)) {
+							float v = 0.0f;
+							if (!json_get_float_any(&doc, t_tm, &v) || v < 0.5f || v > 1000.0f) {
+								log_error("Config: %s: render.dynamic_resolution.target_ms must be number in [0.5..1000]", path);
+								ok = false;
+							} else {
+								next.render.dynamic_resolution.target_ms = v;
+							}
+						}
+						int t_mn = -1;
+						if (json_object_get(&doc, t_dr, "min_scale", &t_mn)) {
+							float v = 0.0f;
+							if (!json_get_float_any(&doc, t_mn, &v) || v < 0.25f || v > 1.0f) {
+								log_error("Config: %s: render.dynamic_resolution.min_scale must be number in [0.25..1]", path);
+								ok = false;
+							} else {
+								next.render.dynamic_resolution.min_scale = v;
+							}
+						}
+						int t_mx = -1;
+						if (json_object_get(&doc, t_dr, "max_scale", &t_mx)) {
+							float v = 0.0f;
+							if (!json_get_float_any(&doc, t_mx, &v) || v < 0.25f || v > 1.0f) {
+								log_error("Config: %s: render.dynamic_resolution.max_scale must be number in [0.25..1]", path);
+								ok = false;
+							} else {
+								next.render.dynamic_resolution.max_scale = v;
+							}
+						}
+						if (next.render.dynamic_resolution.max_scale < next.render.dynamic_resolution.min_scale) {
+							log_error("Config: %s: render.dynamic_resolution.max_scale must be >= min_scale", path);
+							ok = false;
+						}
+						int t_st = -1;
+						if (json_object_get(&doc, t_dr, "step", &t_st)) {
+							float v = 0.0f;
+							if (!json_get_float_any(&doc, t_st, &v) || v < 0.01f || v > 0.5f) {
+								log_error("Config: %s: render.dynamic_resolution.step must be number in [0.01..0.5]", path);
+								ok = false;
+							} else {
+								next.render.dynamic_resolution.step = v;
+							}
+						}
+					}
+				}
 			}
 		}
 
@@ -1543,6 +1682,47 @@ CoreConfigSetStatus core_config_try_set_by_path(
 	if (key_eq(key_path, "render.vga_mode")) {
 		return set_bool(&g_cfg.render.vga_mode, key_path, provided_kind, value_str, out_expected_kind);
 	}
+	if (key_eq(key_path, "render.vga_lut_bits")) {
+		int v = g_cfg.render.vga_lut_bits;
+		CoreConfigSetStatus st = set_int(&v, 15, 18, provided_kind, value_str, out_expected_kind);
+		if (st == CORE_CONFIG_SET_OK) {
+			if (v == 17) {
+				return CORE_CONFIG_SET_INVALID_VALUE;
+			}
+			g_cfg.render.vga_lut_bits = v;
+		}
+		return st;
+	}
+	if (key_eq(key_path, "render.depth_pixels")) {
+		return set_bool(&g_cfg.render.depth_pixels, key_path, provided_kind, value_str, out_expected_kind);
+	}
+	if (key_eq(key_path, "render.ui_layer")) {
+		return set_bool(&g_cfg.render.ui_layer, key_path, provided_kind, value_str, out_expected_kind);
+	}
+	if (key_eq(key_path, "render.present_lock")) {
+		return set_bool(&g_cfg.render.present_lock, key_path, provided_kind, value_str, out_expected_kind);
+	}
+	if (key_eq(key_path, "render.composite_threads")) {
+		return set_int(&g_cfg.render.composite_threads, 0, 16, provided_kind, value_str, out_expected_kind);
+	}
+	if (key_eq(key_path, "render.image_cache_kb")) {
+		return set_int(&g_cfg.render.image_cache_kb, 0, 262144, provided_kind, value_str, out_expected_kind);
+	}
+	if (key_eq(key_path, "render.dynamic_resolution.enabled")) {
+		return set_bool(&g_cfg.render.dynamic_resolution.enabled, key_path, provided_kind, value_str, out_expected_kind);
+	}
+	if (key_eq(key_path, "render.dynamic_resolution.target_ms")) {
+		return set_float(&g_cfg.render.dynamic_resolution.target_ms, 0.5f, 1000.0f, provided_kind, value_str, out_expected_kind);
+	}
+	if (key_eq(key_path, "render.dynamic_resolution.min_scale")) {
+		return set_float(&g_cfg.render.dynamic_resolution.min_scale, 0.25f, 1.0f, provided_kind, value_str, out_expected_kind);
+	}
+	if (key_eq(key_path, "render.dynamic_resolution.max_scale")) {
+		return set_float(&g_cfg.render.dynamic_resolution.max_scale, 0.25f, 1.0f, provided_kind, value_str, out_expected_kind);
+	}
+	if (key_eq(key_path, "render.dynamic_resolution.step")) {
+		return set_float(&g_cfg.render.dynamic_resolution.step, 0.01f, 0.5f, provided_kind, value_str, out_expected_kind);
+	}
 	if (key_eq(key_path, "render.lighting.enabled")) {
 		return set_bool(&g_cfg.render.lighting.enabled, key_path, provided_kind, value_str, out_expected_kind);
 	}
@@ -202,6 +202,7 @@ void console_set_open(Console* con, bool open) {
 		return;
 	}
 	con->open = open;
+	con->version++;
 	// Contents are not preserved between open/close.
 	if (!open) {
 		console_clear(con);
@@ -232,6 +233,7 @@ void console_clear(Console* con) {
 	con->line_head = 0;
 	con->line_count = 0;
 	con->scroll = 0;
+	con->version++;
 	for (int i = 0; i < CONSOLE_MAX_LINES; i++) {
 		con->lines[i][0] = '\0';
 	}
@@ -328,6 +330,7 @@ void console_print(Console* con, const char* line) {
 	}
 	strncpy(con->lines[slot], line, CONSOLE_LINE_MAX - 1);
 	con->lines[slot][CONSOLE_LINE_MAX - 1] = '\0';
+	con->version++;
 }
 
 bool console_register_command(Console* con, ConsoleCommand cmd) {
@@ -376,6 +379,9 @@ void console_update(Console* con, const Input* in, void* user_ctx) {
 	if (!con || !in || !con->open) {
 		return;
 	}
+	if (in->text_utf8_len > 0 || in->key_event_count > 0) {
+		con->version++;
+	}
 
 	// Text input for this frame.
 	if (con->suppress_text_once) {
@@ -677,6 +683,7 @@ void console_blink_update(Console* con, float dt) {
 	while (con->blink_timer >= 0.5f) {
 		con->blink_timer -= 0.5f;
 		con->blink_on = !con->blink_on;
+		con->version++;
 	}
 }
 
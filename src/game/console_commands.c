@@ -21,12 +21,18 @@
 #include "game/notifications.h"
 
 #include "render/camera.h"
+#include "render/compositor.h"
+#include "render/dynres.h"
 #include "render/raycast.h"
+#include "render/texture.h"
+#include "render/vga_palette.h"
 
 #include "game/scene_screen.h"
 
 #include "core/path_safety.h"
 
+#include "platform/audio.h"
+
 #include <SDL.h>
 
 #include <ctype.h>
@@ -173,6 +179,26 @@ static void refresh_runtime_audio(ConsoleCommandContext* ctx) {
 	sound_emitters_set_enabled(ctx->sfx_emitters, (*ctx->audio_enabled) && (*ctx->sound_emitters_enabled));
 }
 
+void console_commands_apply_render_config(ConsoleCommandContext* ctx) {
+	const CoreConfig* cfg = (ctx && ctx->cfg && *ctx->cfg) ? *ctx->cfg : NULL;
+	if (!cfg) {
+		return;
+	}
+	// VGA mode: build the remap table now rather than in the first VGA present, and
+	// quantize textures to the palette once so walls and planes light via the colormap.
+	vga_palette_set_lut_bits(cfg->render.vga_lut_bits);
+	if (cfg->render.vga_mode) {
+		vga_palette_prepare();
+	}
+	if (ctx->texreg) {
+		texture_registry_set_indexed(ctx->texreg, cfg->render.vga_mode);
+	}
+	raycast_set_palette_mode(cfg->render.vga_mode);
+	if (ctx->compositor) {
+		(void)compositor_set_threads(ctx->compositor, cfg->render.composite_threads);
+	}
+}
+
 static void maybe_start_music_for_map(ConsoleCommandContext* ctx) {
 	if (!ctx || !ctx->paths || !ctx->audio_enabled || !ctx->music_enabled || !ctx->map_ok || !ctx->map) {
 		return;
@@ -443,6 +469,7 @@ static bool cmd_load_timeline(Console* con, int argc, const char** argv, void* u
 static bool cmd_load_scene(Console* con, int argc, const char** argv, void* user_ctx);
 static bool cmd_dump_perf(Console* con, int argc, const char** argv, void* user_ctx);
 static bool cmd_dump_entities(Console* con, int argc, const char** argv, void* user_ctx);
+static bool cmd_sfx_stats(Console* con, int argc, const char** argv, void* user_ctx);
 static bool cmd_show_fps(Console* con, int argc, const char** argv, void* user_ctx);
 static bool cmd_noclip(Console* con, int argc, const char** argv, void* user_ctx);
 static bool cmd_show_debug(Console* con, int argc, const char** argv, void* user_ctx);
@@ -655,6 +682,7 @@ static bool cmd_config_reload(Console* con, int argc, const char** argv, void* u
 		}
 	}
 	refresh_runtime_audio(ctx);
+	console_commands_apply_render_config(ctx);
 	if (ctx->win && ctx->cfg && *ctx->cfg) {
 		bool should_apply = true;
 		if (ctx->mouse_captured) {
@@ -720,6 +748,7 @@ static bool cmd_config_change(Console* con, int argc, const char** argv, void* u
 		return false;
 	}
 	refresh_runtime_audio(ctx);
+	console_commands_apply_render_config(ctx);
 	console_print(con, "OK");
 	return true;
 }
@@ -837,6 +866,12 @@ static void dump_entities_to_file(FILE* out, void* u) {
 	}
 	const CoreConfig* cfg = (ctx->cfg && *ctx->cfg) ? *ctx->cfg : core_config_get();
 	Camera cam = camera_make(ctx->player->body.x, ctx->player->body.y, ctx->player->angle_deg, cfg ? cfg->render.fov_deg : 75.0f);
+	int world_w = ctx->fb->width;
+	int world_h = ctx->fb->height;
+	if (ctx->dynres && ctx->dynres->width > 0 && ctx->dynres->height > 0) {
+		world_w = ctx->dynres->width;
+		world_h = ctx->dynres->height;
+	}
 	debug_dump_print_entities(
 		out,
 		(ctx->map_name_buf && ctx->map_name_buf[0]) ? ctx->map_name_buf : "(unknown)",
@@ -844,8 +879,8 @@ static void dump_entities_to_file(FILE* out, void* u) {
 		ctx->player,
 		&cam,
 		ctx->entities,
-		ctx->fb->width,
-		ctx->fb->height,
+		world_w,
+		world_h,
 		ctx->wall_depth);
 }
 
@@ -863,6 +898,26 @@ static bool cmd_dump_entities(Console* con, int argc, const char** argv, void* u
 	return true;
 }
 
+static bool cmd_sfx_stats(Console* con, int argc, const char** argv, void* user_ctx) {
+	(void)argc;
+	(void)argv;
+	(void)user_ctx;
+	SfxMemoryStats st;
+	sfx_get_memory_stats(&st);
+	char buf[160];
+	snprintf(buf, sizeof(buf), "resident: %d samples, %zu KB int16 (%zu KB as stereo float)", st.resident_samples, st.resident_bytes / 1024u,
+		st.resident_float_bytes / 1024u);
+	console_print(con, buf);
+	snprintf(buf, sizeof(buf), "streamed: %d samples, %zu KB on disk", st.streamed_samples, st.streamed_source_bytes / 1024u);
+	console_print(con, buf);
+	snprintf(buf, sizeof(buf), "streams: %d/%d active, %zu KB buffers, %u underruns, %u rejected", st.streams_active, st.stream_slots,
+		st.stream_buffer_bytes / 1024u, (unsigned)st.stream_underruns, (unsigned)st.stream_rejects);
+	console_print(con, buf);
+	snprintf(buf, sizeof(buf), "voices: %d/%d playing", st.voices_playing, st.voice_slots);
+	console_print(con, buf);
+	return true;
+}
+
 static bool cmd_show_fps(Console* con, int argc, const char** argv, void* user_ctx) {
 	ConsoleCommandContext* ctx = (ConsoleCommandContext*)user_ctx;
 	return cmd_set_bool(con, argc, argv, ctx ? ctx->show_fps : NULL);
@@ -1150,6 +1205,13 @@ void console_commands_register_all(Console* con) {
 		.syntax = "dump_entities",
 		.fn = cmd_dump_entities,
 	});
+	(void)console_register_command(con, (ConsoleCommand){
+		.name = "sfx_stats",
+		.description = "Prints SFX sample memory, streaming and voice counters.",
+		.example = "sfx_stats",
+		.syntax = "sfx_stats",
+		.fn = cmd_sfx_stats,
+	});
 	(void)console_register_command(con, (ConsoleCommand){
 		.name = "show_fps",
 		.description = "Shows current frames per second.",
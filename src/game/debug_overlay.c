@@ -13,7 +13,7 @@ static inline ColorRGBA color_from_abgr(uint32_t abgr) {
 	return c;
 }
 
-void debug_overlay_draw(FontSystem* font, Framebuffer* fb, const Player* player, const World* world, const EntitySystem* entities, int fps) {
+void debug_overlay_draw(FontSystem* font, Framebuffer* fb, const Player* player, const World* world, const EntitySystem* entities, const DynRes* dynres, int fps) {
 	if (!fb || !player) {
 		return;
 	}
@@ -46,4 +46,9 @@ void debug_overlay_draw(FontSystem* font, Framebuffer* fb, const Player* player,
 			font_draw_text(font, fb, 8, 72, line, color_from_abgr(0xFF90E0FFu), 1.0f);
 		}
 	}
+
+	if (dynres) {
+		snprintf(line, sizeof(line), "RES  3D: %dx%d  scale=%.3f  avg=%.2fms  last=%s  steps: -%u +%u", dynres->width, dynres->height, dynres->scale, dynres->avg_ms > 0.0 ? dynres->avg_ms : 0.0, dynres_decision_name(dynres->last_decision), dynres->steps_down, dynres->steps_up);
+		font_draw_text(font, fb, 8, 80, line, color_from_abgr(0xFFFFD080u), 1.0f);
+	}
 }
@@ -1,6 +1,7 @@
 #include "game/entities.h"
 
 #include "assets/json.h"
+#include "core/arena.h"
 #include "core/log.h"
 
 #include "game/collision.h"
@@ -8,6 +9,7 @@
 #include "game/world.h"
 
 #include "platform/time.h"
+#include "render/depth_pyramid.h"
 #include "render/raycast.h"
 
 #include <math.h>
@@ -3831,6 +3833,7 @@ uint32_t entity_system_alive_count(const EntitySystem* es) {
 }
 
 typedef struct SpriteDrawItem {
+	uint32_t key; // sort key: back-to-front order of depth (see sprite_depth_key)
 	float depth;
 	const Entity* e;
 	const EntityDef* def;
@@ -3871,16 +3874,43 @@ static uint32_t apply_lighting_mul_u8_2(uint32_t rgba, int r_mul_i, int g_mul_i,
 	return ((uint32_t)a << 24) | ((uint32_t)clamp_u8_2(rr) << 16) | ((uint32_t)clamp_u8_2(gg) << 8) | (uint32_t)clamp_u8_2(bb);
 }
 
-static void sort_sprites_back_to_front(SpriteDrawItem* items, int n) {
-	// Stable insertion sort (deterministic for equal depths).
-	for (int i = 1; i < n; i++) {
-		SpriteDrawItem key = items[i];
-		int j = i - 1;
-		while (j >= 0 && items[j].depth < key.depth) {
-			items[j + 1] = items[j];
-			j--;
+// Quantized depth for sorting. Positive IEEE floats order like their bit patterns,
+// so the raw bits are an exact quantization; inverting them makes farther sort first.
+static uint32_t sprite_depth_key(float depth) {
+	uint32_t bits = 0u;
+	memcpy(&bits, &depth, sizeof(bits));
+	return ~bits;
+}
+
+// Stable LSD radix sort (8 bits per pass) by ascending key, i.e. back to front.
+// Passes where every key shares the same byte are skipped. `tmp` must hold n items.
+static void sort_sprites_back_to_front(SpriteDrawItem* items, SpriteDrawItem* tmp, int n) {
+	SpriteDrawItem* src = items;
+	SpriteDrawItem* dst = tmp;
+	for (int shift = 0; shift < 32; shift += 8) {
+		uint32_t counts[256];
+		memset(counts, 0, sizeof(counts));
+		for (int i = 0; i < n; i++) {
+			counts[(src[i].key >> shift) & 0xFFu]++;
+		}
+		if (counts[(src[0].key >> shift) & 0xFFu] == (uint32_t)n) {
+			continue;
+		}
+		uint32_t sum = 0u;
+		for (int b = 0; b < 256; b++) {
+			uint32_t c = counts[b];
+			counts[b] = sum;
+			sum += c;
 		}
-		items[j + 1] = key;
+		for (int i = 0; i < n; i++) {
+			dst[counts[(src[i].key >> shift) & 0xFFu]++] = src[i];
+		}
+		SpriteDrawItem* t = src;
+		src = dst;
+		dst = t;
+	}
+	if (src != items) {
+		memcpy(items, src, (size_t)n * sizeof(SpriteDrawItem));
 	}
 }
 
@@ -3903,6 +3933,67 @@ static float camera_world_z_for_sector_approx(const World* world, int sector, fl
 	return z;
 }
 
+// Source row (relative to the frame) sampled by screen row y of a sprite spanning
+// [y0, y0 + sprite_h_px). Nearest sampling, same rounding as texture_sample_nearest.
+static int sprite_texel_row(int y, int y0, int sprite_h_px, int frame_h) {
+	float v = clampf2((float)(y - y0) / (float)(sprite_h_px - 1), 0.0f, 1.0f);
+	int row = (int)(v * (float)(frame_h - 1) + 0.5f);
+	return row < frame_h - 1 ? row : frame_h - 1;
+}
+
+// First screen row whose source row is >= `row` (y0 + sprite_h_px if none).
+static int sprite_first_screen_row(int row, int y0, int sprite_h_px, int frame_h) {
+	if (row <= 0) {
+		return y0;
+	}
+	if (row >= frame_h) {
+		return y0 + sprite_h_px;
+	}
+	// Invert the mapping, then fix up float rounding against the exact forward mapping.
+	float k = (float)(sprite_h_px - 1) / (float)(frame_h - 1);
+	int y = y0 + (int)ceilf(((float)row - 0.5f) * k);
+	y = y < y0 ? y0 : (y > y0 + sprite_h_px ? y0 + sprite_h_px : y);
+	while (y > y0 && sprite_texel_row(y - 1, y0, sprite_h_px, frame_h) >= row) {
+		y--;
+	}
+	while (y < y0 + sprite_h_px && sprite_texel_row(y, y0, sprite_h_px, frame_h) < row) {
+		y++;
+	}
+	return y;
+}
+
+// Conservative horizontal frustum test, done before a sprite enters the draw list.
+// Mirrors the projection in entity_system_draw_sprites; sprites whose size is only
+// known once the texture loads are never culled here.
+static bool sprite_outside_horizontal_fov(const EntityDef* def, float side, float depth, float focal, int fb_w, int fb_h) {
+	int frame_w = def->sprite.frames.width > 0 ? def->sprite.frames.width : def->sprite.file.width;
+	int frame_h = def->sprite.frames.height > 0 ? def->sprite.frames.height : def->sprite.file.height;
+	float w_world = ((float)frame_w / 64.0f) * def->sprite.scale;
+	float h_world = ((float)frame_h / 64.0f) * def->sprite.scale;
+	if (w_world <= 1e-6f || h_world <= 1e-6f) {
+		return false;
+	}
+	float proj_depth = depth < 0.25f ? 0.25f : depth;
+	float scale = focal / proj_depth;
+	float max_scale = fminf((float)(fb_w * 2) / w_world, (float)(fb_h * 2) / h_world);
+	if (max_scale > 1e-6f && scale > max_scale) {
+		scale = max_scale;
+	}
+	// One pixel of slack for the draw path's rounding.
+	return (fabsf(side) - 0.5f * w_world) * scale > 0.5f * (float)fb_w + 1.0f;
+}
+
+// Records a column run of drawn sprite pixels as an occluder for later billboards.
+static void sprite_depth_run_write(DepthSpans* spans, DepthPyramid* pyramid, int x, int y0, int y1, float depth) {
+	if (y0 >= y1) {
+		return;
+	}
+	if (spans) {
+		depth_spans_push_const(spans, x, y0, y1, depth);
+	}
+	depth_pyramid_lower(pyramid, x, y0, y1, depth);
+}
+
 void entity_system_draw_sprites(
 	const EntitySystem* es,
 	Framebuffer* fb,
@@ -3912,12 +4003,18 @@ void entity_system_draw_sprites(
 	TextureRegistry* texreg,
 	const AssetPaths* paths,
 	const float* wall_depth,
-	float* depth_pixels
+	float* depth_pixels,
+	DepthSpans* depth_spans,
+	DepthPyramid* depth_pyramid,
+	Arena* frame_arena
 ) {
-	if (!es || !fb || !fb->pixels || !world || !cam || !texreg || !paths || !es->defs) {
+	if (!es || !fb || !fb->pixels || !world || !cam || !texreg || !paths || !es->defs || !frame_arena) {
+		return;
+	}
+	if (es->alive_count == 0u) {
 		return;
 	}
-	if (!wall_depth && !depth_pixels) {
+	if (!wall_depth && !depth_pixels && !depth_spans) {
 		return;
 	}
 
@@ -3925,10 +4022,6 @@ void entity_system_draw_sprites(
 	PointLight vis_lights[96];
 	int vis_count = raycast_build_visible_lights(vis_lights, (int)MORTUM_ARRAY_COUNT(vis_lights), world, cam, (float)platform_time_seconds());
 
-	// Gather visible sprite entities.
-	SpriteDrawItem items[256];
-	int count = 0;
-
 	float cam_rad = deg_to_rad2(cam->angle_deg);
 	float fx = cosf(cam_rad);
 	float fy = sinf(cam_rad);
@@ -3945,6 +4038,13 @@ void entity_system_draw_sprites(
 
 	float cam_z_world = camera_world_z_for_sector_approx(world, start_sector, cam->z);
 
+	// Gather visible sprite entities into a per-frame draw list (at most one per live entity).
+	SpriteDrawItem* items = ARENA_ALLOC_ARRAY(frame_arena, SpriteDrawItem, es->alive_count);
+	if (!items) {
+		return;
+	}
+	int count = 0;
+
 	for (uint32_t i = 0; i < es->capacity; i++) {
 		if (!es->alive[i]) {
 			continue;
@@ -3960,24 +4060,36 @@ void entity_system_draw_sprites(
 		if (depth <= 0.05f) {
 			continue;
 		}
-		if (count < (int)MORTUM_ARRAY_COUNT(items)) {
-			items[count].depth = depth;
-			items[count].e = e;
-			items[count].def = def;
-			count++;
+		if (sprite_outside_horizontal_fov(def, dx * rx + dy * ry, depth, focal, fb->width, fb->height)) {
+			continue;
+		}
+		if (count >= (int)es->alive_count) {
+			break;
 		}
+		items[count].key = sprite_depth_key(depth);
+		items[count].depth = depth;
+		items[count].e = e;
+		items[count].def = def;
+		count++;
 	}
 
 	if (count <= 0) {
 		return;
 	}
 
-	sort_sprites_back_to_front(items, count);
+	if (count > 1) {
+		SpriteDrawItem* tmp = ARENA_ALLOC_ARRAY(frame_arena, SpriteDrawItem, count);
+		if (!tmp) {
+			return;
+		}
+		sort_sprites_back_to_front(items, tmp, count);
+	}
 
 	for (int si = 0; si < count; si++) {
 		const Entity* e = items[si].e;
 		const EntityDef* def = items[si].def;
-		const Texture* tex = texture_registry_get(texreg, paths, def->sprite.file.name);
+		// Column-major texels plus opaque-run posts (see TexturePost).
+		const Texture* tex = texture_registry_get_layout(texreg, paths, def->sprite.file.name, TEXTURE_LAYOUT_SPRITE_POSTS);
 		if (!tex || !tex->pixels) {
 			continue;
 		}
@@ -4082,6 +4194,13 @@ void entity_system_draw_sprites(
 			continue;
 		}
 
+		// Coarse occlusion: skip fully hidden sprites; fully visible ones need no per-pixel tests.
+		DepthPyramidResult occ = depth_pyramid_test_rect(depth_pyramid, clip_x0, clip_y0, clip_x1, clip_y1, depth);
+		if (occ == DEPTH_PYRAMID_HIDDEN) {
+			continue;
+		}
+		bool test_pixels = (depth_pixels || depth_spans) && occ != DEPTH_PYRAMID_VISIBLE;
+
 		// Compute a single lighting multiplier for the whole sprite at the entity's position.
 		// This keeps sprite lighting cheap and deterministic.
 		int sector = e->body.sector;
@@ -4110,42 +4229,83 @@ void entity_system_draw_sprites(
 			if (wall_depth && depth >= wall_depth[x]) {
 				continue;
 			}
-			float u = (float)(x - x0) / (float)(sprite_w_px - 1);
-			u = clampf2(u, 0.0f, 1.0f);
-			float tex_u = (float)(frame_x) / (float)(sheet_w - 1);
-			float tex_u_span = (float)(frame_w - 1) / (float)(sheet_w - 1);
-			tex_u = tex_u + u * tex_u_span;
-			for (int y = clip_y0; y < clip_y1; y++) {
-				if (depth_pixels) {
-					float world_depth = depth_pixels[y * fb->width + x];
-					if (depth >= world_depth) {
-						continue;
-					}
-				}
-				float v = (float)(y - y0) / (float)(sprite_h_px - 1);
-				v = clampf2(v, 0.0f, 1.0f);
-				float tex_v = (float)(frame_y) / (float)(sheet_h - 1);
-				float tex_v_span = (float)(frame_h - 1) / (float)(sheet_h - 1);
-				tex_v = tex_v + v * tex_v_span;
-				uint32_t c = texture_sample_nearest(tex, tex_u, tex_v);
-				// Global sprite colorkey: FF00FF (magenta) is transparent.
-				if ((c & 0x00FFFFFFu) == 0x00FF00FFu) {
+			bool test_column = test_pixels;
+			if (test_pixels) {
+				DepthPyramidResult col = depth_pyramid_test_column(depth_pyramid, x, depth);
+				if (col == DEPTH_PYRAMID_HIDDEN) {
 					continue;
 				}
-				if ((c & 0xFF000000u) == 0u) {
+				test_column = col != DEPTH_PYRAMID_VISIBLE;
+			}
+			float u = (float)(x - x0) / (float)(sprite_w_px - 1);
+			u = clampf2(u, 0.0f, 1.0f);
+			int sx = frame_x + (int)(u * (float)(frame_w - 1) + 0.5f);
+			const uint32_t* src_col = tex->layout == TEXTURE_LAYOUT_COLUMN_MAJOR ? &tex->pixels[(size_t)sx * (size_t)sheet_h] : NULL;
+
+			// Walk only the opaque posts of this source column. Without a post index the
+			// whole column is one post and texels are alpha-tested individually.
+			TexturePost whole = {0u, (uint16_t)(sheet_h < UINT16_MAX ? sheet_h : UINT16_MAX)};
+			const TexturePost* posts = &whole;
+			int post_count = 1;
+			bool alpha_test = true;
+			if (tex->posts) {
+				posts = &tex->posts[tex->post_start[sx]];
+				post_count = tex->post_start[sx + 1] - tex->post_start[sx];
+				alpha_test = false;
+			}
+
+			// Current run of drawn pixels [run_y0, run_y1) in this column; written back as one
+			// depth span (when depth_pixels is not in use) and into the depth pyramid.
+			int run_y0 = 0;
+			int run_y1 = 0;
+			for (int pi = 0; pi < post_count; pi++) {
+				int top = (int)posts[pi].top - frame_y;
+				int bottom = top + (int)posts[pi].length;
+				top = top < 0 ? 0 : top;
+				bottom = bottom > frame_h ? frame_h : bottom;
+				if (top >= bottom) {
 					continue;
 				}
-				int idx = y * fb->width + x;
-				fb->pixels[idx] = apply_lighting_mul_u8_2(c, r_mul_i, g_mul_i, b_mul_i);
-				// Write sprite depth into the shared per-pixel depth buffer so later billboard draws
-				// (e.g. particles) can depth-test against entity sprites.
-				if (depth_pixels) {
-					float prev = depth_pixels[idx];
-					if (depth < prev) {
-						depth_pixels[idx] = depth;
+				int py0 = sprite_first_screen_row(top, y0, sprite_h_px, frame_h);
+				int py1 = sprite_first_screen_row(bottom, y0, sprite_h_px, frame_h);
+				py0 = py0 < clip_y0 ? clip_y0 : py0;
+				py1 = py1 > clip_y1 ? clip_y1 : py1;
+				for (int y = py0; y < py1; y++) {
+					if (test_column) {
+						float world_depth = depth_pixels ? depth_pixels[y * fb->width + x] : depth_spans_depth_at(depth_spans, x, y);
+						if (depth >= world_depth) {
+							continue;
+						}
+					}
+					int sy = frame_y + sprite_texel_row(y, y0, sprite_h_px, frame_h);
+					uint32_t c = src_col ? src_col[sy] : texture_texel(tex, sx, sy);
+					if (alpha_test) {
+						// Global sprite colorkey: FF00FF (magenta) is transparent.
+						if ((c & 0x00FFFFFFu) == 0x00FF00FFu) {
+							continue;
+						}
+						if ((c & 0xFF000000u) == 0u) {
+							continue;
+						}
+					}
+					int idx = y * fb->width + x;
+					fb->pixels[idx] = apply_lighting_mul_u8_2(c, r_mul_i, g_mul_i, b_mul_i);
+					// Write sprite depth into the shared per-pixel depth buffer so later billboard draws
+					// (e.g. particles) can depth-test against entity sprites.
+					if (depth_pixels) {
+						float prev = depth_pixels[idx];
+						if (depth < prev) {
+							depth_pixels[idx] = depth;
+						}
+					}
+					if (run_y1 != y) {
+						sprite_depth_run_write(depth_pixels ? NULL : depth_spans, depth_pyramid, x, run_y0, run_y1, depth);
+						run_y0 = y;
 					}
+					run_y1 = y + 1;
 				}
 			}
+			sprite_depth_run_write(depth_pixels ? NULL : depth_spans, depth_pyramid, x, run_y0, run_y1, depth);
 		}
 	}
 }
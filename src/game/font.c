@@ -277,8 +277,9 @@ static inline uint32_t blend_abgr8888_over(uint32_t src, uint32_t dst) {
 	unsigned out_r = (src_r * a + dst_r * inv_a + 127u) / 255u;
 	unsigned out_g = (src_g * a + dst_g * inv_a + 127u) / 255u;
 	unsigned out_b = (src_b * a + dst_b * inv_a + 127u) / 255u;
+	unsigned out_a = (255u * a + ((unsigned)(dst >> 24) & 0xFFu) * inv_a + 127u) / 255u;
 
-	return (0xFFu << 24) | (out_b << 16) | (out_g << 8) | out_r;
+	return (out_a << 24) | (out_b << 16) | (out_g << 8) | out_r;
 }
 
 static void blit_alpha_scaled(Framebuffer* fb, int dst_x, int dst_y, const uint8_t* src, int src_w, int src_h, int src_stride, ColorRGBA color, float scale) {
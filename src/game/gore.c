@@ -5,6 +5,9 @@
 #include "game/world.h"
 #include "game/collision.h"
 #include "render/camera.h"
+#include "render/compositor.h"
+#include "render/depth_pyramid.h"
+#include "render/floor_decals.h"
 #include "render/lighting.h"
 #include "render/raycast.h"
 #include "platform/time.h"
@@ -95,8 +98,11 @@ void gore_reset(GoreSystem* self) {
         self->chunk_alive = 0;
         self->stats_spawned = 0u;
         self->stats_dropped = 0u;
-        self->stats_drawn_samples = 0u;
-        self->stats_pixels_written = 0u;
+        self->stats_early_rejected = 0u;
+        self->stats_early_accepted = 0u;
+        self->stats_chunks_settled = 0u;
+        self->stats_baked = 0u;
+        self->stats_bake_failed = 0u;
 }
 
 void gore_begin_frame(GoreSystem* self) {
@@ -105,8 +111,11 @@ void gore_begin_frame(GoreSystem* self) {
         }
         self->stats_spawned = 0u;
         self->stats_dropped = 0u;
-        self->stats_drawn_samples = 0u;
-        self->stats_pixels_written = 0u;
+        self->stats_early_rejected = 0u;
+        self->stats_early_accepted = 0u;
+        self->stats_chunks_settled = 0u;
+        self->stats_baked = 0u;
+        self->stats_bake_failed = 0u;
 }
 
 static const float GORE_PALETTE[4][3] = {
@@ -148,6 +157,9 @@ static inline float max3(float a, float b) {
         return a > b ? a : b;
 }
 
+// Downward acceleration of flying chunks (world units / s^2).
+static const float GORE_CHUNK_GRAVITY = 18.0f;
+
 static bool gore_stamp_from_chunk(GoreSystem* self, const GoreChunk* c) {
         if (!self || !c) {
                 return false;
@@ -241,7 +253,125 @@ bool gore_spawn_chunk(
         return true;
 }
 
-void gore_tick(GoreSystem* self, const World* world, uint32_t dt_ms) {
+// Time (s) for a chunk at height z rising at vz to come down to `floor_z`; < 0 if never.
+static float gore_chunk_fall_time(float z, float vz, float radius, float floor_z) {
+        float h = z - (floor_z + radius);
+        if (h <= 0.0f) {
+                return 0.0f;
+        }
+        float disc = vz * vz + 2.0f * GORE_CHUNK_GRAVITY * h;
+        if (disc < 0.0f) {
+                return -1.0f;
+        }
+        return (vz + sqrtf(disc)) / GORE_CHUNK_GRAVITY;
+}
+
+bool gore_settle_chunk(
+        GoreSystem* self,
+        const World* world,
+        float x,
+        float y,
+        float z,
+        float vx,
+        float vy,
+        float vz,
+        float radius,
+        float r,
+        float g,
+        float b,
+        uint32_t life_ms,
+        int last_valid_sector) {
+        if (!self || !self->initialized || !self->items || !world || radius <= 0.0f) {
+                return false;
+        }
+        int sec = world_find_sector_at_point_stable(world, x, y, last_valid_sector);
+        if ((unsigned)sec >= (unsigned)world->sector_count) {
+                return false;
+        }
+        const Sector* s = &world->sectors[sec];
+        // Chunks that reach the ceiling die there.
+        float apex = vz > 0.0f ? z + vz * vz / (2.0f * GORE_CHUNK_GRAVITY) : z;
+        if (apex + radius >= s->ceil_z) {
+                return false;
+        }
+        float t = gore_chunk_fall_time(z, vz, radius, s->floor_z);
+        if (t < 0.0f) {
+                return false;
+        }
+        // Chunks that hit a wall on the way die there (no wall decals, as in gore_tick).
+        CollisionMoveResult mr = collision_move_circle(world, radius, x, y, x + vx * t, y + vy * t);
+        if (mr.collided) {
+                return false;
+        }
+        // Landing over a different floor height: solve once more against that floor.
+        int land = world_find_sector_at_point_stable(world, mr.out_x, mr.out_y, sec);
+        if ((unsigned)land >= (unsigned)world->sector_count) {
+                return false;
+        }
+        float floor_z = world->sectors[land].floor_z;
+        if (land != sec && floor_z != s->floor_z) {
+                t = gore_chunk_fall_time(z, vz, radius, floor_z);
+                if (t < 0.0f) {
+                        return false;
+                }
+        }
+        uint32_t life = life_ms > 0u ? life_ms : 2800u;
+        if (t * 1000.0f >= (float)life) {
+                return false;
+        }
+
+        GoreChunk c;
+        memset(&c, 0, sizeof(c));
+        c.x = x + vx * t;
+        c.y = y + vy * t;
+        c.z = floor_z;
+        c.radius = radius;
+        gore_snap_to_palette(clampf3(r, 0.0f, 1.0f), clampf3(g, 0.0f, 1.0f), clampf3(b, 0.0f, 1.0f), &c.r, &c.g, &c.b);
+        c.age_ms = (uint32_t)(t * 1000.0f);
+        self->stats_chunks_settled++;
+        return gore_stamp_from_chunk(self, &c);
+}
+
+static inline uint32_t pack_abgr_u8(uint8_t a, uint8_t b, uint8_t g, uint8_t r) {
+        return ((uint32_t)a << 24u) | ((uint32_t)b << 16u) | ((uint32_t)g << 8u) | (uint32_t)r;
+}
+
+// A stamp rests on a floor when it sits within this distance of the floor's height.
+static const float GORE_BAKE_FLOOR_EPS = 0.01f;
+
+typedef enum GoreBakeResult {
+        GORE_BAKE_OK = 0,
+        GORE_BAKE_OFF_FLOOR,   // not resting at its sector's floor height
+        GORE_BAKE_ATLAS_FULL,  // the decal layer could not take every droplet
+} GoreBakeResult;
+
+// Writes every droplet of a stamp into the floor decal layer of the sector under it.
+// Droplets hanging over a step into a sector with a different floor height are dropped,
+// matching how they would be clipped by that floor.
+static GoreBakeResult gore_bake_stamp(const GoreStamp* g, const World* world, FloorDecals* decals) {
+        int sector = world_find_sector_at_point(world, g->x, g->y);
+        if (sector < 0 || fabsf(world->sectors[sector].floor_z - g->z) > GORE_BAKE_FLOOR_EPS) {
+                return GORE_BAKE_OFF_FLOOR;
+        }
+        for (int si = 0; si < g->sample_count; si++) {
+                const GoreSample* s = &g->samples[si];
+                float wx = g->x + s->off_x;
+                float wy = g->y + s->off_y;
+                int sec = world_sector_contains_point(world, sector, wx, wy) ? sector : world_find_sector_at_point(world, wx, wy);
+                if (sec < 0 || fabsf(world->sectors[sec].floor_z - g->z) > GORE_BAKE_FLOOR_EPS) {
+                        continue;
+                }
+                uint8_t r8 = (uint8_t)lroundf(clampf3(s->r, 0.0f, 1.0f) * 255.0f);
+                uint8_t g8 = (uint8_t)lroundf(clampf3(s->g, 0.0f, 1.0f) * 255.0f);
+                uint8_t b8 = (uint8_t)lroundf(clampf3(s->b, 0.0f, 1.0f) * 255.0f);
+                if (!floor_decals_splat(decals, world, sec, wx, wy, s->radius, pack_abgr_u8(255u, b8, g8, r8))) {
+                        return GORE_BAKE_ATLAS_FULL;
+                }
+        }
+        return GORE_BAKE_OK;
+}
+
+void gore_tick(GoreSystem* self, const World* world, FloorDecals* decals, uint32_t dt_ms) {
         if (!self || !self->initialized || !self->items || dt_ms == 0u) {
                 return;
         }
@@ -256,6 +386,24 @@ void gore_tick(GoreSystem* self, const World* world, uint32_t dt_ms) {
                         g->alive = false;
                         continue;
                 }
+                if (g->life_ms == 0u && !g->bake_failed && decals && world) {
+                        GoreBakeResult bake = gore_bake_stamp(g, world, decals);
+                        if (bake == GORE_BAKE_OK) {
+                                g->alive = false;
+                                self->stats_baked++;
+                                continue;
+                        }
+                        if (bake == GORE_BAKE_ATLAS_FULL) {
+                                self->stats_bake_failed++;
+                                if (!self->bake_fail_logged) {
+                                        self->bake_fail_logged = true;
+                                        log_warn_s("gore", "floor decal atlas full (%d pages, %d sectors evicted); stamp at (%.2f, %.2f) stays live",
+                                                decals->page_count, (int)decals->evictions, (double)g->x, (double)g->y);
+                                }
+                        }
+                        // Keep drawing it live; a partial bake underneath is harmless.
+                        g->bake_failed = true;
+                }
                 alive++;
         }
         self->alive_count = alive;
@@ -264,7 +412,7 @@ void gore_tick(GoreSystem* self, const World* world, uint32_t dt_ms) {
                 return;
         }
 
-        const float gravity = 18.0f;
+        const float gravity = GORE_CHUNK_GRAVITY;
         float dt = (float)dt_ms / 1000.0f;
         int chunk_alive = 0;
         for (int i = 0; i < self->chunk_capacity; i++) {
@@ -368,12 +516,6 @@ bool gore_spawn(GoreSystem* self, const GoreSpawnParams* params) {
         return true;
 }
 
-static inline uint32_t pack_abgr_u8(uint8_t a, uint8_t b, uint8_t g, uint8_t r) {
-        return ((uint32_t)a << 24u) | ((uint32_t)b << 16u) | ((uint32_t)g << 8u) | (uint32_t)r;
-}
-
-// Gore draws are opaque; no blending needed.
-
 static float camera_world_z_for_sector_approx3(const World* world, int sector, float z_offset) {
         const float eye_height = 1.5f;
         const float headroom = 0.1f;
@@ -392,20 +534,115 @@ static float camera_world_z_for_sector_approx3(const World* world, int sector, f
         return z;
 }
 
-void gore_draw(
-        GoreSystem* self,
-        Framebuffer* fb,
-        const World* world,
+// Projects an opaque square of world `radius` at (x, y, z) into a SOLID compositor item
+// (depth, rects and layer); returns false when it is behind the camera or off screen.
+static bool gore_project_square(
+        CompositeItem* out,
+        const Framebuffer* fb,
         const Camera* cam,
-        int start_sector,
-        const float* wall_depth,
-        const float* depth_pixels) {
-        if (!self || !self->initialized || !self->items || !fb || !fb->pixels || !world || !cam) {
-                return;
+        float fx,
+        float fy,
+        float rx,
+        float ry,
+        float focal,
+        float half_w,
+        float half_h,
+        float cam_z_world,
+        float x,
+        float y,
+        float z,
+        float radius) {
+        float dx = x - cam->x;
+        float dy = y - cam->y;
+        float depth = dx * fx + dy * fy;
+        if (depth <= 0.05f) {
+                return false;
+        }
+        float side = dx * rx + dy * ry;
+
+        float proj_depth = depth;
+        const float min_proj_depth = 0.25f;
+        if (proj_depth < min_proj_depth) {
+                proj_depth = min_proj_depth;
+        }
+        float scale = focal / proj_depth;
+        int radius_px = (int)(radius * scale + 0.5f);
+        if (radius_px < 1) {
+                radius_px = 1;
+        }
+        int max_dim = fb->width > fb->height ? fb->width : fb->height;
+        if (radius_px > max_dim) {
+                radius_px = max_dim;
+        }
+
+        float x_center = half_w + side * scale;
+        float y_center = half_h + (cam_z_world - z) * scale;
+
+        int x0 = (int)(x_center - (float)radius_px);
+        int x1 = (int)(x_center + (float)radius_px + 1);
+        int y0 = (int)(y_center - (float)radius_px);
+        int y1 = (int)(y_center + (float)radius_px + 1);
+
+        int clip_x0 = x0 < 0 ? 0 : x0;
+        int clip_x1 = x1 > fb->width ? fb->width : x1;
+        int clip_y0 = y0 < 0 ? 0 : y0;
+        int clip_y1 = y1 > fb->height ? fb->height : y1;
+        if (clip_x0 >= clip_x1 || clip_y0 >= clip_y1) {
+                return false;
         }
-        if (!wall_depth && !depth_pixels) {
+
+        memset(out, 0, sizeof(*out));
+        out->depth = depth;
+        out->x0 = (int16_t)x0;
+        out->y0 = (int16_t)y0;
+        out->w = (int16_t)(x1 - x0);
+        out->h = (int16_t)(y1 - y0);
+        out->clip_x0 = (int16_t)clip_x0;
+        out->clip_y0 = (int16_t)clip_y0;
+        out->clip_x1 = (int16_t)clip_x1;
+        out->clip_y1 = (int16_t)clip_y1;
+        out->shape = COMPOSITE_SHAPE_SOLID;
+        out->layer = COMPOSITE_LAYER_GORE;
+        return true;
+}
+
+// Opaque color of a gore square at (x, y), lit like the world around it.
+static uint32_t gore_lit_color(
+        const World* world,
+        int start_sector,
+        const Camera* cam,
+        const PointLight* vis_lights,
+        int vis_count,
+        float x,
+        float y,
+        float r,
+        float g,
+        float b) {
+        int sec = world_find_sector_at_point_stable(world, x, y, start_sector);
+        float sector_intensity = 1.0f;
+        LightColor sector_tint = light_color_white();
+        if ((unsigned)sec < (unsigned)world->sector_count) {
+                sector_intensity = world->sectors[sec].light;
+                sector_tint = world->sectors[sec].light_color;
+        }
+
+        float dx = x - cam->x;
+        float dy = y - cam->y;
+        float dist = sqrtf(dx * dx + dy * dy);
+        uint8_t a = 255u;
+        uint8_t r8 = (uint8_t)lroundf(clampf3(r, 0.0f, 1.0f) * 255.0f);
+        uint8_t g8 = (uint8_t)lroundf(clampf3(g, 0.0f, 1.0f) * 255.0f);
+        uint8_t b8 = (uint8_t)lroundf(clampf3(b, 0.0f, 1.0f) * 255.0f);
+        uint32_t px = pack_abgr_u8(a, b8, g8, r8);
+        return lighting_apply(px, dist, sector_intensity, sector_tint, vis_lights, vis_count, x, y);
+}
+
+void gore_submit(GoreSystem* self, Compositor* comp, const World* world, const Camera* cam, int start_sector) {
+        if (!self || !self->initialized || !self->items || !comp || !comp->ready || !world || !cam) {
                 return;
         }
+        const Framebuffer* fb = comp->fb;
+        const DepthPyramid* depth_pyramid = comp->depth_pyramid;
 
         float cam_rad = deg_to_rad3(cam->angle_deg);
         float fx = cosf(cam_rad);
@@ -425,95 +662,40 @@ void gore_draw(
         PointLight vis_lights[96];
         int vis_count = raycast_build_visible_lights(vis_lights, (int)MORTUM_ARRAY_COUNT(vis_lights), world, cam, (float)platform_time_seconds());
 
-        uint32_t drawn_samples = 0u;
-        uint32_t pixels_written = 0u;
+        uint32_t early_rejected = 0u;
+        uint32_t early_accepted = 0u;
 
         // Depth bias (world units along the ray depth axis) so stamps don't z-fight with the surface they sit on.
         // Stamps are biased slightly closer than the surface.
         const float stamp_depth_bias = 0.02f;
         const float chunk_depth_bias = 0.0f;
 
-        // Draw live airborne chunks as opaque squares so their ballistic motion is visible.
+        // Live airborne chunks are opaque squares so their ballistic motion is visible.
         for (int ci = 0; ci < self->chunk_capacity; ci++) {
                 const GoreChunk* c = &self->chunks[ci];
                 if (!c->alive) {
                         continue;
                 }
-                float dx = c->x - cam->x;
-                float dy = c->y - cam->y;
-                float depth = dx * fx + dy * fy;
-                if (depth <= 0.05f) {
+                CompositeItem item;
+                if (!gore_project_square(&item, fb, cam, fx, fy, rx, ry, focal, half_w, half_h, cam_z_world, c->x, c->y, c->z, c->radius)) {
                         continue;
                 }
-                float side = dx * rx + dy * ry;
-
-                float proj_depth = depth;
-                const float min_proj_depth = 0.25f;
-                if (proj_depth < min_proj_depth) {
-                        proj_depth = min_proj_depth;
-                }
-                float scale = focal / proj_depth;
-                int radius_px = (int)(c->radius * scale + 0.5f);
-                if (radius_px < 1) {
-                        radius_px = 1;
-                }
-                int max_dim = fb->width > fb->height ? fb->width : fb->height;
-                if (radius_px > max_dim) {
-                        radius_px = max_dim;
-                }
-
-                float x_center = half_w + side * scale;
-                float y_center = half_h + (cam_z_world - c->z) * scale;
-
-                int x0 = (int)(x_center - (float)radius_px);
-                int x1 = (int)(x_center + (float)radius_px + 1);
-                int y0 = (int)(y_center - (float)radius_px);
-                int y1 = (int)(y_center + (float)radius_px + 1);
-
-                int clip_x0 = x0 < 0 ? 0 : x0;
-                int clip_x1 = x1 > fb->width ? fb->width : x1;
-                int clip_y0 = y0 < 0 ? 0 : y0;
-                int clip_y1 = y1 > fb->height ? fb->height : y1;
-                if (clip_x0 >= clip_x1 || clip_y0 >= clip_y1) {
+                DepthPyramidResult occ = depth_pyramid_test_rect(depth_pyramid, item.clip_x0, item.clip_y0, item.clip_x1, item.clip_y1, item.depth - chunk_depth_bias);
+                if (occ == DEPTH_PYRAMID_HIDDEN) {
+                        early_rejected++;
                         continue;
                 }
-
-                int sec = world_find_sector_at_point_stable(world, c->x, c->y, start_sector);
-                float sector_intensity = 1.0f;
-                LightColor sector_tint = light_color_white();
-                if ((unsigned)sec < (unsigned)world->sector_count) {
-                        sector_intensity = world->sectors[sec].light;
-                        sector_tint = world->sectors[sec].light_color;
-                }
-
-                float dist = sqrtf(dx * dx + dy * dy);
-                uint8_t a = 255u;
-                uint8_t r = (uint8_t)lroundf(clampf3(c->r, 0.0f, 1.0f) * 255.0f);
-                uint8_t gch = (uint8_t)lroundf(clampf3(c->g, 0.0f, 1.0f) * 255.0f);
-                uint8_t b = (uint8_t)lroundf(clampf3(c->b, 0.0f, 1.0f) * 255.0f);
-                uint32_t src_px = pack_abgr_u8(a, b, gch, r);
-                src_px = lighting_apply(src_px, dist, sector_intensity, sector_tint, vis_lights, vis_count, c->x, c->y);
-
-                bool any = false;
-                for (int x = clip_x0; x < clip_x1; x++) {
-                        if (wall_depth && depth >= (wall_depth[x] + chunk_depth_bias)) {
-                                continue;
-                        }
-                        for (int y = clip_y0; y < clip_y1; y++) {
-                                if (depth_pixels) {
-                                        float world_depth = depth_pixels[y * fb->width + x];
-                                        if (depth >= (world_depth + chunk_depth_bias)) {
-                                                continue;
-                                        }
-                                }
-                                fb->pixels[y * fb->width + x] = src_px;
-                                pixels_written++;
-                                any = true;
-                        }
+                if (occ == DEPTH_PYRAMID_VISIBLE) {
+                        early_accepted++;
                 }
-                if (any) {
-                        drawn_samples++;
+                CompositeItem* it = compositor_push(comp);
+                if (!it) {
+                        continue;
                 }
+                item.depth_bias = chunk_depth_bias;
+                item.test_pixels = occ != DEPTH_PYRAMID_VISIBLE;
+                item.color = gore_lit_color(world, start_sector, cam, vis_lights, vis_count, c->x, c->y, c->r, c->g, c->b);
+                *it = item;
         }
 
         for (int i = 0; i < self->capacity; i++) {
@@ -525,85 +707,28 @@ void gore_draw(
                         const GoreSample* s = &g->samples[si];
                         float wx = g->x + s->off_x;
                         float wy = g->y + s->off_y;
-                        float wz = g->z;
-
-                        float dx = wx - cam->x;
-                        float dy = wy - cam->y;
-                        float depth = dx * fx + dy * fy;
-                        if (depth <= 0.05f) {
+                        CompositeItem item;
+                        if (!gore_project_square(&item, fb, cam, fx, fy, rx, ry, focal, half_w, half_h, cam_z_world, wx, wy, g->z, s->radius)) {
                                 continue;
                         }
-                        float side = dx * rx + dy * ry;
-
-                        float proj_depth = depth;
-                        const float min_proj_depth = 0.25f;
-                        if (proj_depth < min_proj_depth) {
-                                proj_depth = min_proj_depth;
-                        }
-                        float scale = focal / proj_depth;
-                        int radius_px = (int)(s->radius * scale + 0.5f);
-                        if (radius_px < 1) {
-                                radius_px = 1;
-                        }
-                        int max_dim = fb->width > fb->height ? fb->width : fb->height;
-                        if (radius_px > max_dim) {
-                                radius_px = max_dim;
-                        }
-
-                        float x_center = half_w + side * scale;
-                        float y_center = half_h + (cam_z_world - wz) * scale;
-
-                        int x0 = (int)(x_center - (float)radius_px);
-                        int x1 = (int)(x_center + (float)radius_px + 1);
-                        int y0 = (int)(y_center - (float)radius_px);
-                        int y1 = (int)(y_center + (float)radius_px + 1);
-
-                        int clip_x0 = x0 < 0 ? 0 : x0;
-                        int clip_x1 = x1 > fb->width ? fb->width : x1;
-                        int clip_y0 = y0 < 0 ? 0 : y0;
-                        int clip_y1 = y1 > fb->height ? fb->height : y1;
-                        if (clip_x0 >= clip_x1 || clip_y0 >= clip_y1) {
+                        DepthPyramidResult occ = depth_pyramid_test_rect(depth_pyramid, item.clip_x0, item.clip_y0, item.clip_x1, item.clip_y1, item.depth - stamp_depth_bias);
+                        if (occ == DEPTH_PYRAMID_HIDDEN) {
+                                early_rejected++;
                                 continue;
                         }
-
-                        int sec = world_find_sector_at_point_stable(world, wx, wy, start_sector);
-                        float sector_intensity = 1.0f;
-                        LightColor sector_tint = light_color_white();
-                        if ((unsigned)sec < (unsigned)world->sector_count) {
-                                sector_intensity = world->sectors[sec].light;
-                                sector_tint = world->sectors[sec].light_color;
+                        if (occ == DEPTH_PYRAMID_VISIBLE) {
+                                early_accepted++;
                         }
-
-                        float dist = sqrtf(dx * dx + dy * dy);
-                        uint8_t a = 255u;
-                        uint8_t r = (uint8_t)lroundf(clampf3(s->r, 0.0f, 1.0f) * 255.0f);
-                        uint8_t gch = (uint8_t)lroundf(clampf3(s->g, 0.0f, 1.0f) * 255.0f);
-                        uint8_t b = (uint8_t)lroundf(clampf3(s->b, 0.0f, 1.0f) * 255.0f);
-                        uint32_t src_px = pack_abgr_u8(a, b, gch, r);
-                        src_px = lighting_apply(src_px, dist, sector_intensity, sector_tint, vis_lights, vis_count, wx, wy);
-
-                        bool any = false;
-                        for (int x = clip_x0; x < clip_x1; x++) {
-                                if (wall_depth && depth >= (wall_depth[x] + stamp_depth_bias)) {
-                                        continue;
-                                }
-                                for (int y = clip_y0; y < clip_y1; y++) {
-                                        if (depth_pixels) {
-                                                float world_depth = depth_pixels[y * fb->width + x];
-                                                if (depth >= (world_depth + stamp_depth_bias)) {
-                                                        continue;
-                                                }
-                                        }
-                                        fb->pixels[y * fb->width + x] = src_px;
-                                        pixels_written++;
-                                        any = true;
-                                }
-                        }
-                        if (any) {
-                                drawn_samples++;
+                        CompositeItem* it = compositor_push(comp);
+                        if (!it) {
+                                continue;
                         }
+                        item.depth_bias = stamp_depth_bias;
+                        item.test_pixels = occ != DEPTH_PYRAMID_VISIBLE;
+                        item.color = gore_lit_color(world, start_sector, cam, vis_lights, vis_count, wx, wy, s->r, s->g, s->b);
+                        *it = item;
                 }
         }
-        self->stats_drawn_samples = drawn_samples;
-        self->stats_pixels_written = pixels_written;
+        self->stats_early_rejected = early_rejected;
+        self->stats_early_accepted = early_accepted;
 }
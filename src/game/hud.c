@@ -224,6 +224,7 @@ bool hud_system_reload(HudSystem* hud, const CoreConfig* cfg, const AssetPaths*
 		return false;
 	}
 	// Swap in the new state.
+	next.version = hud->version + 1u;
 	hud_system_shutdown(hud);
 	*hud = next;
 	return true;
@@ -369,6 +370,34 @@ static void draw_widget_contents(
 	}
 }
 
+uint32_t hud_version(HudSystem* hud, const Player* player) {
+	if (!hud) {
+		return 0u;
+	}
+	HudView v;
+	memset(&v, 0, sizeof(v));
+	if (player) {
+		v.health = player->health;
+		v.health_max = player->health_max;
+		v.mortum_pct = player->mortum_pct;
+		v.keys = count_bits_u32((unsigned int)player->keys);
+		v.weapon = (int)player->weapon_equipped;
+		const WeaponDef* wdef = weapon_def_get(player->weapon_equipped);
+		if (wdef) {
+			v.ammo = ammo_get(&player->ammo, wdef->ammo_type);
+			v.ammo_max = ammo_get_max(&player->ammo, wdef->ammo_type);
+		}
+		v.undead_active = player->undead_active;
+		v.undead_shards_collected = player->undead_shards_collected;
+		v.undead_shards_required = player->undead_shards_required;
+	}
+	if (memcmp(&v, &hud->view, sizeof(v)) != 0) {
+		hud->view = v;
+		hud->version++;
+	}
+	return hud->version;
+}
+
 void hud_draw(HudSystem* hud, Framebuffer* fb, const Player* player, const GameState* state, int fps, TextureRegistry* texreg, const AssetPaths* paths) {
 	(void)fps;
 	if (!hud || !hud->loaded || !hud->font_loaded || !fb) {
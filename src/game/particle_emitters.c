@@ -27,16 +27,6 @@ static inline uint32_t hash_u32(uint32_t x) {
 	return x;
 }
 
-static float rand01(uint32_t seed) {
-	uint32_t x = hash_u32(seed);
-	// 24-bit mantissa.
-	return (float)((x >> 8u) & 0x00FFFFFFu) / 16777215.0f;
-}
-
-static float rand_signed(uint32_t seed) {
-	return rand01(seed) * 2.0f - 1.0f;
-}
-
 static void def_sanitize(ParticleEmitterDef* d) {
 	if (!d) {
 		return;
@@ -93,7 +83,9 @@ void particle_emitters_init(ParticleEmitters* self) {
 	self->alive_count = 0;
 	self->stats_emitters_updated = 0u;
 	self->stats_emitters_gated = 0u;
+	self->stats_emitters_offscreen = 0u;
 	self->stats_particles_spawn_attempted = 0u;
+	self->stats_particles_fast_forwarded = 0u;
 	self->free_head = 0;
 	for (uint16_t i = 0; i < PARTICLE_EMITTER_MAX; i++) {
 		self->free_next[i] = (uint16_t)(i + 1u);
@@ -111,7 +103,9 @@ void particle_emitters_begin_frame(ParticleEmitters* self) {
 	}
 	self->stats_emitters_updated = 0u;
 	self->stats_emitters_gated = 0u;
+	self->stats_emitters_offscreen = 0u;
 	self->stats_particles_spawn_attempted = 0u;
+	self->stats_particles_fast_forwarded = 0u;
 }
 
 void particle_emitters_shutdown(ParticleEmitters* self) {
@@ -151,11 +145,14 @@ ParticleEmitterId particle_emitter_create(
 	self->y[idx] = y;
 	self->z[idx] = z;
 	self->emit_accum_ms[idx] = 0u;
+	self->gated_ms[idx] = 0u;
+	self->moved_while_gated[idx] = false;
 	self->spawn_counter[idx] = 0u;
 	self->sector[idx] = -1;
 	self->last_valid_sector[idx] = -1;
 	self->def[idx] = *def;
 	def_sanitize(&self->def[idx]);
+	self->template_epoch[idx] = 0u;
 
 	if (world) {
 		int s = world_find_sector_at_point(world, x, y);
@@ -194,6 +191,9 @@ void particle_emitter_set_pos(
 		return;
 	}
 	uint16_t idx = id.index;
+	if (self->gated_ms[idx] > 0u && (self->x[idx] != x || self->y[idx] != y || self->z[idx] != z)) {
+		self->moved_while_gated[idx] = true;
+	}
 	self->x[idx] = x;
 	self->y[idx] = y;
 	self->z[idx] = z;
@@ -205,17 +205,22 @@ void particle_emitter_set_pos(
 }
 
 static bool emitter_should_emit(
-	const ParticleEmitters* self,
+	ParticleEmitters* self,
 	const World* world,
+	const SectorVisibility* vis,
 	uint16_t idx,
 	float player_x,
 	float player_y,
 	int player_sector) {
-	(void)self;
 	if (!world) {
 		return false;
 	}
 	int es = self->sector[idx];
+	// Sectors the renderer did not reach are skipped without a line-of-sight test.
+	if (!sector_visibility_contains(vis, es)) {
+		self->stats_emitters_offscreen++;
+		return false;
+	}
 	if (es >= 0 && es == player_sector) {
 		return true;
 	}
@@ -223,64 +228,93 @@ static bool emitter_should_emit(
 	return collision_line_of_sight(world, self->x[idx], self->y[idx], player_x, player_y);
 }
 
-static void spawn_particle_from_emitter(Particles* particles, const ParticleEmitters* self, uint16_t idx) {
-	const ParticleEmitterDef* d = &self->def[idx];
-	Particle p;
-	memset(&p, 0, sizeof(p));
-	p.alive = true;
-	p.life_ms = (uint32_t)d->particle_life_ms;
-	p.age_ms = 0u;
-	p.origin_x = self->x[idx];
-	p.origin_y = self->y[idx];
-	p.origin_z = self->z[idx];
-	p.has_image = (d->image[0] != '\0');
-	p.shape = d->shape;
-	if (p.has_image) {
-		strncpy(p.image, d->image, sizeof(p.image) - 1);
-		p.image[sizeof(p.image) - 1] = '\0';
+static void template_from_def(const ParticleEmitterDef* d, ParticleTemplate* t) {
+	memset(t, 0, sizeof(*t));
+	t->life_ms = (uint32_t)d->particle_life_ms;
+	t->has_image = (d->image[0] != '\0');
+	t->shape = d->shape;
+	if (t->has_image) {
+		strncpy(t->image, d->image, sizeof(t->image) - 1);
+		t->image[sizeof(t->image) - 1] = '\0';
 	}
 
-	p.start.opacity = d->start.opacity;
-	p.start.size = d->start.size;
-	p.start.r = d->start.color.r;
-	p.start.g = d->start.color.g;
-	p.start.b = d->start.color.b;
-	p.start.color_blend_opacity = d->start.color.opacity;
-	p.start.off_x = d->start.offset.x;
-	p.start.off_y = d->start.offset.y;
-	p.start.off_z = d->start.offset.z;
+	t->start.opacity = d->start.opacity;
+	t->start.size = d->start.size;
+	t->start.r = d->start.color.r;
+	t->start.g = d->start.color.g;
+	t->start.b = d->start.color.b;
+	t->start.color_blend_opacity = d->start.color.opacity;
+	t->start.off_x = d->start.offset.x;
+	t->start.off_y = d->start.offset.y;
+	t->start.off_z = d->start.offset.z;
 
-	p.end.opacity = d->end.opacity;
-	p.end.size = d->end.size;
-	p.end.r = d->end.color.r;
-	p.end.g = d->end.color.g;
-	p.end.b = d->end.color.b;
-	p.end.color_blend_opacity = d->end.color.opacity;
-	p.end.off_x = d->end.offset.x;
-	p.end.off_y = d->end.offset.y;
-	p.end.off_z = d->end.offset.z;
+	t->end.opacity = d->end.opacity;
+	t->end.size = d->end.size;
+	t->end.r = d->end.color.r;
+	t->end.g = d->end.color.g;
+	t->end.b = d->end.color.b;
+	t->end.color_blend_opacity = d->end.color.opacity;
+	t->end.off_x = d->end.offset.x;
+	t->end.off_y = d->end.offset.y;
+	t->end.off_z = d->end.offset.z;
 
-	p.rotate_enabled = d->rotate.enabled;
-	p.rot_deg = 0.0f;
-	p.rot_step_deg = d->rotate.tick.deg;
-	p.rot_step_ms = (uint32_t)d->rotate.tick.time_ms;
-	p.rot_accum_ms = 0u;
+	t->offset_jitter = d->offset_jitter;
+	t->rotate_enabled = d->rotate.enabled;
+	t->rot_step_deg = d->rotate.tick.deg;
+	t->rot_step_ms = (uint32_t)d->rotate.tick.time_ms;
+}
 
-	// Spawn-time offset jitter.
-	float j = d->offset_jitter;
-	if (j > 0.0f) {
-		uint32_t seed0 = hash_u32((uint32_t)idx ^ (self->spawn_counter[idx] * 0x9E3779B9u));
-		p.jitter_start_x = rand_signed(seed0 ^ 0xA511E9B3u) * j;
-		p.jitter_start_y = rand_signed(seed0 ^ 0x94D049BBu) * j;
-		p.jitter_start_z = rand_signed(seed0 ^ 0xD1B54A35u) * j;
-		p.jitter_end_x = rand_signed(seed0 ^ 0xC2B2AE3Du) * j;
-		p.jitter_end_y = rand_signed(seed0 ^ 0x165667B1u) * j;
-		p.jitter_end_z = rand_signed(seed0 ^ 0x27D4EB2Fu) * j;
+static void spawn_particle_from_emitter(Particles* particles, ParticleEmitters* self, uint16_t idx, uint32_t age_ms) {
+	// Emitters sharing a def share one interned template; the id is cached until the
+	// pool's template table is cleared.
+	if (self->template_epoch[idx] != particles->template_epoch) {
+		ParticleTemplate tpl;
+		template_from_def(&self->def[idx], &tpl);
+		int id = particles_template_intern(particles, &tpl);
+		if (id < 0) {
+			particles->stats_dropped++;
+			return;
+		}
+		self->template_id[idx] = (uint16_t)id;
+		self->template_epoch[idx] = particles->template_epoch;
 	}
+	Particle p;
+	memset(&p, 0, sizeof(p));
+	p.life_ms = (uint32_t)self->def[idx].particle_life_ms;
+	p.age_ms = age_ms;
+	p.origin_x = self->x[idx];
+	p.origin_y = self->y[idx];
+	p.origin_z = self->z[idx];
+	p.template_id = self->template_id[idx];
+	// Spawn-time offset jitter is derived from this seed when the particle is drawn.
+	p.jitter_seed = hash_u32((uint32_t)idx ^ (self->spawn_counter[idx] * 0x9E3779B9u));
 
 	particles_spawn(particles, &p);
 }
 
+// Backfills an emitter that was gated for `gated_ms`: spawns the particles it would
+// still have alive had it kept emitting every interval, aged by when each would have
+// been emitted, youngest first. Emitters that moved meanwhile only resume their cadence,
+// since their past positions are unknown.
+static void emitter_fast_forward(Particles* particles, ParticleEmitters* self, uint16_t idx) {
+	const ParticleEmitterDef* d = &self->def[idx];
+	uint32_t interval = (uint32_t)d->emit_interval_ms;
+	uint32_t life = (uint32_t)d->particle_life_ms;
+	uint32_t total = self->emit_accum_ms[idx] + self->gated_ms[idx];
+	uint32_t emitted = total / interval;
+	self->emit_accum_ms[idx] = total % interval;
+	if (self->moved_while_gated[idx]) {
+		return;
+	}
+	uint32_t age = self->emit_accum_ms[idx];
+	for (uint32_t k = 0u; k < emitted && k < PARTICLE_EMITTER_FAST_FORWARD_MAX && age < life; k++) {
+		spawn_particle_from_emitter(particles, self, idx, age);
+		self->spawn_counter[idx]++;
+		self->stats_particles_fast_forwarded++;
+		age += interval;
+	}
+}
+
 void particle_emitters_update(
 	ParticleEmitters* self,
 	const World* world,
@@ -288,6 +322,7 @@ void particle_emitters_update(
 	float player_x,
 	float player_y,
 	int player_sector,
+	const SectorVisibility* vis,
 	uint32_t dt_ms) {
 	if (!self || !self->initialized || !world || !particles || !particles->initialized) {
 		return;
@@ -300,21 +335,29 @@ void particle_emitters_update(
 			continue;
 		}
 		self->stats_emitters_updated++;
-		bool ok = emitter_should_emit(self, world, i, player_x, player_y, player_sector);
+		const ParticleEmitterDef* d = &self->def[i];
+		uint32_t interval = (uint32_t)(d->emit_interval_ms > 0 ? d->emit_interval_ms : 1);
+		bool ok = emitter_should_emit(self, world, vis, i, player_x, player_y, player_sector);
 		if (!ok) {
 			self->stats_emitters_gated++;
-			// No backlog; when visibility returns, resume regular cadence.
-			self->emit_accum_ms[i] = 0u;
+			// Not simulated; only the time is kept, to fast-forward when visible again.
+			// Past one lifetime (plus the phase) more time changes nothing.
+			uint32_t cap = (uint32_t)d->particle_life_ms + interval;
+			uint32_t gated = self->gated_ms[i] + dt_ms;
+			self->gated_ms[i] = gated < cap ? gated : cap;
 			continue;
 		}
+		if (self->gated_ms[i] > 0u) {
+			emitter_fast_forward(particles, self, i);
+			self->gated_ms[i] = 0u;
+			self->moved_while_gated[i] = false;
+		}
 
-		const ParticleEmitterDef* d = &self->def[i];
-		uint32_t interval = (uint32_t)(d->emit_interval_ms > 0 ? d->emit_interval_ms : 1);
 		self->emit_accum_ms[i] += dt_ms;
 		uint32_t spawned = 0u;
 		while (self->emit_accum_ms[i] >= interval) {
 			self->emit_accum_ms[i] -= interval;
-			spawn_particle_from_emitter(particles, self, i);
+			spawn_particle_from_emitter(particles, self, i, 0u);
 			self->spawn_counter[i]++;
 			spawned++;
 			self->stats_particles_spawn_attempted++;
@@ -5,7 +5,10 @@
 #include "core/log.h"
 #include "game/world.h"
 #include "render/camera.h"
-#include "render/framebuffer.h"
+#include "render/compositor.h"
+#include "render/depth_pyramid.h"
+#include "render/image_cache.h"
+#include "render/simd.h"
 #include "render/texture.h"
 
 #include <math.h>
@@ -30,27 +33,43 @@ static inline uint32_t pack_abgr_u8(uint8_t a, uint8_t b, uint8_t g, uint8_t r)
 	return ((uint32_t)a << 24u) | ((uint32_t)b << 16u) | ((uint32_t)g << 8u) | (uint32_t)r;
 }
 
-static inline uint32_t blend_abgr8888_over(uint32_t src, uint32_t dst) {
-	uint32_t sa = (src >> 24u) & 0xFFu;
-	if (sa == 0u) {
-		return dst;
-	}
-	if (sa == 255u) {
-		return src;
-	}
-	uint32_t inv = 255u - sa;
-	uint32_t sb = (src >> 16u) & 0xFFu;
-	uint32_t sg = (src >> 8u) & 0xFFu;
-	uint32_t sr = src & 0xFFu;
-	uint32_t da = (dst >> 24u) & 0xFFu;
-	uint32_t db = (dst >> 16u) & 0xFFu;
-	uint32_t dg = (dst >> 8u) & 0xFFu;
-	uint32_t dr = dst & 0xFFu;
-	uint32_t oa = sa + (da * inv + 127u) / 255u;
-	uint32_t ob = (sb * sa + db * inv + 127u) / 255u;
-	uint32_t og = (sg * sa + dg * inv + 127u) / 255u;
-	uint32_t or_ = (sr * sa + dr * inv + 127u) / 255u;
-	return (oa << 24u) | (ob << 16u) | (og << 8u) | or_;
+static inline uint32_t hash_u32(uint32_t x) {
+	// Murmur3 finalizer-like mix (same as particle_emitters.c).
+	x ^= x >> 16u;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15u;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16u;
+	return x;
+}
+
+static float rand_signed(uint32_t seed) {
+	uint32_t x = hash_u32(seed);
+	// 24-bit mantissa.
+	return ((float)((x >> 8u) & 0x00FFFFFFu) / 16777215.0f) * 2.0f - 1.0f;
+}
+
+static uint32_t template_hash_bytes(const ParticleTemplate* tpl) {
+	// FNV-1a over the whole (zero-initialized) struct.
+	const unsigned char* b = (const unsigned char*)tpl;
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < sizeof(*tpl); i++) {
+		h ^= b[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+// Distinct per init/reset across all pools, so a cached id from an old pool at the
+// same address is never mistaken for a current one.
+static uint32_t g_template_epoch = 0u;
+
+static uint32_t next_template_epoch(void) {
+	g_template_epoch++;
+	if (g_template_epoch == 0u) {
+		g_template_epoch = 1u;
+	}
+	return g_template_epoch;
 }
 
 bool particles_init(Particles* self, int capacity) {
@@ -61,11 +80,26 @@ bool particles_init(Particles* self, int capacity) {
 	if (capacity <= 0) {
 		capacity = PARTICLE_MAX_DEFAULT;
 	}
-	self->items = (Particle*)calloc((size_t)capacity, sizeof(Particle));
-	if (!self->items) {
+	size_t n = (size_t)capacity;
+	self->origin_x = (float*)malloc(n * sizeof(float));
+	self->origin_y = (float*)malloc(n * sizeof(float));
+	self->origin_z = (float*)malloc(n * sizeof(float));
+	self->age_ms = (uint32_t*)malloc(n * sizeof(uint32_t));
+	self->life_ms = (uint32_t*)malloc(n * sizeof(uint32_t));
+	self->jitter_seed = (uint32_t*)malloc(n * sizeof(uint32_t));
+	self->template_id = (uint16_t*)malloc(n * sizeof(uint16_t));
+	self->templates = (ParticleTemplate*)calloc(PARTICLE_TEMPLATE_MAX, sizeof(ParticleTemplate));
+	self->template_hash = (uint32_t*)calloc(PARTICLE_TEMPLATE_MAX, sizeof(uint32_t));
+	self->template_tex = (const Texture**)calloc(PARTICLE_TEMPLATE_MAX, sizeof(const Texture*));
+	self->template_tex_valid = (bool*)calloc(PARTICLE_TEMPLATE_MAX, sizeof(bool));
+	if (!self->origin_x || !self->origin_y || !self->origin_z || !self->age_ms || !self->life_ms || !self->jitter_seed ||
+		!self->template_id || !self->templates || !self->template_hash || !self->template_tex ||
+		!self->template_tex_valid) {
+		particles_shutdown(self);
 		return false;
 	}
 	self->capacity = capacity;
+	self->template_epoch = next_template_epoch();
 	self->initialized = true;
 	return true;
 }
@@ -74,7 +108,17 @@ void particles_shutdown(Particles* self) {
 	if (!self) {
 		return;
 	}
-	free(self->items);
+	free(self->origin_x);
+	free(self->origin_y);
+	free(self->origin_z);
+	free(self->age_ms);
+	free(self->life_ms);
+	free(self->jitter_seed);
+	free(self->template_id);
+	free(self->templates);
+	free(self->template_hash);
+	free((void*)self->template_tex);
+	free(self->template_tex_valid);
 	memset(self, 0, sizeof(*self));
 }
 
@@ -82,12 +126,14 @@ void particles_reset(Particles* self) {
 	if (!self || !self->initialized) {
 		return;
 	}
-	memset(self->items, 0, (size_t)self->capacity * sizeof(Particle));
 	self->alive_count = 0;
+	self->template_count = 0;
+	self->template_epoch = next_template_epoch();
 	self->stats_spawned = 0u;
 	self->stats_dropped = 0u;
-	self->stats_drawn_particles = 0u;
-	self->stats_pixels_written = 0u;
+	self->stats_listed = 0u;
+	self->stats_early_rejected = 0u;
+	self->stats_early_accepted = 0u;
 }
 
 void particles_begin_frame(Particles* self) {
@@ -96,46 +142,73 @@ void particles_begin_frame(Particles* self) {
 	}
 	self->stats_spawned = 0u;
 	self->stats_dropped = 0u;
-	self->stats_drawn_particles = 0u;
-	self->stats_pixels_written = 0u;
+	self->stats_listed = 0u;
+	self->stats_early_rejected = 0u;
+	self->stats_early_accepted = 0u;
+}
+
+// Moves the last live particle into slot i.
+static void particles_swap_remove(Particles* self, int i) {
+	int last = --self->alive_count;
+	self->origin_x[i] = self->origin_x[last];
+	self->origin_y[i] = self->origin_y[last];
+	self->origin_z[i] = self->origin_z[last];
+	self->age_ms[i] = self->age_ms[last];
+	self->life_ms[i] = self->life_ms[last];
+	self->jitter_seed[i] = self->jitter_seed[last];
+	self->template_id[i] = self->template_id[last];
 }
 
 void particles_tick(Particles* self, uint32_t dt_ms) {
-	if (!self || !self->initialized || !self->items) {
+	if (!self || !self->initialized || !self->age_ms) {
 		return;
 	}
 	if (dt_ms == 0u) {
 		return;
 	}
-	int alive = 0;
-	for (int i = 0; i < self->capacity; i++) {
-		Particle* p = &self->items[i];
-		if (!p->alive) {
-			continue;
-		}
-		p->age_ms += dt_ms;
-		if (p->life_ms == 0u || p->age_ms >= p->life_ms) {
-			p->alive = false;
-			continue;
+	uint32_t* age = self->age_ms;
+	const uint32_t* life = self->life_ms;
+	const SimdKernels* k = simd_kernels();
+
+	// Advance every age, then swap-remove the expired ones (age >= life, which covers
+	// life == 0). The scan skips runs of live particles a vector at a time; the particle
+	// swapped into a slot is re-checked before moving on.
+	k->add_u32(age, self->alive_count, dt_ms);
+	int i = 0;
+	for (;;) {
+		i += k->find_ge_u32(age + i, life + i, self->alive_count - i);
+		if (i >= self->alive_count) {
+			break;
 		}
-		if (p->rotate_enabled && p->rot_step_ms > 0u && p->rot_step_deg != 0.0f) {
-			p->rot_accum_ms += dt_ms;
-			while (p->rot_accum_ms >= p->rot_step_ms) {
-				p->rot_accum_ms -= p->rot_step_ms;
-				p->rot_deg += p->rot_step_deg;
-				// Keep angle bounded.
-				if (p->rot_deg >= 360.0f || p->rot_deg <= -360.0f) {
-					p->rot_deg = fmodf(p->rot_deg, 360.0f);
-				}
-			}
+		particles_swap_remove(self, i);
+	}
+}
+
+int particles_template_intern(Particles* self, const ParticleTemplate* tpl) {
+	if (!self || !self->initialized || !tpl) {
+		return -1;
+	}
+	uint32_t h = template_hash_bytes(tpl);
+	for (int i = 0; i < self->template_count; i++) {
+		if (self->template_hash[i] == h && memcmp(&self->templates[i], tpl, sizeof(*tpl)) == 0) {
+			return i;
 		}
-		alive++;
 	}
-	self->alive_count = alive;
+	if (self->template_count >= PARTICLE_TEMPLATE_MAX) {
+		return -1;
+	}
+	int id = self->template_count++;
+	self->templates[id] = *tpl;
+	self->template_hash[id] = h;
+	return id;
 }
 
 void particles_spawn(Particles* self, const Particle* p) {
-	if (!self || !self->initialized || !self->items || !p) {
+	if (!self || !self->initialized || !self->age_ms || !p) {
+		return;
+	}
+	if ((int)p->template_id >= self->template_count) {
+		self->stats_dropped++;
 		return;
 	}
 	// Drop newest when full.
@@ -143,40 +216,15 @@ void particles_spawn(Particles* self, const Particle* p) {
 		self->stats_dropped++;
 		return;
 	}
-	for (int i = 0; i < self->capacity; i++) {
-		if (!self->items[i].alive) {
-			self->items[i] = *p;
-			self->items[i].alive = true;
-			self->alive_count++;
-			self->stats_spawned++;
-			return;
-		}
-	}
-}
-
-static inline uint32_t mul_alpha_u8(uint32_t abgr, uint8_t a_mul) {
-	uint32_t a = (abgr >> 24u) & 0xFFu;
-	a = (a * (uint32_t)a_mul + 127u) / 255u;
-	return (abgr & 0x00FFFFFFu) | (a << 24u);
-}
-
-static void lerp_keyframe(const Particle* p, float t, ParticleKeyframe* out) {
-	*out = p->start;
-	out->opacity = lerpf(p->start.opacity, p->end.opacity, t);
-	out->size = lerpf(p->start.size, p->end.size, t);
-	out->r = lerpf(p->start.r, p->end.r, t);
-	out->g = lerpf(p->start.g, p->end.g, t);
-	out->b = lerpf(p->start.b, p->end.b, t);
-	out->color_blend_opacity = lerpf(p->start.color_blend_opacity, p->end.color_blend_opacity, t);
-	out->off_x = lerpf(p->start.off_x + p->jitter_start_x, p->end.off_x + p->jitter_end_x, t);
-	out->off_y = lerpf(p->start.off_y + p->jitter_start_y, p->end.off_y + p->jitter_end_y, t);
-	out->off_z = lerpf(p->start.off_z + p->jitter_start_z, p->end.off_z + p->jitter_end_z, t);
-	out->opacity = clampf2(out->opacity, 0.0f, 1.0f);
-	out->size = fmaxf(out->size, 0.0f);
-	out->r = clampf2(out->r, 0.0f, 1.0f);
-	out->g = clampf2(out->g, 0.0f, 1.0f);
-	out->b = clampf2(out->b, 0.0f, 1.0f);
-	out->color_blend_opacity = clampf2(out->color_blend_opacity, 0.0f, 1.0f);
+	int i = self->alive_count++;
+	self->origin_x[i] = p->origin_x;
+	self->origin_y[i] = p->origin_y;
+	self->origin_z[i] = p->origin_z;
+	self->age_ms[i] = p->age_ms;
+	self->life_ms[i] = p->life_ms;
+	self->jitter_seed[i] = p->jitter_seed;
+	self->template_id[i] = p->template_id;
+	self->stats_spawned++;
 }
 
 static inline float deg_to_rad2(float deg) {
@@ -202,214 +250,240 @@ static float camera_world_z_for_sector_approx2(const World* world, int sector, f
 	return z;
 }
 
-void particles_draw(
+// View parameters and outputs shared by every batch of one submit call.
+typedef struct ParticleView {
+	float cam_x;
+	float cam_y;
+	float cam_z_world;
+	float fx;
+	float fy;
+	float rx;
+	float ry;
+	float focal;
+	float half_w;
+	float half_h;
+	int width;
+	int height;
+	Compositor* comp;
+	TextureRegistry* texreg;
+	const AssetPaths* paths;
+	ImageCache* images;
+	uint32_t early_rejected;
+	uint32_t early_accepted;
+} ParticleView;
+
+// Image lookups are resolved at most once per template per submit.
+static const Texture* particles_template_texture(Particles* self, uint16_t id, TextureRegistry* texreg, const AssetPaths* paths) {
+	if (!self->template_tex_valid[id]) {
+		const ParticleTemplate* tpl = &self->templates[id];
+		const Texture* resolved = NULL;
+		if (tpl->has_image && tpl->image[0] != '\0') {
+			resolved = texture_registry_get(texreg, paths, tpl->image);
+			if (resolved && (!resolved->pixels || resolved->width <= 0 || resolved->height <= 0)) {
+				resolved = NULL;
+			}
+		}
+		self->template_tex[id] = resolved;
+		self->template_tex_valid[id] = true;
+	}
+	return self->template_tex[id];
+}
+
+// Keyframe evaluation and projection of particle `i`; pushes it to the compositor when
+// it is left on screen.
+static void particles_project(Particles* self, ParticleView* v, int i) {
+	uint16_t id = self->template_id[i];
+	const ParticleTemplate* tpl = &self->templates[id];
+	uint32_t life = self->life_ms[i];
+	float tt = clampf2(life > 0u ? (float)self->age_ms[i] / (float)life : 1.0f, 0.0f, 1.0f);
+	float op = clampf2(lerpf(tpl->start.opacity, tpl->end.opacity, tt), 0.0f, 1.0f);
+	float size = fmaxf(lerpf(tpl->start.size, tpl->end.size, tt), 0.0f);
+	if (op <= 0.001f || size <= 1e-6f) {
+		return;
+	}
+	float s_ox = tpl->start.off_x;
+	float s_oy = tpl->start.off_y;
+	float s_oz = tpl->start.off_z;
+	float e_ox = tpl->end.off_x;
+	float e_oy = tpl->end.off_y;
+	float e_oz = tpl->end.off_z;
+	// Spawn-time offset jitter, re-derived from the seed.
+	float j = tpl->offset_jitter;
+	if (j > 0.0f) {
+		uint32_t seed = self->jitter_seed[i];
+		s_ox += rand_signed(seed ^ 0xA511E9B3u) * j;
+		s_oy += rand_signed(seed ^ 0x94D049BBu) * j;
+		s_oz += rand_signed(seed ^ 0xD1B54A35u) * j;
+		e_ox += rand_signed(seed ^ 0xC2B2AE3Du) * j;
+		e_oy += rand_signed(seed ^ 0x165667B1u) * j;
+		e_oz += rand_signed(seed ^ 0x27D4EB2Fu) * j;
+	}
+	float dx = self->origin_x[i] + lerpf(s_ox, e_ox, tt) - v->cam_x;
+	float dy = self->origin_y[i] + lerpf(s_oy, e_oy, tt) - v->cam_y;
+	float depth = dx * v->fx + dy * v->fy;
+	if (depth <= 0.05f) {
+		return;
+	}
+	float pz = self->origin_z[i] + lerpf(s_oz, e_oz, tt);
+	float side = dx * v->rx + dy * v->ry;
+	const float min_proj_depth = 0.25f;
+	float scale = v->focal / fmaxf(depth, min_proj_depth);
+	float cr = clampf2(lerpf(tpl->start.r, tpl->end.r, tt), 0.0f, 1.0f);
+	float cg = clampf2(lerpf(tpl->start.g, tpl->end.g, tt), 0.0f, 1.0f);
+	float cb = clampf2(lerpf(tpl->start.b, tpl->end.b, tt), 0.0f, 1.0f);
+	float bl = clampf2(lerpf(tpl->start.color_blend_opacity, tpl->end.color_blend_opacity, tt), 0.0f, 1.0f);
+
+	const Texture* tex = particles_template_texture(self, id, v->texreg, v->paths);
+	float rot_cos = 1.0f;
+	float rot_sin = 0.0f;
+	float rot_deg = 0.0f;
+	if (tpl->rotate_enabled) {
+		// Discrete rotation: one step per rot_step_ms of age.
+		bool stepping = tpl->rot_step_ms > 0u && tpl->rot_step_deg != 0.0f;
+		rot_deg = stepping ? fmodf((float)(self->age_ms[i] / tpl->rot_step_ms) * tpl->rot_step_deg, 360.0f) : 0.0f;
+		float rot_rad = deg_to_rad2(-rot_deg); // clockwise
+		rot_cos = cosf(rot_rad);
+		rot_sin = sinf(rot_rad);
+	}
+
+	int w_px = (int)(size * scale + 0.5f);
+	int h_px = w_px;
+	if (w_px < 2) {
+		w_px = 2;
+		h_px = 2;
+	}
+	int max_w = v->width * 2;
+	int max_h = v->height * 2;
+	if (max_w > 0 && max_h > 0) {
+		if (w_px > max_w) {
+			w_px = max_w;
+			h_px = max_h < w_px ? max_h : w_px;
+		}
+	}
+
+	// Image particles snap to a size bucket and draw a pre-scaled (and pre-rotated)
+	// variant; without a cache slot they keep the exact size and per-pixel scaling.
+	bool rotate = tpl->rotate_enabled;
+	if (tex && v->images && w_px == h_px) {
+		int bucket = image_cache_bucket_size(w_px);
+		if (bucket > 0) {
+			uint16_t rot_key = IMAGE_CACHE_NO_ROTATION;
+			if (rotate) {
+				long key = lroundf(rot_deg * 100.0f) % 36000L;
+				rot_key = (uint16_t)(key < 0 ? key + 36000L : key);
+			}
+			const Texture* scaled = image_cache_get(v->images, tex, bucket, rot_key, rot_cos, rot_sin);
+			if (scaled) {
+				tex = scaled;
+				w_px = bucket;
+				h_px = bucket;
+				rotate = false;
+			}
+		}
+	}
+
+	float x_center = v->half_w + side * scale;
+	float y_center = v->half_h + (v->cam_z_world - pz) * scale;
+
+	int x0 = (int)(x_center - 0.5f * (float)w_px);
+	int y0 = (int)(y_center - 0.5f * (float)h_px);
+	int x1 = x0 + w_px;
+	int y1 = y0 + h_px;
+	int clip_x0 = x0 < 0 ? 0 : x0;
+	int clip_x1 = x1 > v->width ? v->width : x1;
+	int clip_y0 = y0 < 0 ? 0 : y0;
+	int clip_y1 = y1 > v->height ? v->height : y1;
+	if (clip_x0 >= clip_x1 || clip_y0 >= clip_y1) {
+		return;
+	}
+
+	self->stats_listed++;
+
+	// Coarse occlusion: skip fully hidden particles; fully visible ones need no per-pixel tests.
+	DepthPyramidResult occ = depth_pyramid_test_rect(v->comp->depth_pyramid, clip_x0, clip_y0, clip_x1, clip_y1, depth);
+	if (occ == DEPTH_PYRAMID_HIDDEN) {
+		v->early_rejected++;
+		return;
+	}
+	if (occ == DEPTH_PYRAMID_VISIBLE) {
+		v->early_accepted++;
+	}
+	CompositeItem* it = compositor_push(v->comp);
+	if (!it) {
+		return;
+	}
+	it->depth = depth;
+	it->depth_bias = 0.0f;
+	it->x0 = (int16_t)x0;
+	it->y0 = (int16_t)y0;
+	it->w = (int16_t)w_px;
+	it->h = (int16_t)h_px;
+	it->clip_x0 = (int16_t)clip_x0;
+	it->clip_y0 = (int16_t)clip_y0;
+	it->clip_x1 = (int16_t)clip_x1;
+	it->clip_y1 = (int16_t)clip_y1;
+	it->color = pack_abgr_u8(
+		(uint8_t)lroundf(op * 255.0f),
+		(uint8_t)lroundf(cb * 255.0f),
+		(uint8_t)lroundf(cg * 255.0f),
+		(uint8_t)lroundf(cr * 255.0f));
+	it->tint_blend = bl;
+	it->tex = tex;
+	it->shape = tpl->shape == PARTICLE_SHAPE_CIRCLE ? COMPOSITE_SHAPE_CIRCLE : COMPOSITE_SHAPE_SQUARE;
+	it->layer = COMPOSITE_LAYER_PARTICLES;
+	it->test_pixels = occ != DEPTH_PYRAMID_VISIBLE;
+	it->rotate = rotate;
+	it->rot_cos = rot_cos;
+	it->rot_sin = rot_sin;
+}
+
+void particles_submit(
 	Particles* self,
-	Framebuffer* fb,
+	Compositor* comp,
 	const World* world,
 	const Camera* cam,
 	int start_sector,
 	TextureRegistry* texreg,
 	const AssetPaths* paths,
-	const float* wall_depth,
-	const float* depth_pixels) {
-	if (!self || !self->initialized || !self->items || !fb || !fb->pixels || !world || !cam || !texreg || !paths) {
-		return;
-	}
-	if (!wall_depth && !depth_pixels) {
+	ImageCache* images) {
+	if (!self || !self->initialized || !comp || !comp->ready || !world || !cam || !texreg || !paths) {
 		return;
 	}
-
-	uint32_t drawn_particles = 0u;
-	uint32_t pixels_written = 0u;
-
+	const Framebuffer* fb = comp->fb;
+
+	ParticleView view;
+	memset(&view, 0, sizeof(view));
+	view.comp = comp;
+	view.texreg = texreg;
+	view.paths = paths;
+	view.images = images;
 	float cam_rad = deg_to_rad2(cam->angle_deg);
-	float fx = cosf(cam_rad);
-	float fy = sinf(cam_rad);
-	float rx = -fy;
-	float ry = fx;
+	view.cam_x = cam->x;
+	view.cam_y = cam->y;
+	view.fx = cosf(cam_rad);
+	view.fy = sinf(cam_rad);
+	view.rx = -view.fy;
+	view.ry = view.fx;
 	float fov_rad = deg_to_rad2(cam->fov_deg);
-	float half_w = 0.5f * (float)fb->width;
-	float half_h = 0.5f * (float)fb->height;
+	view.half_w = 0.5f * (float)fb->width;
+	view.half_h = 0.5f * (float)fb->height;
+	view.width = fb->width;
+	view.height = fb->height;
 	float tan_half_fov = tanf(0.5f * fov_rad);
 	if (tan_half_fov < 1e-4f) {
 		return;
 	}
-	float focal = half_w / tan_half_fov;
+	view.focal = view.half_w / tan_half_fov;
 
-	float cam_z_world = 0.0f;
+	view.cam_z_world = 0.0f;
 	if ((unsigned)start_sector < (unsigned)world->sector_count) {
-		cam_z_world = camera_world_z_for_sector_approx2(world, start_sector, cam->z);
+		view.cam_z_world = camera_world_z_for_sector_approx2(world, start_sector, cam->z);
 	}
 
-	for (int i = 0; i < self->capacity; i++) {
-		const Particle* p = &self->items[i];
-		if (!p->alive) {
-			continue;
-		}
-		float t = (p->life_ms > 0u) ? ((float)p->age_ms / (float)p->life_ms) : 1.0f;
-		t = clampf2(t, 0.0f, 1.0f);
-		ParticleKeyframe k;
-		lerp_keyframe(p, t, &k);
-		if (k.opacity <= 0.001f || k.size <= 1e-6f) {
-			continue;
-		}
-
-		float px = p->origin_x + k.off_x;
-		float py = p->origin_y + k.off_y;
-		float pz = p->origin_z + k.off_z;
-
-		float dx = px - cam->x;
-		float dy = py - cam->y;
-		float depth = dx * fx + dy * fy;
-		if (depth <= 0.05f) {
-			continue;
-		}
-		float side = dx * rx + dy * ry;
-
-		float proj_depth = depth;
-		const float min_proj_depth = 0.25f;
-		if (proj_depth < min_proj_depth) {
-			proj_depth = min_proj_depth;
-		}
-
-		float scale = focal / proj_depth;
-
-		int w_px = (int)(k.size * scale + 0.5f);
-		int h_px = w_px;
-		if (w_px < 2) {
-			w_px = 2;
-			h_px = 2;
-		}
-		int max_w = fb->width * 2;
-		int max_h = fb->height * 2;
-		if (max_w > 0 && max_h > 0) {
-			if (w_px > max_w) {
-				w_px = max_w;
-				h_px = max_h < w_px ? max_h : w_px;
-			}
-		}
-
-		float x_center = half_w + side * scale;
-		float y_center = half_h + (cam_z_world - pz) * scale;
-
-		int x0 = (int)(x_center - 0.5f * (float)w_px);
-		int x1 = x0 + w_px;
-		int y0 = (int)(y_center - 0.5f * (float)h_px);
-		int y1 = y0 + h_px;
-
-		int clip_x0 = x0 < 0 ? 0 : x0;
-		int clip_x1 = x1 > fb->width ? fb->width : x1;
-		int clip_y0 = y0 < 0 ? 0 : y0;
-		int clip_y1 = y1 > fb->height ? fb->height : y1;
-		if (clip_x0 >= clip_x1 || clip_y0 >= clip_y1) {
-			continue;
-		}
-
-		const Texture* tex = NULL;
-		int tex_w = 0;
-		int tex_h = 0;
-		if (p->has_image && p->image[0] != '\0') {
-			tex = texture_registry_get(texreg, paths, p->image);
-			if (!tex || !tex->pixels || tex->width <= 0 || tex->height <= 0) {
-				tex = NULL;
-			} else {
-				tex_w = tex->width;
-				tex_h = tex->height;
-			}
-		}
-
-		float rot_rad = p->rotate_enabled ? deg_to_rad2(-p->rot_deg) : 0.0f; // clockwise
-		float cr = cosf(rot_rad);
-		float sr = sinf(rot_rad);
-
-		uint8_t out_a = (uint8_t)lroundf(clampf2(k.opacity, 0.0f, 1.0f) * 255.0f);
-		uint8_t tint_r = (uint8_t)lroundf(k.r * 255.0f);
-		uint8_t tint_g = (uint8_t)lroundf(k.g * 255.0f);
-		uint8_t tint_b = (uint8_t)lroundf(k.b * 255.0f);
-
-		bool any_pixel = false;
-
-		for (int x = clip_x0; x < clip_x1; x++) {
-			if (wall_depth && depth >= wall_depth[x]) {
-				continue;
-			}
-			for (int y = clip_y0; y < clip_y1; y++) {
-				if (depth_pixels) {
-					float world_depth = depth_pixels[y * fb->width + x];
-					if (depth >= world_depth) {
-						continue;
-					}
-				}
-
-				// Local coords in [-0.5,0.5] range.
-				float u = (float)(x - x0) / (float)(w_px - 1);
-				float v = (float)(y - y0) / (float)(h_px - 1);
-				u = clampf2(u, 0.0f, 1.0f);
-				v = clampf2(v, 0.0f, 1.0f);
-				float lx = (u - 0.5f);
-				float ly = (v - 0.5f);
-
-				// Apply rotation for squares/images; circles ignore rotation.
-				float ru = u;
-				float rv = v;
-				if (p->rotate_enabled && (tex || p->shape == PARTICLE_SHAPE_SQUARE)) {
-					float rxu = lx * cr - ly * sr;
-					float ryu = lx * sr + ly * cr;
-					ru = rxu + 0.5f;
-					rv = ryu + 0.5f;
-					if (ru < 0.0f || ru > 1.0f || rv < 0.0f || rv > 1.0f) {
-						continue;
-					}
-				}
-
-				uint32_t src_px = 0;
-				if (tex) {
-					// Nearest sample.
-					int sx = (int)(ru * (float)(tex_w - 1) + 0.5f);
-					int sy = (int)(rv * (float)(tex_h - 1) + 0.5f);
-					src_px = tex->pixels[sy * tex_w + sx];
-					// Treat magenta as transparent for consistency with sprites.
-					if ((src_px & 0x00FFFFFFu) == 0x00FF00FFu) {
-						continue;
-					}
-					// Apply tint blend if requested.
-					float blend = clampf2(k.color_blend_opacity, 0.0f, 1.0f);
-					if (blend > 0.0f) {
-						uint8_t sa = (src_px >> 24u) & 0xFFu;
-						uint8_t sb = (src_px >> 16u) & 0xFFu;
-						uint8_t sg = (src_px >> 8u) & 0xFFu;
-						uint8_t sr0 = src_px & 0xFFu;
-						uint8_t nr = (uint8_t)lroundf(lerpf((float)sr0, (float)tint_r, blend));
-						uint8_t ng = (uint8_t)lroundf(lerpf((float)sg, (float)tint_g, blend));
-						uint8_t nb = (uint8_t)lroundf(lerpf((float)sb, (float)tint_b, blend));
-						src_px = pack_abgr_u8(sa, nb, ng, nr);
-					}
-					// Apply particle opacity.
-					src_px = mul_alpha_u8(src_px, out_a);
-					if (((src_px >> 24u) & 0xFFu) == 0u) {
-						continue;
-					}
-				} else {
-					if (p->shape == PARTICLE_SHAPE_CIRCLE) {
-						float rr = lx * lx + ly * ly;
-						if (rr > 0.25f) {
-							continue;
-						}
-					}
-					// Shape particle: ignore color_blend_opacity, always full tint.
-					src_px = pack_abgr_u8(out_a, tint_b, tint_g, tint_r);
-				}
-
-				uint32_t dst_px = fb->pixels[y * fb->width + x];
-				fb->pixels[y * fb->width + x] = blend_abgr8888_over(src_px, dst_px);
-				any_pixel = true;
-				pixels_written++;
-			}
-		}
-		if (any_pixel) {
-			drawn_particles++;
-		}
+	memset(self->template_tex_valid, 0, (size_t)self->template_count * sizeof(bool));
+	for (int i = 0; i < self->alive_count; i++) {
+		particles_project(self, &view, i);
 	}
-	self->stats_drawn_particles = drawn_particles;
-	self->stats_pixels_written = pixels_written;
+	self->stats_early_rejected = view.early_rejected;
+	self->stats_early_accepted = view.early_accepted;
 }
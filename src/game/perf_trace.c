@@ -1,5 +1,7 @@
 #include "game/perf_trace.h"
 
+#include "render/dynres.h"
+
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -135,11 +137,16 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
 	double pe_emitters_updated[PERF_TRACE_FRAME_COUNT];
 	double pe_emitters_gated[PERF_TRACE_FRAME_COUNT];
         double pe_spawn_attempted[PERF_TRACE_FRAME_COUNT];
+        double pe_emitters_offscreen[PERF_TRACE_FRAME_COUNT];
+        double pe_fast_forwarded[PERF_TRACE_FRAME_COUNT];
         double p_alive[PERF_TRACE_FRAME_COUNT];
         double p_capacity[PERF_TRACE_FRAME_COUNT];
         double p_spawned[PERF_TRACE_FRAME_COUNT];
         double p_dropped[PERF_TRACE_FRAME_COUNT];
+        double p_listed[PERF_TRACE_FRAME_COUNT];
         double p_drawn_particles[PERF_TRACE_FRAME_COUNT];
+        double p_early_rejected[PERF_TRACE_FRAME_COUNT];
+        double p_early_accepted[PERF_TRACE_FRAME_COUNT];
         double p_pixels_written[PERF_TRACE_FRAME_COUNT];
 
         double g_tick_ms[PERF_TRACE_FRAME_COUNT];
@@ -148,8 +155,31 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
         double g_capacity[PERF_TRACE_FRAME_COUNT];
         double g_spawned[PERF_TRACE_FRAME_COUNT];
         double g_dropped[PERF_TRACE_FRAME_COUNT];
+        double g_settled[PERF_TRACE_FRAME_COUNT];
+        double g_baked[PERF_TRACE_FRAME_COUNT];
+        double g_bake_failed[PERF_TRACE_FRAME_COUNT];
+        double g_decal_pages[PERF_TRACE_FRAME_COUNT];
+        double g_decal_evicted[PERF_TRACE_FRAME_COUNT];
+        double g_decal_kb[PERF_TRACE_FRAME_COUNT];
         double g_drawn_samples[PERF_TRACE_FRAME_COUNT];
+        double g_early_rejected[PERF_TRACE_FRAME_COUNT];
+        double g_early_accepted[PERF_TRACE_FRAME_COUNT];
         double g_pixels_written[PERF_TRACE_FRAME_COUNT];
+        double c_flush_ms[PERF_TRACE_FRAME_COUNT];
+        double c_items[PERF_TRACE_FRAME_COUNT];
+        double c_tiles[PERF_TRACE_FRAME_COUNT];
+        double ic_hits[PERF_TRACE_FRAME_COUNT];
+        double ic_misses[PERF_TRACE_FRAME_COUNT];
+        double ic_evictions[PERF_TRACE_FRAME_COUNT];
+        double ic_bypassed[PERF_TRACE_FRAME_COUNT];
+
+	double dr_scale[PERF_TRACE_FRAME_COUNT];
+	int dr_down = 0;
+	int dr_up = 0;
+	int ui_frames = 0;
+	int ui_uploads = 0;
+	int ui_cpu = 0;
+	int present_locked = 0;
 
 	double rc_planes_ms[PERF_TRACE_FRAME_COUNT];
 	double rc_hit_ms[PERF_TRACE_FRAME_COUNT];
@@ -173,6 +203,8 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
 	double rc_lighting_apply_iters[PERF_TRACE_FRAME_COUNT];
 	double rc_lighting_mul_iters[PERF_TRACE_FRAME_COUNT];
 	double rc_lighting_total_iters[PERF_TRACE_FRAME_COUNT];
+	double rc_wall_light_lookups[PERF_TRACE_FRAME_COUNT];
+	double rc_wall_light_unique[PERF_TRACE_FRAME_COUNT];
 
 	int worst_i = 0;
 	double worst_frame = t->frames[0].frame_ms;
@@ -193,11 +225,16 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
 		pe_emitters_updated[i] = (double)f->pe_emitters_updated;
                 pe_emitters_gated[i] = (double)f->pe_emitters_gated;
                 pe_spawn_attempted[i] = (double)f->pe_spawn_attempted;
+                pe_emitters_offscreen[i] = (double)f->pe_emitters_offscreen;
+                pe_fast_forwarded[i] = (double)f->pe_fast_forwarded;
                 p_alive[i] = (double)f->p_alive;
                 p_capacity[i] = (double)f->p_capacity;
                 p_spawned[i] = (double)f->p_spawned;
                 p_dropped[i] = (double)f->p_dropped;
+                p_listed[i] = (double)f->p_listed;
                 p_drawn_particles[i] = (double)f->p_drawn_particles;
+                p_early_rejected[i] = (double)f->p_early_rejected;
+                p_early_accepted[i] = (double)f->p_early_accepted;
                 p_pixels_written[i] = (double)f->p_pixels_written;
                 g_tick_ms[i] = f->g_tick_ms;
                 g_draw_ms[i] = f->g_draw_ms;
@@ -205,8 +242,35 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
                 g_capacity[i] = (double)f->g_capacity;
                 g_spawned[i] = (double)f->g_spawned;
                 g_dropped[i] = (double)f->g_dropped;
+                g_settled[i] = (double)f->g_settled;
+                g_baked[i] = (double)f->g_baked;
+                g_bake_failed[i] = (double)f->g_bake_failed;
+                g_decal_pages[i] = (double)f->g_decal_pages;
+                g_decal_evicted[i] = (double)f->g_decal_evicted;
+                g_decal_kb[i] = f->g_decal_kb;
                 g_drawn_samples[i] = (double)f->g_drawn_samples;
+                g_early_rejected[i] = (double)f->g_early_rejected;
+                g_early_accepted[i] = (double)f->g_early_accepted;
                 g_pixels_written[i] = (double)f->g_pixels_written;
+                c_flush_ms[i] = f->c_flush_ms;
+                c_items[i] = (double)f->c_items;
+                c_tiles[i] = (double)f->c_tiles;
+                ic_hits[i] = (double)f->ic_hits;
+                ic_misses[i] = (double)f->ic_misses;
+                ic_evictions[i] = (double)f->ic_evictions;
+                ic_bypassed[i] = (double)f->ic_bypassed;
+                dr_scale[i] = (double)f->dr_scale;
+                if (f->dr_decision == DYNRES_DOWN) {
+                        dr_down++;
+                } else if (f->dr_decision == DYNRES_UP) {
+                        dr_up++;
+                }
+                present_locked += f->present_locked ? 1 : 0;
+                if (f->ui_layer) {
+                        ui_frames++;
+                        ui_uploads += f->ui_layer_uploaded ? 1 : 0;
+                        ui_cpu += f->ui_layer_cpu_composite ? 1 : 0;
+                }
                 rc_planes_ms[i] = f->rc_planes_ms;
                 rc_hit_ms[i] = f->rc_hit_test_ms;
                 rc_walls_ms[i] = f->rc_walls_ms;
@@ -229,6 +293,8 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
 		rc_lighting_apply_iters[i] = (double)f->rc_lighting_apply_light_iters;
 		rc_lighting_mul_iters[i] = (double)f->rc_lighting_mul_light_iters;
 		rc_lighting_total_iters[i] = rc_lighting_apply_iters[i] + rc_lighting_mul_iters[i];
+		rc_wall_light_lookups[i] = (double)f->rc_wall_light_lookups;
+		rc_wall_light_unique[i] = (double)f->rc_wall_light_unique;
 		if (f->steps > max_steps) {
 			max_steps = f->steps;
 		}
@@ -251,11 +317,16 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
 	PerfStats s_pe_updated = compute_stats(pe_emitters_updated, n);
 	PerfStats s_pe_gated = compute_stats(pe_emitters_gated, n);
 	PerfStats s_pe_spawn_attempted = compute_stats(pe_spawn_attempted, n);
+        PerfStats s_pe_offscreen = compute_stats(pe_emitters_offscreen, n);
+        PerfStats s_pe_fast_forwarded = compute_stats(pe_fast_forwarded, n);
 	PerfStats s_p_alive = compute_stats(p_alive, n);
 	PerfStats s_p_capacity = compute_stats(p_capacity, n);
         PerfStats s_p_spawned = compute_stats(p_spawned, n);
         PerfStats s_p_dropped = compute_stats(p_dropped, n);
+        PerfStats s_p_listed = compute_stats(p_listed, n);
         PerfStats s_p_drawn = compute_stats(p_drawn_particles, n);
+        PerfStats s_p_rej = compute_stats(p_early_rejected, n);
+        PerfStats s_p_acc = compute_stats(p_early_accepted, n);
         PerfStats s_p_pix = compute_stats(p_pixels_written, n);
         PerfStats s_g_tick = compute_stats(g_tick_ms, n);
         PerfStats s_g_draw = compute_stats(g_draw_ms, n);
@@ -263,8 +334,24 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
         PerfStats s_g_capacity = compute_stats(g_capacity, n);
         PerfStats s_g_spawned = compute_stats(g_spawned, n);
         PerfStats s_g_dropped = compute_stats(g_dropped, n);
+        PerfStats s_g_settled = compute_stats(g_settled, n);
+        PerfStats s_g_baked = compute_stats(g_baked, n);
+        PerfStats s_g_bake_failed = compute_stats(g_bake_failed, n);
+        PerfStats s_g_decal_pages = compute_stats(g_decal_pages, n);
+        PerfStats s_g_decal_evicted = compute_stats(g_decal_evicted, n);
+        PerfStats s_g_decal_kb = compute_stats(g_decal_kb, n);
         PerfStats s_g_drawn = compute_stats(g_drawn_samples, n);
+        PerfStats s_g_rej = compute_stats(g_early_rejected, n);
+        PerfStats s_g_acc = compute_stats(g_early_accepted, n);
         PerfStats s_g_pix = compute_stats(g_pixels_written, n);
+        PerfStats s_c_flush = compute_stats(c_flush_ms, n);
+        PerfStats s_c_items = compute_stats(c_items, n);
+        PerfStats s_c_tiles = compute_stats(c_tiles, n);
+        PerfStats s_ic_hits = compute_stats(ic_hits, n);
+        PerfStats s_ic_misses = compute_stats(ic_misses, n);
+        PerfStats s_ic_evictions = compute_stats(ic_evictions, n);
+        PerfStats s_ic_bypassed = compute_stats(ic_bypassed, n);
+        PerfStats s_dr_scale = compute_stats(dr_scale, n);
         PerfStats s_rc_planes = compute_stats(rc_planes_ms, n);
         PerfStats s_rc_hit = compute_stats(rc_hit_ms, n);
         PerfStats s_rc_walls = compute_stats(rc_walls_ms, n);
@@ -287,6 +374,8 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
 	PerfStats s_rc_lai = compute_stats(rc_lighting_apply_iters, n);
 	PerfStats s_rc_lmi = compute_stats(rc_lighting_mul_iters, n);
 	PerfStats s_rc_lti = compute_stats(rc_lighting_total_iters, n);
+	PerfStats s_rc_wll = compute_stats(rc_wall_light_lookups, n);
+	PerfStats s_rc_wlu = compute_stats(rc_wall_light_unique, n);
 
 	int max_visible_walls = (int)t->frames[0].rc_lights_visible_walls;
 	int max_visible_planes = (int)t->frames[0].rc_lights_visible_planes;
@@ -315,32 +404,64 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
         print_stats_line(out, "frame_ms", &s_frame);
         print_stats_line(out, "update_ms", &s_update);
         print_stats_line(out, "render3d", &s_r3d);
+        fprintf(out, "dynres: scale avg=%.3f min=%.3f max=%.3f  last=%dx%d  steps down=%d up=%d\n",
+                s_dr_scale.avg,
+                s_dr_scale.min,
+                s_dr_scale.max,
+                t->frames[n - 1].dr_width,
+                t->frames[n - 1].dr_height,
+                dr_down,
+                dr_up);
         fprintf(out, "particles (timings):\n");
         print_stats_line_ms_precise(out, "  emit", &s_pe_update);
         print_stats_line_ms_precise(out, "  tick", &s_p_tick);
-        print_stats_line_ms_precise(out, "  draw", &s_p_draw);
-        fprintf(out, "particles (counts avg): emitters_alive=%.1f updated=%.1f gated=%.1f spawn_attempted=%.1f\n",
+        print_stats_line_ms_precise(out, "  submit", &s_p_draw);
+        fprintf(out, "particles (counts avg): emitters_alive=%.1f updated=%.1f gated=%.1f offscreen=%.1f spawn_attempted=%.1f fast_forwarded=%.1f\n",
                 s_pe_alive.avg,
                 s_pe_updated.avg,
                 s_pe_gated.avg,
-                s_pe_spawn_attempted.avg);
-        fprintf(out, "particles (pool avg): alive=%.1f cap=%.1f spawned=%.1f dropped=%.1f drawn=%.1f pixels=%.1f\n",
+                s_pe_offscreen.avg,
+                s_pe_spawn_attempted.avg,
+                s_pe_fast_forwarded.avg);
+        fprintf(out, "particles (pool avg): alive=%.1f cap=%.1f spawned=%.1f dropped=%.1f listed=%.1f drawn=%.1f early_rejected=%.1f early_accepted=%.1f pixels=%.1f\n",
                 s_p_alive.avg,
                 s_p_capacity.avg,
                 s_p_spawned.avg,
                 s_p_dropped.avg,
+                s_p_listed.avg,
                 s_p_drawn.avg,
+                s_p_rej.avg,
+                s_p_acc.avg,
                 s_p_pix.avg);
         fprintf(out, "gore (timings):\n");
         print_stats_line_ms_precise(out, "  tick", &s_g_tick);
-        print_stats_line_ms_precise(out, "  draw", &s_g_draw);
-        fprintf(out, "gore (pool avg): alive=%.1f cap=%.1f spawned=%.1f dropped=%.1f drawn=%.1f pixels=%.1f\n",
+        print_stats_line_ms_precise(out, "  submit", &s_g_draw);
+        fprintf(out, "gore (pool avg): alive=%.1f cap=%.1f spawned=%.1f dropped=%.1f settled=%.1f drawn=%.1f early_rejected=%.1f early_accepted=%.1f pixels=%.1f\n",
                 s_g_alive.avg,
                 s_g_capacity.avg,
                 s_g_spawned.avg,
                 s_g_dropped.avg,
+                s_g_settled.avg,
                 s_g_drawn.avg,
+                s_g_rej.avg,
+                s_g_acc.avg,
                 s_g_pix.avg);
+        fprintf(out, "gore (floor decals avg): baked=%.1f failed=%.1f pages=%.1f kb=%.1f sectors_evicted_total=%.0f\n",
+                s_g_baked.avg,
+                s_g_bake_failed.avg,
+                s_g_decal_pages.avg,
+                s_g_decal_kb.avg,
+                s_g_decal_evicted.max);
+        fprintf(out, "compositor (gore + particles):\n");
+        print_stats_line_ms_precise(out, "  flush", &s_c_flush);
+        fprintf(out, "  avg: items=%.1f tiles=%.1f threads=%d\n", s_c_items.avg, s_c_tiles.avg, t->frames[n - 1].c_threads);
+        fprintf(out, "image_cache (avg): hits=%.1f misses=%.1f evictions=%.1f bypassed=%.1f  last: used_kb=%d entries=%d\n",
+                s_ic_hits.avg,
+                s_ic_misses.avg,
+                s_ic_evictions.avg,
+                s_ic_bypassed.avg,
+                t->frames[n - 1].ic_used_kb,
+                t->frames[n - 1].ic_entries);
         fprintf(out, "render3d_breakdown (includes sampling+lighting):\n");
         print_stats_line(out, "  planes", &s_rc_planes);
         print_stats_line(out, "  hit", &s_rc_hit);
@@ -351,8 +472,13 @@ static void perf_trace_dump(const PerfTrace* t, FILE* out) {
 	fprintf(out, "  lights avg: world=%.1f  planes=%.1f  walls=%.1f  uncapped=%.1f  max_planes=%d  max_walls=%d (uncapped=%d)\n", s_rc_lw.avg, s_rc_lvp.avg, s_rc_lvw.avg, s_rc_lvu.avg, max_visible_planes, max_visible_walls, max_visible_lights_uncapped);
 	fprintf(out, "  calls avg: apply=%.0f  mul=%.0f\n", s_rc_lac.avg, s_rc_lmc.avg);
 	fprintf(out, "  iters avg: apply=%.0f  mul=%.0f  total=%.0f\n", s_rc_lai.avg, s_rc_lmi.avg, s_rc_lti.avg);
+	fprintf(out, "  wall cache avg: walls_lit=%.1f  lookups=%.0f  max_walls_lit=%.0f\n", s_rc_wlu.avg, s_rc_wll.avg, s_rc_wlu.max);
 	print_stats_line(out, "ui_ms", &s_ui);
 	print_stats_line(out, "present", &s_present);
+	fprintf(out, "present_path: locked=%d copied=%d\n", present_locked, n - present_locked);
+	if (ui_frames > 0) {
+		fprintf(out, "ui_layer: frames=%d uploads=%d cached=%d cpu_composite=%d\n", ui_frames, ui_uploads, ui_frames - ui_uploads - ui_cpu, ui_cpu);
+	}
 	fprintf(out, "steps      avg=%6.2f  p95=%6.2f  min=%6.0f  max=%6d\n", s_steps.avg, s_steps.p95, s_steps.min, max_steps);
 	fprintf(out,
 		"renderer_counts avg: portals=%.1f depth=%.1f  tex_get=%.0f  strcmps=%.0f  wall_tests=%.0f\n",
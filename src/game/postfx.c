@@ -267,12 +267,45 @@ void postfx_draw(const PostFxSystem* self, Framebuffer* fb) {
 		}
 	}
 
+	// Collapse the stack into one full-screen blend. Washes (c_i, a_i) applied in order
+	// give dst * prod(1 - a_i) + sum(c_i * a_i * prod_{j>i}(1 - a_j)), i.e. one wash with
+	// alpha A = 1 - prod(1 - a_i) and color sum(...) / A.
+	float keep = 1.0f;
+	float acc[3] = {0.0f, 0.0f, 0.0f};
+	uint32_t single = 0u;
+	int used = 0;
 	for (int i = 0; i < n; i++) {
 		const PostFxEffect* e = &self->effects[idx[i]];
 		uint8_t a = effect_alpha_now(e);
 		if (a == 0u) {
 			continue;
 		}
-		draw_rect_abgr8888_alpha(fb, 0, 0, fb->width, fb->height, abgr_with_a(e->abgr_max, a));
+		single = abgr_with_a(e->abgr_max, a);
+		used++;
+		float af = (float)a / 255.0f;
+		for (int c = 0; c < 3; c++) {
+			float v = (float)((e->abgr_max >> (8 * c)) & 0xFFu);
+			acc[c] = acc[c] * (1.0f - af) + v * af;
+		}
+		keep *= 1.0f - af;
+	}
+	if (used == 0) {
+		return;
+	}
+	if (used == 1) {
+		draw_rect_abgr8888_alpha(fb, 0, 0, fb->width, fb->height, single);
+		return;
+	}
+	float alpha = 1.0f - keep;
+	long a8 = lroundf(alpha * 255.0f);
+	if (a8 <= 0) {
+		return;
+	}
+	uint32_t combined = (uint32_t)(a8 > 255 ? 255 : a8) << 24;
+	for (int c = 0; c < 3; c++) {
+		long v = lroundf(acc[c] / alpha);
+		v = v < 0 ? 0 : (v > 255 ? 255 : v);
+		combined |= (uint32_t)v << (8 * c);
 	}
+	draw_rect_abgr8888_alpha(fb, 0, 0, fb->width, fb->height, combined);
 }
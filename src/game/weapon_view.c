@@ -17,8 +17,15 @@ static int clampi(int v, int lo, int hi) {
 	return v;
 }
 
-void weapon_view_draw(Framebuffer* fb, const Player* player, TextureRegistry* texreg, const AssetPaths* paths) {
-	if (!fb || !player || !texreg || !paths) {
+void weapon_view_bob_offset(const Player* player, float scale, int* out_x, int* out_y) {
+	float amp = player ? player->weapon_view_bob_amp : 0.0f;
+	float phase = player ? player->weapon_view_bob_phase : 0.0f;
+	*out_x = (int)lroundf(sinf(phase) * amp * 6.0f * scale);
+	*out_y = (int)lroundf(fabsf(cosf(phase)) * amp * 4.0f * scale);
+}
+
+void weapon_view_draw(Framebuffer* fb, const Player* player, TextureRegistry* texreg, const AssetPaths* paths, float scale) {
+	if (!fb || !player || !texreg || !paths || !(scale > 0.0f)) {
 		return;
 	}
 
@@ -49,14 +56,23 @@ void weapon_view_draw(Framebuffer* fb, const Player* player, TextureRegistry* te
 	bar_h = clampi(bar_h, 40, 80);
 	int bar_y = fb->height - bar_h;
 
-	int overlap_px = 6;
-	float amp = player->weapon_view_bob_amp;
-	float phase = player->weapon_view_bob_phase;
-	int bob_x = (int)lroundf(sinf(phase) * amp * 6.0f);
-	int bob_y = (int)lroundf(fabsf(cosf(phase)) * amp * 4.0f);
+	int overlap_px = (int)lroundf(6.0f * scale);
+	int bob_x = 0;
+	int bob_y = 0;
+	weapon_view_bob_offset(player, scale, &bob_x, &bob_y);
 
-	int dst_x = (fb->width - t->width) / 2 + bob_x;
-	int dst_y = bar_y - t->height + overlap_px + bob_y;
-
-	draw_blit_abgr8888_alpha(fb, dst_x, dst_y, t->pixels, t->width, t->height);
+	if (scale == 1.0f) {
+		int dst_x = (fb->width - t->width) / 2 + bob_x;
+		int dst_y = bar_y - t->height + overlap_px + bob_y;
+		draw_blit_abgr8888_alpha(fb, dst_x, dst_y, t->pixels, t->width, t->height);
+		return;
+	}
+	int w = (int)lroundf((float)t->width * scale);
+	int h = (int)lroundf((float)t->height * scale);
+	if (w <= 0 || h <= 0) {
+		return;
+	}
+	int dst_x = (fb->width - w) / 2 + bob_x;
+	int dst_y = bar_y - h + overlap_px + bob_y;
+	draw_blit_abgr8888_scaled_nearest_alpha(fb, dst_x, dst_y, w, h, t->pixels, t->width, t->height);
 }
@@ -11,6 +11,8 @@ void world_init_empty(World* self) {
 void world_destroy(World* self) {
         gore_shutdown(&self->gore);
         particles_shutdown(&self->particles);
+        plane_lightmaps_destroy(&self->lightmaps);
+        floor_decals_destroy(&self->floor_decals);
         free(self->vertices);
         free(self->sectors);
         free(self->walls);
@@ -357,6 +359,45 @@ void world_set_wall_tex(Wall* w, StringView tex) {
 	copy_sv(w->base_tex, tex);
 }
 
+bool world_sector_bounds(const World* world, int sector, float* min_x, float* min_y, float* max_x, float* max_y) {
+	bool any = false;
+	if (!world || (unsigned)sector >= (unsigned)world->sector_count) {
+		return false;
+	}
+	int begin = 0;
+	int end = world->wall_count;
+	const int* indices = NULL;
+	if (world->sector_wall_offsets && world->sector_wall_indices) {
+		begin = world->sector_wall_offsets[sector];
+		end = world->sector_wall_offsets[sector + 1];
+		indices = world->sector_wall_indices;
+	}
+	for (int k = begin; k < end; k++) {
+		const Wall* w = &world->walls[indices ? indices[k] : k];
+		if (w->front_sector != sector && w->back_sector != sector) {
+			continue;
+		}
+		int vs[2] = {w->v0, w->v1};
+		for (int j = 0; j < 2; j++) {
+			if ((unsigned)vs[j] >= (unsigned)world->vertex_count) {
+				continue;
+			}
+			Vertex v = world->vertices[vs[j]];
+			if (!any) {
+				*min_x = *max_x = v.x;
+				*min_y = *max_y = v.y;
+				any = true;
+			} else {
+				*min_x = fminf(*min_x, v.x);
+				*min_y = fminf(*min_y, v.y);
+				*max_x = fmaxf(*max_x, v.x);
+				*max_y = fmaxf(*max_y, v.y);
+			}
+		}
+	}
+	return any;
+}
+
 bool world_sector_contains_point(const World* world, int sector, float px, float py) {
 	if (!world || (unsigned)sector >= (unsigned)world->sector_count) {
 		return false;
@@ -1,3 +1,4 @@
+#include "core/arena.h"
 #include "core/config.h"
 #include "core/game_loop.h"
 #include "core/log.h"
@@ -10,7 +11,12 @@
 #include "platform/time.h"
 #include "platform/window.h"
 
+#include "render/compositor.h"
+#include "render/depth_pyramid.h"
+#include "render/depth_spans.h"
 #include "render/draw.h"
+#include "render/dynres.h"
+#include "render/image_cache.h"
 #include "render/camera.h"
 #include "render/framebuffer.h"
 #include "render/present.h"
@@ -51,6 +57,7 @@
 #include "game/purge_item.h"
 #include "game/rules.h"
 #include "game/sector_height.h"
+#include "game/sector_visibility.h"
 #include "game/map_music.h"
 
 #include "game/doors.h"
@@ -875,10 +882,13 @@ static void gore_emit_chunk_burst(
         float speed_jitter,
         float spread_deg,
         uint32_t seed,
-        int last_valid_sector) {
+        int last_valid_sector,
+        const SectorVisibility* vis) {
         if (!world || !world->gore.initialized || count <= 0) {
                 return;
         }
+        // Out of sight the flight is skipped and the chunks stamp straight where they land.
+        bool settle = !sector_visibility_contains(vis, last_valid_sector);
         uint32_t rng = seed ? seed : 0xC11DB10Du;
         float rx = 1.0f, ry = 0.0f, rz = 0.0f;
         float ux = 0.0f, uy = 1.0f, uz = 0.0f;
@@ -910,11 +920,15 @@ static void gore_emit_chunk_burst(
             float radius = base_radius * size_mul;
             float cr = 1.0f, cg = 0.0f, cb = 0.0f;
             gore_pick_palette(&rng, &cr, &cg, &cb);
-            (void)gore_spawn_chunk(&world->gore, world, x, y, z, vx, vy, vz, radius, cr, cg, cb, 2800u, last_valid_sector);
+            if (settle) {
+                    (void)gore_settle_chunk(&world->gore, world, x, y, z, vx, vy, vz, radius, cr, cg, cb, 2800u, last_valid_sector);
+            } else {
+                    (void)gore_spawn_chunk(&world->gore, world, x, y, z, vx, vy, vz, radius, cr, cg, cb, 2800u, last_valid_sector);
+            }
         }
 }
 
-static void gore_emit_damage_splatter(World* world, const Entity* target, const PhysicsBody* player_body, float hx, float hy, uint32_t seed) {
+static void gore_emit_damage_splatter(World* world, const Entity* target, const PhysicsBody* player_body, float hx, float hy, uint32_t seed, const SectorVisibility* vis) {
         if (!world || !world->gore.initialized || !target) {
                 return;
         }
@@ -939,10 +953,10 @@ static void gore_emit_damage_splatter(World* world, const Entity* target, const
         }
         float burst_dir_z = 0.6f;
         uint32_t s0 = mix_gore_seed(seed, (uint32_t)target->id.index + 1u);
-        gore_emit_chunk_burst(world, base_x, base_y, center_z, nx, ny, burst_dir_z, 18, 6.5f, 3.0f, 55.0f, s0, target->body.last_valid_sector);
+        gore_emit_chunk_burst(world, base_x, base_y, center_z, nx, ny, burst_dir_z, 18, 6.5f, 3.0f, 55.0f, s0, target->body.last_valid_sector, vis);
 }
 
-static void gore_emit_death_burst(World* world, const Entity* target, const PhysicsBody* player_body, uint32_t seed) {
+static void gore_emit_death_burst(World* world, const Entity* target, const PhysicsBody* player_body, uint32_t seed, const SectorVisibility* vis) {
         if (!world || !world->gore.initialized || !target) {
                 return;
         }
@@ -963,9 +977,29 @@ static void gore_emit_death_burst(World* world, const Entity* target, const Phys
         }
 
         uint32_t s0 = mix_gore_seed(seed, (uint32_t)target->id.index + 11u);
-        gore_emit_chunk_burst(world, base_x, base_y, center_z, nx, ny, 0.8f, 36, 8.0f, 3.5f, 85.0f, s0, target->body.last_valid_sector);
+        gore_emit_chunk_burst(world, base_x, base_y, center_z, nx, ny, 0.8f, 36, 8.0f, 3.5f, 85.0f, s0, target->body.last_valid_sector, vis);
 }
 
+// What the gameplay UI layer (render.ui_layer) shows, apart from animations. The layer
+// is redrawn only when this changes or while something on it animates.
+typedef struct UiLayerStamp {
+	int width;
+	int height;
+	uint32_t hud;     // hud_version
+	uint32_t console; // Console.version
+	bool console_open;
+	int weapon;
+	bool weapon_shooting;
+	int weapon_frame;
+	int weapon_bob_x;
+	int weapon_bob_y;
+	bool notification; // a toast is showing (slides, scrolls)
+	bool postfx;       // a color wash is fading
+	int fps;           // -1 when hidden
+	bool font_test;
+	bool debug;        // debug overlay (live values)
+} UiLayerStamp;
+
 static void set_mouse_capture(Window* win, const CoreConfig* cfg, bool captured) {
 	if (!win || !win->window) {
 		return;
@@ -1259,7 +1293,38 @@ int main(int argc, char** argv) {
 	texture_registry_init(&texreg);
 
 	float* wall_depth = NULL;
+	// Billboard occlusion depth: compact spans by default, per-pixel floats only while
+	// render.depth_pixels is enabled (allocated on demand in the frame loop).
 	float* depth_pixels = NULL;
+	bool depth_pixels_alloc_failed = false;
+	DepthSpans depth_spans;
+	depth_spans_init(&depth_spans);
+	DepthPyramid depth_pyramid;
+	depth_pyramid_init(&depth_pyramid);
+	// Bins and rasterizes gore and particles across worker threads.
+	Compositor compositor;
+	if (!compositor_init(&compositor, cfg->render.composite_threads)) {
+		log_warn("Compositor workers unavailable; drawing gore and particles on the main thread");
+	}
+	// Pre-scaled image particle variants, bounded by render.image_cache_kb.
+	ImageCache image_cache;
+	bool image_cache_ok = image_cache_init(&image_cache, (size_t)cfg->render.image_cache_kb * 1024u);
+	if (!image_cache_ok) {
+		log_warn("Image cache unavailable; image particles are scaled per pixel");
+	}
+	// Scratch memory that lives for one rendered frame (sprite draw list, ...).
+	Arena frame_arena;
+	arena_init(&frame_arena, 64u * 1024u);
+	// Scaled world framebuffer + controller for render.dynamic_resolution.
+	DynRes dynres;
+	dynres_init(&dynres);
+	// render.ui_layer: window-sized UI layer, redrawn only when ui_stamp changes.
+	Framebuffer ui_fb;
+	memset(&ui_fb, 0, sizeof(ui_fb));
+	bool ui_fb_alloc_failed = false;
+	UiLayerStamp ui_stamp;
+	memset(&ui_stamp, 0, sizeof(ui_stamp));
+	bool ui_stamp_valid = false;
 
 	HudSystem hud;
 	memset(&hud, 0, sizeof(hud));
@@ -1274,6 +1339,13 @@ int main(int argc, char** argv) {
 		}
 		free(wall_depth);
 		free(depth_pixels);
+		depth_spans_destroy(&depth_spans);
+		depth_pyramid_destroy(&depth_pyramid);
+		compositor_destroy(&compositor);
+		image_cache_destroy(&image_cache);
+		arena_destroy(&frame_arena);
+		dynres_destroy(&dynres);
+		framebuffer_destroy(&ui_fb);
 		present_shutdown(&presenter);
 		framebuffer_destroy(&fb);
 		window_destroy(&win);
@@ -1344,10 +1416,6 @@ int main(int argc, char** argv) {
 	if (!wall_depth) {
 		log_error("out of memory allocating depth buffer");
 	}
-	depth_pixels = (float*)malloc((size_t)fb.width * (size_t)fb.height * sizeof(float));
-	if (!depth_pixels) {
-		log_error("out of memory allocating per-pixel depth buffer");
-	}
 
 	GameLoop loop;
 	game_loop_init(&loop, 1.0 / 60.0);
@@ -1411,6 +1479,8 @@ int main(int argc, char** argv) {
 	console_ctx.perf = &perf;
 	console_ctx.fb = &fb;
 	console_ctx.wall_depth = wall_depth;
+	console_ctx.dynres = &dynres;
+	console_ctx.compositor = &compositor;
 	console_ctx.prev_bgmusic = prev_bgmusic;
 	console_ctx.prev_bgmusic_cap = sizeof(prev_bgmusic);
 	console_ctx.prev_soundfont = prev_soundfont;
@@ -1418,6 +1488,7 @@ int main(int argc, char** argv) {
 	console_ctx.notifications = &notifications;
 	console_ctx.doors = &doors;
 	console_ctx.gameplay_time_s = &gameplay_time_s;
+	console_commands_apply_render_config(&console_ctx);
 
 	ScreenRuntime screens;
 	screen_runtime_init(&screens);
@@ -1507,6 +1578,7 @@ int main(int argc, char** argv) {
                 double p_draw_ms = 0.0;
                 double g_tick_ms = 0.0;
                 double g_draw_ms = 0.0;
+                double c_flush_ms = 0.0;
 		int steps = game_loop_begin_frame(&loop, now);
 		double frame_dt_s = 0.0;
 		if (prev_time != 0.0) {
@@ -1759,14 +1831,15 @@ int main(int argc, char** argv) {
 				font_draw_text(&ui_font, &fb, x, y, fps_text, color_from_abgr(0xFFFFFFFFu), 1.0f);
 			}
 			console_draw(&console, &ui_font, &fb);
-			if (cfg && cfg->render.vga_mode) {
-				vga_palette_apply(&fb);
-			}
 			if (perf_trace_is_active(&perf)) {
 				ui_t1 = platform_time_seconds();
 				present_t0 = ui_t1;
 			}
-			present_frame(&presenter, &win, &fb);
+			if (cfg && cfg->render.vga_mode) {
+				present_frame_vga(&presenter, &win, &fb);
+			} else {
+				present_frame(&presenter, &win, &fb);
+			}
 			if (perf_trace_is_active(&perf)) {
 				present_t1 = platform_time_seconds();
 				double frame_t1 = present_t1;
@@ -1839,6 +1912,11 @@ int main(int argc, char** argv) {
 			if (gs.mode == GAME_MODE_PLAYING) {
 				crash_diag_set_phase(PHASE_GAMEPLAY_UPDATE_TICK);
 				float now_s = gameplay_time_s;
+				// Sectors the last rendered frame reached; gates particle emitters and gore chunk flight.
+				SectorVisibility sector_vis = {NULL, 0};
+				if (map_ok) {
+					sector_vis.visible = raycast_visible_sectors(&map.world, &sector_vis.sector_count);
+				}
 				bool action_down = key_down2(&in, cfg->input.action_primary, cfg->input.action_secondary);
 				bool action_pressed = action_down && !player.action_prev_down;
 				player.action_prev_down = action_down;
@@ -1979,7 +2057,7 @@ int main(int argc, char** argv) {
                                                                         target->hp -= ev->amount;
                                                                         if (map_ok && tdef->kind == ENTITY_KIND_ENEMY) {
                                                                                 uint32_t gore_seed = mix_gore_seed((uint32_t)target->id.index, (uint32_t)ev->entity.index ^ (uint32_t)ev->amount);
-                                                                                gore_emit_damage_splatter(&map.world, target, &player.body, ev->x, ev->y, gore_seed);
+                                                                                gore_emit_damage_splatter(&map.world, target, &player.body, ev->x, ev->y, gore_seed, &sector_vis);
                                                                         }
                                                                         if (target->hp <= 0) {
                                                                                 target->hp = 0;
@@ -2016,7 +2094,7 @@ int main(int argc, char** argv) {
                                                                         Entity* target = NULL;
                                                                         if (entity_system_resolve(&entities, ev->entity, &target)) {
                                                                                 uint32_t gore_seed = mix_gore_seed((uint32_t)ev->entity.index, (uint32_t)ev->other.index + 991u);
-                                                                                gore_emit_death_burst(&map.world, target, &player.body, gore_seed);
+                                                                                gore_emit_death_burst(&map.world, target, &player.body, gore_seed, &sector_vis);
                                                                         }
                                                                 }
                                                                 // Reserved for future: death sounds, drops, score, etc.
@@ -2074,6 +2152,7 @@ int main(int argc, char** argv) {
                                                         player.body.x,
                                                         player.body.y,
                                                         player.body.sector,
+                                                        &sector_vis,
                                                         dt_ms);
                                                 if (perf_trace_is_active(&perf)) {
                                                         double t1 = platform_time_seconds();
@@ -2086,7 +2165,7 @@ int main(int argc, char** argv) {
                                                         p_tick_ms += (t1 - t0) * 1000.0;
                                                         t0 = t1;
                                                 }
-                                                gore_tick(&map.world.gore, &map.world, dt_ms);
+                                                gore_tick(&map.world.gore, &map.world, &map.world.floor_decals, dt_ms);
                                                 if (perf_trace_is_active(&perf)) {
                                                         double t1 = platform_time_seconds();
                                                         g_tick_ms += (t1 - t0) * 1000.0;
@@ -2302,12 +2381,50 @@ int main(int argc, char** argv) {
 		}
 		RaycastPerf rc_perf;
 		RaycastPerf* rc_perf_ptr = NULL;
+		// The world pass is timed every frame: dynamic resolution steers on it.
+		render3d_t0 = platform_time_seconds();
 		if (perf_trace_is_active(&perf)) {
-			render3d_t0 = platform_time_seconds();
 			rc_perf_ptr = &rc_perf;
 		}
+		arena_reset(&frame_arena);
+		// With render.ui_layer the UI is drawn into its own window-sized layer and
+		// composited over the world in present_frame_layers.
+		bool ui_layer = cfg->render.ui_layer && !ui_fb_alloc_failed;
+		if (ui_layer && (ui_fb.width != win.width || ui_fb.height != win.height)) {
+			framebuffer_destroy(&ui_fb);
+			ui_stamp_valid = false;
+			if (!framebuffer_init(&ui_fb, win.width, win.height)) {
+				log_error("out of memory allocating UI layer; drawing the UI into the frame");
+				framebuffer_destroy(&ui_fb);
+				ui_fb_alloc_failed = true;
+				ui_layer = false;
+			}
+		} else if (!cfg->render.ui_layer && ui_fb.pixels) {
+			framebuffer_destroy(&ui_fb);
+			ui_stamp_valid = false;
+		}
+		// With render.present_lock the frame is drawn straight into a locked texture.
+		Framebuffer* frame_fb = &fb;
+		double present_lock_ms = 0.0;
+		if (cfg->render.present_lock && !ui_layer) {
+			double t0 = platform_time_seconds();
+			frame_fb = present_lock_frame(&presenter, &win, &fb);
+			present_lock_ms = (platform_time_seconds() - t0) * 1000.0;
+		}
+		Framebuffer* world_fb = dynres_begin_frame(&dynres, &cfg->render.dynamic_resolution, frame_fb);
+		if (cfg->render.depth_pixels && !depth_pixels && !depth_pixels_alloc_failed) {
+			depth_pixels = (float*)malloc((size_t)fb.width * (size_t)fb.height * sizeof(float));
+			if (!depth_pixels) {
+				log_error("out of memory allocating per-pixel depth buffer; using depth spans");
+				depth_pixels_alloc_failed = true;
+			}
+		} else if (!cfg->render.depth_pixels && depth_pixels) {
+			free(depth_pixels);
+			depth_pixels = NULL;
+		}
+		DepthSpans* frame_depth_spans = depth_pixels ? NULL : &depth_spans;
 		raycast_render_textured_from_sector_profiled(
-			&fb,
+			world_fb,
 			map_ok ? &map.world : NULL,
 			&cam,
 			&texreg,
@@ -2315,61 +2432,125 @@ int main(int argc, char** argv) {
 			map_ok ? map.sky : NULL,
 			wall_depth,
 			depth_pixels,
+			frame_depth_spans,
 			start_sector,
 			rc_perf_ptr
 		);
                 if (map_ok) {
-                        entity_system_draw_sprites(&entities, &fb, &map.world, &cam, start_sector, &texreg, &paths, wall_depth, depth_pixels);
+                        // Coarse occlusion for whole-billboard reject/accept (see render/depth_pyramid.h).
+                        depth_pyramid_build(&depth_pyramid, world_fb->width, world_fb->height, depth_pixels, frame_depth_spans);
+                        entity_system_draw_sprites(&entities, world_fb, &map.world, &cam, start_sector, &texreg, &paths, wall_depth, depth_pixels, frame_depth_spans, &depth_pyramid, &frame_arena);
+                        compositor_begin(&compositor, world_fb, wall_depth, depth_pixels, frame_depth_spans, &depth_pyramid);
+                        ImageCache* images = NULL;
+                        if (image_cache_ok) {
+                                image_cache_begin_frame(&image_cache);
+                                if (cfg->render.image_cache_kb > 0) {
+                                        image_cache_set_budget(&image_cache, (size_t)cfg->render.image_cache_kb * 1024u);
+                                        images = &image_cache;
+                                } else if (image_cache.live > 0) {
+                                        image_cache_clear(&image_cache);
+                                }
+                        }
                         if (perf_trace_is_active(&perf)) {
                                 double t0 = platform_time_seconds();
-                                gore_draw(&map.world.gore, &fb, &map.world, &cam, start_sector, wall_depth, depth_pixels);
+                                gore_submit(&map.world.gore, &compositor, &map.world, &cam, start_sector);
                                 double t1 = platform_time_seconds();
                                 g_draw_ms += (t1 - t0) * 1000.0;
                                 t0 = t1;
-                                particles_draw(&map.world.particles, &fb, &map.world, &cam, start_sector, &texreg, &paths, wall_depth, depth_pixels);
+                                particles_submit(&map.world.particles, &compositor, &map.world, &cam, start_sector, &texreg, &paths, images);
                                 t1 = platform_time_seconds();
                                 p_draw_ms += (t1 - t0) * 1000.0;
+                                t0 = t1;
+                                compositor_flush(&compositor);
+                                t1 = platform_time_seconds();
+                                c_flush_ms += (t1 - t0) * 1000.0;
                         } else {
-                                gore_draw(&map.world.gore, &fb, &map.world, &cam, start_sector, wall_depth, depth_pixels);
-                                particles_draw(&map.world.particles, &fb, &map.world, &cam, start_sector, &texreg, &paths, wall_depth, depth_pixels);
+                                gore_submit(&map.world.gore, &compositor, &map.world, &cam, start_sector);
+                                particles_submit(&map.world.particles, &compositor, &map.world, &cam, start_sector, &texreg, &paths, images);
+                                compositor_flush(&compositor);
                         }
                 }
+		render3d_t1 = platform_time_seconds();
+		dynres_update(&dynres, &cfg->render.dynamic_resolution, (render3d_t1 - render3d_t0) * 1000.0);
+		if (!ui_layer) {
+			dynres_end_frame(&dynres, world_fb, frame_fb);
+		}
 		if (perf_trace_is_active(&perf)) {
-			render3d_t1 = platform_time_seconds();
 			ui_t0 = render3d_t1;
 		}
 
-		weapon_view_draw(&fb, &player, &texreg, &paths);
-		postfx_draw(&postfx, &fb);
-		hud_draw(&hud, &fb, &player, &gs, fps, &texreg, &paths);
-		if (show_debug) {
-			debug_overlay_draw(&ui_font, &fb, &player, map_ok ? &map.world : NULL, &entities, fps);
-		}
-		if (show_font_test) {
-			font_draw_test_page(&ui_font, &fb, 16, 16);
+		// The UI layer keeps last frame's contents unless something on it changed or is
+		// animating; then it is cleared and drawn again (and re-uploaded by the presenter).
+		Framebuffer* ui_fbp = ui_layer ? &ui_fb : frame_fb;
+		float ui_scale = ui_layer ? (float)ui_fb.height / (float)fb.height : 1.0f;
+		bool ui_changed = true;
+		if (ui_layer) {
+			UiLayerStamp stamp;
+			memset(&stamp, 0, sizeof(stamp));
+			stamp.width = ui_fb.width;
+			stamp.height = ui_fb.height;
+			stamp.hud = hud_version(&hud, &player);
+			stamp.console = console.version;
+			stamp.console_open = console_is_open(&console);
+			stamp.weapon = (int)player.weapon_equipped;
+			stamp.weapon_shooting = player.weapon_view_anim_shooting;
+			stamp.weapon_frame = player.weapon_view_anim_frame;
+			weapon_view_bob_offset(&player, ui_scale, &stamp.weapon_bob_x, &stamp.weapon_bob_y);
+			stamp.notification = notifications.active;
+			stamp.postfx = postfx_is_active(&postfx);
+			stamp.fps = show_fps ? fps : -1;
+			stamp.font_test = show_font_test;
+			stamp.debug = show_debug;
+			ui_changed = !ui_stamp_valid || stamp.notification || stamp.postfx || stamp.debug || memcmp(&stamp, &ui_stamp, sizeof(stamp)) != 0;
+			ui_stamp = stamp;
+			ui_stamp_valid = true;
+			if (ui_changed) {
+				draw_clear(ui_fbp, 0x00000000u);
+			}
 		}
-		if (show_fps) {
-			char fps_text[32];
-			snprintf(fps_text, sizeof(fps_text), "FPS: %d", fps);
-			int w = font_measure_text_width(&ui_font, fps_text, 1.0f);
-			int x = fb.width - 8 - w;
-			int y = 8;
-			if (x < 0) {
-				x = 0;
+
+		if (ui_changed) {
+			weapon_view_draw(ui_fbp, &player, &texreg, &paths, ui_scale);
+			postfx_draw(&postfx, ui_fbp);
+			hud_draw(&hud, ui_fbp, &player, &gs, fps, &texreg, &paths);
+			if (show_debug) {
+				debug_overlay_draw(&ui_font, ui_fbp, &player, map_ok ? &map.world : NULL, &entities, &dynres, fps);
+			}
+			if (show_font_test) {
+				font_draw_test_page(&ui_font, ui_fbp, 16, 16);
+			}
+			if (show_fps) {
+				char fps_text[32];
+				snprintf(fps_text, sizeof(fps_text), "FPS: %d", fps);
+				int w = font_measure_text_width(&ui_font, fps_text, 1.0f);
+				int x = ui_fbp->width - 8 - w;
+				int y = 8;
+				if (x < 0) {
+					x = 0;
+				}
+				font_draw_text(&ui_font, ui_fbp, x, y, fps_text, color_from_abgr(0xFFFFFFFFu), 1.0f);
 			}
-			font_draw_text(&ui_font, &fb, x, y, fps_text, color_from_abgr(0xFFFFFFFFu), 1.0f);
+			notifications_draw(&notifications, ui_fbp, &ui_font, &texreg, &paths);
+			console_draw(&console, &ui_font, ui_fbp);
 		}
-		notifications_draw(&notifications, &fb, &ui_font, &texreg, &paths);
-		console_draw(&console, &ui_font, &fb);
-		if (cfg && cfg->render.vga_mode) {
-			vga_palette_apply(&fb);
+		// Single-layer frames get the VGA remap fused into the texture upload below. The
+		// UI layer is premultiplied and stays true color; only the world is remapped.
+		bool vga = cfg && cfg->render.vga_mode;
+		if (vga && ui_layer) {
+			vga_palette_apply(world_fb);
 		}
 		if (perf_trace_is_active(&perf)) {
 			ui_t1 = platform_time_seconds();
 			present_t0 = ui_t1;
 		}
 
-		present_frame(&presenter, &win, &fb);
+		if (ui_layer) {
+			present_frame_layers(&presenter, &win, world_fb, &ui_fb, ui_changed);
+		} else if (vga) {
+			present_frame_vga(&presenter, &win, frame_fb);
+		} else {
+			present_frame(&presenter, &win, frame_fb);
+		}
 		if (perf_trace_is_active(&perf)) {
 			present_t1 = platform_time_seconds();
 			double frame_t1 = present_t1;
@@ -2378,7 +2559,8 @@ int main(int argc, char** argv) {
 			pf.update_ms = (update_t1 - update_t0) * 1000.0;
 			pf.render3d_ms = (render3d_t1 - render3d_t0) * 1000.0;
 			pf.ui_ms = (ui_t1 - ui_t0) * 1000.0;
-			pf.present_ms = (present_t1 - present_t0) * 1000.0;
+			pf.present_ms = (present_t1 - present_t0) * 1000.0 + present_lock_ms;
+			pf.present_locked = presenter.stats_locked;
 			pf.steps = steps;
                         pf.pe_update_ms = pe_update_ms;
                         pf.p_tick_ms = p_tick_ms;
@@ -2389,18 +2571,48 @@ int main(int argc, char** argv) {
                         pf.pe_emitters_updated = (int)particle_emitters.stats_emitters_updated;
                         pf.pe_emitters_gated = (int)particle_emitters.stats_emitters_gated;
                         pf.pe_spawn_attempted = (int)particle_emitters.stats_particles_spawn_attempted;
+                        pf.pe_emitters_offscreen = (int)particle_emitters.stats_emitters_offscreen;
+                        pf.pe_fast_forwarded = (int)particle_emitters.stats_particles_fast_forwarded;
                         pf.p_alive = map_ok ? map.world.particles.alive_count : 0;
                         pf.p_capacity = map_ok ? map.world.particles.capacity : 0;
                         pf.p_spawned = map_ok ? (int)map.world.particles.stats_spawned : 0;
                         pf.p_dropped = map_ok ? (int)map.world.particles.stats_dropped : 0;
-                        pf.p_drawn_particles = map_ok ? (int)map.world.particles.stats_drawn_particles : 0;
-                        pf.p_pixels_written = map_ok ? (int)map.world.particles.stats_pixels_written : 0;
+                        pf.p_listed = map_ok ? (int)map.world.particles.stats_listed : 0;
+                        pf.p_drawn_particles = map_ok ? (int)compositor.stats_items_drawn[COMPOSITE_LAYER_PARTICLES] : 0;
+                        pf.p_early_rejected = map_ok ? (int)map.world.particles.stats_early_rejected : 0;
+                        pf.p_early_accepted = map_ok ? (int)map.world.particles.stats_early_accepted : 0;
+                        pf.p_pixels_written = map_ok ? (int)compositor.stats_pixels_written[COMPOSITE_LAYER_PARTICLES] : 0;
                         pf.g_alive = map_ok ? map.world.gore.alive_count : 0;
                         pf.g_capacity = map_ok ? map.world.gore.capacity : 0;
                         pf.g_spawned = map_ok ? (int)map.world.gore.stats_spawned : 0;
                         pf.g_dropped = map_ok ? (int)map.world.gore.stats_dropped : 0;
-                        pf.g_drawn_samples = map_ok ? (int)map.world.gore.stats_drawn_samples : 0;
-                        pf.g_pixels_written = map_ok ? (int)map.world.gore.stats_pixels_written : 0;
+                        pf.g_settled = map_ok ? (int)map.world.gore.stats_chunks_settled : 0;
+                        pf.g_baked = map_ok ? (int)map.world.gore.stats_baked : 0;
+                        pf.g_bake_failed = map_ok ? (int)map.world.gore.stats_bake_failed : 0;
+                        pf.g_decal_pages = map_ok ? map.world.floor_decals.page_count : 0;
+                        pf.g_decal_evicted = map_ok ? (int)map.world.floor_decals.evictions : 0;
+                        pf.g_decal_kb = map_ok ? (double)map.world.floor_decals.bytes / 1024.0 : 0.0;
+                        pf.g_drawn_samples = map_ok ? (int)compositor.stats_items_drawn[COMPOSITE_LAYER_GORE] : 0;
+                        pf.g_early_rejected = map_ok ? (int)map.world.gore.stats_early_rejected : 0;
+                        pf.g_early_accepted = map_ok ? (int)map.world.gore.stats_early_accepted : 0;
+                        pf.g_pixels_written = map_ok ? (int)compositor.stats_pixels_written[COMPOSITE_LAYER_GORE] : 0;
+                        pf.c_flush_ms = c_flush_ms;
+                        pf.c_items = map_ok ? (int)(compositor.stats_items[COMPOSITE_LAYER_GORE] + compositor.stats_items[COMPOSITE_LAYER_PARTICLES]) : 0;
+                        pf.c_tiles = map_ok ? (int)compositor.stats_tiles : 0;
+                        pf.c_threads = compositor.threads;
+                        pf.ic_hits = (int)image_cache.stats_hits;
+                        pf.ic_misses = (int)image_cache.stats_misses;
+                        pf.ic_evictions = (int)image_cache.stats_evictions;
+                        pf.ic_bypassed = (int)image_cache.stats_bypassed;
+                        pf.ic_used_kb = (int)(image_cache.used_bytes / 1024u);
+                        pf.ic_entries = image_cache.live;
+                        pf.dr_scale = dynres.scale;
+                        pf.dr_width = dynres.width;
+                        pf.dr_height = dynres.height;
+                        pf.dr_decision = (int)dynres.last_decision;
+                        pf.ui_layer = ui_layer;
+                        pf.ui_layer_uploaded = presenter.stats_ui_uploaded;
+                        pf.ui_layer_cpu_composite = presenter.stats_ui_cpu_composite;
                         pf.rc_planes_ms = rc_perf.planes_ms;
 			pf.rc_hit_test_ms = rc_perf.hit_test_ms;
 			pf.rc_walls_ms = rc_perf.walls_ms;
@@ -2422,6 +2634,8 @@ int main(int argc, char** argv) {
 			pf.rc_lighting_mul_calls = (int)rc_perf.lighting_mul_calls;
 			pf.rc_lighting_apply_light_iters = (int)rc_perf.lighting_apply_light_iters;
 			pf.rc_lighting_mul_light_iters = (int)rc_perf.lighting_mul_light_iters;
+			pf.rc_wall_light_lookups = (int)rc_perf.wall_light_lookups;
+			pf.rc_wall_light_unique = (int)rc_perf.wall_light_unique;
 			perf_trace_record_frame(&perf, &pf, stdout);
 		}
 	}
@@ -2457,10 +2671,18 @@ int main(int argc, char** argv) {
 	entity_defs_destroy(&entity_defs);
 
 	hud_system_shutdown(&hud);
+	raycast_shutdown();
 	texture_registry_destroy(&texreg);
 	level_mesh_destroy(&mesh);
 	free(wall_depth);
 	free(depth_pixels);
+	depth_spans_destroy(&depth_spans);
+	depth_pyramid_destroy(&depth_pyramid);
+	compositor_destroy(&compositor);
+	image_cache_destroy(&image_cache);
+	arena_destroy(&frame_arena);
+	dynres_destroy(&dynres);
+	framebuffer_destroy(&ui_fb);
 
 	present_shutdown(&presenter);
 	framebuffer_destroy(&fb);
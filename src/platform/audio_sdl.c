@@ -1,5 +1,7 @@
 #include "platform/audio.h"
 #include "core/log.h"
+#include "platform/sfx_mixer.h"
+#include "platform/sfx_stream.h"
 
 #include "game/tuning.h"
 
@@ -13,22 +15,29 @@
 
 // --- Internal types ---
 
+// A sample is either resident (int16 at the device rate, in its own channel count) or
+// streamed (only the path and WAV layout are kept; see platform/sfx_stream.h).
 typedef struct SfxSample {
 	bool alive;
 	uint16_t generation;
 	char filename[128];
-	float* frames_f32; // interleaved stereo float32
+	int16_t* frames_s16; // interleaved, `channels` per frame; NULL when streamed
 	uint32_t frame_count;
+	uint8_t channels;    // 1 or 2
+	char* path;          // streamed only (owned)
+	SfxWavInfo wav;      // streamed only
 } SfxSample;
 
+// Game-side view of a voice slot; playback state lives in the mixer (same index).
+// Handles are allocated here without locking: the callback only learns about them
+// through the command ring.
 typedef struct SfxVoice {
-	bool alive;
 	uint16_t generation;
 	uint32_t seq;
 	uint16_t sample_index;
-	uint32_t frame_pos;
-	float gain;
-	bool looping;
+	bool playing; // until stopped here or reported ended by the mixer
+	float gain;   // last value sent, to skip redundant commands
+	float pan;
 } SfxVoice;
 
 typedef struct SfxCore {
@@ -43,6 +52,13 @@ typedef struct SfxCore {
 	SfxSample samples[SFX_MAX_SAMPLES];
 	SfxVoice voices[SFX_MAX_VOICES];
 	uint32_t voice_seq;
+
+	// Game thread -> audio callback. Only the callback touches the mixer, except while
+	// the device is locked (ring overflow, shutdown).
+	SfxCommandRing commands;
+	SfxMixer mixer;
+	SfxStreamer streamer; // running only while the device is open
+	uint32_t stream_rejects; // plays of streamed samples that found no free slot
 } SfxCore;
 
 static SfxCore g_sfx;
@@ -101,9 +117,19 @@ static uint16_t sfx_find_free_sample_slot(void) {
 	return UINT16_MAX;
 }
 
+// Game-side liveness: a voice is live until stopped, or until the mixer reports that
+// this generation finished.
+static bool sfx_voice_is_live(uint16_t index) {
+	SfxVoice* v = &g_sfx.voices[index];
+	if (v->playing && sfx_mixer_voice_ended(&g_sfx.mixer, index, v->generation)) {
+		v->playing = false;
+	}
+	return v->playing;
+}
+
 static uint16_t sfx_find_free_voice_slot(void) {
 	for (uint16_t i = 0; i < (uint16_t)SFX_MAX_VOICES; i++) {
-		if (!g_sfx.voices[i].alive) {
+		if (!sfx_voice_is_live(i)) {
 			return i;
 		}
 	}
@@ -115,7 +141,7 @@ static uint16_t sfx_find_oldest_voice_slot(void) {
 	uint32_t best_seq = 0;
 	for (uint16_t i = 0; i < (uint16_t)SFX_MAX_VOICES; i++) {
 		SfxVoice* v = &g_sfx.voices[i];
-		if (!v->alive) {
+		if (!sfx_voice_is_live(i)) {
 			continue;
 		}
 		if (best == UINT16_MAX || v->seq < best_seq) {
@@ -126,6 +152,18 @@ static uint16_t sfx_find_oldest_voice_slot(void) {
 	return best;
 }
 
+// Queues a command for the callback. When the ring is full (the callback has not run
+// for a while), drains it here with the device locked, which keeps a single consumer.
+static void sfx_push_command(const SfxCommand* cmd) {
+	if (sfx_command_ring_push(&g_sfx.commands, cmd)) {
+		return;
+	}
+	SDL_LockAudioDevice(g_sfx.dev);
+	(void)sfx_mixer_drain(&g_sfx.mixer, &g_sfx.commands);
+	(void)sfx_command_ring_push(&g_sfx.commands, cmd);
+	SDL_UnlockAudioDevice(g_sfx.dev);
+}
+
 static void SDLCALL sfx_audio_callback(void* userdata, Uint8* stream, int len) {
 	(void)userdata;
 	if (!stream || len <= 0) {
@@ -139,62 +177,14 @@ static void SDLCALL sfx_audio_callback(void* userdata, Uint8* stream, int len) {
 	if (out_frames <= 0) {
 		return;
 	}
-	memset(out, 0, (size_t)len);
-
-	const float master = g_sfx.master_volume;
-	for (uint16_t vi = 0; vi < (uint16_t)SFX_MAX_VOICES; vi++) {
-		SfxVoice* v = &g_sfx.voices[vi];
-		if (!v->alive) {
-			continue;
-		}
-		if (v->sample_index >= (uint16_t)SFX_MAX_SAMPLES) {
-			v->alive = false;
-			continue;
-		}
-		SfxSample* s = &g_sfx.samples[v->sample_index];
-		if (!s->alive || !s->frames_f32 || s->frame_count == 0) {
-			v->alive = false;
-			continue;
-		}
-
-		float gain = clamp01(v->gain) * master;
-		if (gain <= 0.0001f) {
-			continue;
-		}
-
-		uint32_t pos = v->frame_pos;
-		for (int of = 0; of < out_frames; of++) {
-			if (pos >= s->frame_count) {
-				if (v->looping) {
-					pos = 0;
-				} else {
-					v->alive = false;
-					break;
-				}
-			}
-			const uint32_t si = pos * 2;
-			const uint32_t oi = (uint32_t)of * 2;
-			out[oi + 0] += s->frames_f32[si + 0] * gain;
-			out[oi + 1] += s->frames_f32[si + 1] * gain;
-			pos++;
-		}
-		v->frame_pos = pos;
-	}
-
-	// Clamp to avoid NaNs/overflows. Keep it simple.
-	for (int i = 0; i < out_floats; i++) {
-		float x = out[i];
-		if (x > 1.0f) {
-			x = 1.0f;
-		} else if (x < -1.0f) {
-			x = -1.0f;
-		}
-		out[i] = x;
-	}
+	(void)sfx_mixer_drain(&g_sfx.mixer, &g_sfx.commands);
+	sfx_mixer_mix(&g_sfx.mixer, out, out_frames, g_sfx.master_volume);
 }
 
 bool sfx_init(const AssetPaths* paths, bool enable_audio, int freq, int samples) {
 	memset(&g_sfx, 0, sizeof(g_sfx));
+	sfx_command_ring_init(&g_sfx.commands);
+	sfx_mixer_init(&g_sfx.mixer);
 	g_sfx.master_volume = 1.0f;
 	g_sfx.enabled = enable_audio;
 
@@ -237,6 +227,9 @@ bool sfx_init(const AssetPaths* paths, bool enable_audio, int freq, int samples)
 		return true; // non-fatal
 	}
 
+	if (!sfx_streamer_init(&g_sfx.streamer, g_sfx.have.freq)) {
+		log_warn("SFX streaming unavailable; long sounds will be loaded into memory");
+	}
 	SDL_PauseAudioDevice(g_sfx.dev, 0);
 	g_sfx.initialized = true;
 	return true;
@@ -248,21 +241,27 @@ void sfx_shutdown(void) {
 	}
 	if (g_sfx.dev != 0) {
 		SDL_LockAudioDevice(g_sfx.dev);
+		(void)sfx_mixer_drain(&g_sfx.mixer, &g_sfx.commands);
 		for (uint16_t i = 0; i < (uint16_t)SFX_MAX_VOICES; i++) {
-			g_sfx.voices[i].alive = false;
+			sfx_mixer_stop(&g_sfx.mixer, i);
 		}
 		SDL_UnlockAudioDevice(g_sfx.dev);
 		SDL_CloseAudioDevice(g_sfx.dev);
 		g_sfx.dev = 0;
 	}
+	// After the device: the mixer no longer reads the rings. Before the samples: the
+	// reader borrows their paths.
+	sfx_streamer_destroy(&g_sfx.streamer);
 
 	for (uint16_t i = 0; i < (uint16_t)SFX_MAX_SAMPLES; i++) {
 		SfxSample* s = &g_sfx.samples[i];
 		if (!s->alive) {
 			continue;
 		}
-		SDL_free(s->frames_f32);
-		s->frames_f32 = NULL;
+		SDL_free(s->frames_s16);
+		free(s->path);
+		s->frames_s16 = NULL;
+		s->path = NULL;
 		s->frame_count = 0;
 		s->alive = false;
 		s->generation++;
@@ -327,6 +326,22 @@ static SfxSampleId sfx_load_wav_impl(const char* assets_subdir, const char* cach
 		return sfx_make_sample_id(0, 0);
 	}
 
+	const int rate = g_sfx.have.freq ? g_sfx.have.freq : 48000;
+	SfxWavInfo wav;
+	if (g_sfx.streamer.running && sfx_wav_probe(full, &wav) && sfx_wav_streamable(&wav) && sfx_wav_decoded_bytes(&wav, rate) > (uint64_t)SFX_STREAM_MIN_BYTES) {
+		SfxSample* s = &g_sfx.samples[slot];
+		uint16_t gen = (uint16_t)(s->generation + 1u);
+		memset(s, 0, sizeof(*s));
+		s->alive = true;
+		s->generation = gen;
+		strncpy(s->filename, key, sizeof(s->filename) - 1);
+		s->filename[sizeof(s->filename) - 1] = '\0';
+		s->channels = wav.channels >= 2u ? 2u : 1u;
+		s->path = full;
+		s->wav = wav;
+		return sfx_make_sample_id(slot, s->generation);
+	}
+
 	SDL_AudioSpec src;
 	SDL_zero(src);
 	Uint8* src_buf = NULL;
@@ -338,11 +353,12 @@ static SfxSampleId sfx_load_wav_impl(const char* assets_subdir, const char* cach
 	}
 	free(full);
 
+	// Keep mono sources mono: the mixer feeds a mono frame to both channels.
 	SDL_AudioSpec dst;
 	SDL_zero(dst);
-	dst.freq = g_sfx.have.freq ? g_sfx.have.freq : 48000;
-	dst.format = AUDIO_F32;
-	dst.channels = 2;
+	dst.freq = rate;
+	dst.format = AUDIO_S16SYS;
+	dst.channels = src.channels >= 2 ? 2 : 1;
 
 	SDL_AudioCVT cvt;
 	if (SDL_BuildAudioCVT(&cvt, src.format, src.channels, src.freq, dst.format, dst.channels, dst.freq) < 0) {
@@ -367,12 +383,16 @@ static SfxSampleId sfx_load_wav_impl(const char* assets_subdir, const char* cach
 	}
 	SDL_FreeWAV(src_buf);
 
-	const uint32_t float_count = (uint32_t)(cvt.len_cvt / (int)sizeof(float));
-	const uint32_t frame_count = float_count / 2u;
+	const uint32_t frame_count = (uint32_t)(cvt.len_cvt / (int)(sizeof(int16_t) * dst.channels));
 	if (frame_count == 0) {
 		SDL_free(cvt.buf);
 		return sfx_make_sample_id(0, 0);
 	}
+	// The conversion buffer is sized for the worst intermediate step; keep only the result.
+	int16_t* frames = (int16_t*)SDL_realloc(cvt.buf, (size_t)frame_count * dst.channels * sizeof(int16_t));
+	if (!frames) {
+		frames = (int16_t*)cvt.buf;
+	}
 
 	SfxSample* s = &g_sfx.samples[slot];
 	uint16_t gen = (uint16_t)(s->generation + 1u);
@@ -381,8 +401,9 @@ static SfxSampleId sfx_load_wav_impl(const char* assets_subdir, const char* cach
 	s->generation = gen;
 	strncpy(s->filename, key, sizeof(s->filename) - 1);
 	s->filename[sizeof(s->filename) - 1] = '\0';
-	s->frames_f32 = (float*)cvt.buf;
+	s->frames_s16 = frames;
 	s->frame_count = frame_count;
+	s->channels = dst.channels;
 
 	return sfx_make_sample_id(slot, s->generation);
 }
@@ -403,57 +424,139 @@ SfxVoiceId sfx_play(SfxSampleId sample, float gain, bool looping) {
 		return sfx_make_voice_id(0, 0);
 	}
 
-	SDL_LockAudioDevice(g_sfx.dev);
 	uint16_t slot = sfx_find_free_voice_slot();
 	if (slot == UINT16_MAX) {
 		slot = sfx_find_oldest_voice_slot();
 	}
 	if (slot == UINT16_MAX) {
-		SDL_UnlockAudioDevice(g_sfx.dev);
 		return sfx_make_voice_id(0, 0);
 	}
 
+	SfxMixSource src;
+	memset(&src, 0, sizeof(src));
+	src.channels = s->channels;
+	if (s->path) {
+		src.stream = sfx_streamer_open(&g_sfx.streamer, s->path, &s->wav, s->channels, looping, &src.session);
+		if (!src.stream) {
+			g_sfx.stream_rejects++;
+			return sfx_make_voice_id(0, 0);
+		}
+	} else {
+		src.frames = s->frames_s16;
+		src.frame_count = s->frame_count;
+	}
+
 	SfxVoice* v = &g_sfx.voices[slot];
-	uint16_t gen = (uint16_t)(v->generation + 1u);
-	memset(v, 0, sizeof(*v));
-	v->alive = true;
-	v->generation = gen;
+	v->generation = (uint16_t)(v->generation + 1u);
 	v->seq = ++g_sfx.voice_seq;
 	v->sample_index = sample.index;
-	v->frame_pos = 0;
+	v->playing = true;
 	v->gain = clamp01(gain);
-	v->looping = looping;
-	SfxVoiceId out = sfx_make_voice_id(slot, v->generation);
-	SDL_UnlockAudioDevice(g_sfx.dev);
-	return out;
+	v->pan = 0.0f;
+
+	SfxCommand cmd;
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.kind = SFX_CMD_PLAY;
+	cmd.looping = looping;
+	cmd.voice = slot;
+	cmd.generation = v->generation;
+	cmd.value = v->gain;
+	cmd.src = src;
+	sfx_push_command(&cmd);
+	return sfx_make_voice_id(slot, v->generation);
 }
 
-void sfx_voice_set_gain(SfxVoiceId voice, float gain) {
+// Game-side voice for `voice`, or NULL when the handle is invalid, stale or finished.
+static SfxVoice* sfx_live_voice(SfxVoiceId voice) {
 	if (!g_sfx.initialized || !g_sfx.enabled || !sfx_id_is_valid_voice(voice)) {
-		return;
+		return NULL;
 	}
 	if (g_sfx.dev == 0 || voice.index >= (uint16_t)SFX_MAX_VOICES) {
-		return;
+		return NULL;
 	}
-	SDL_LockAudioDevice(g_sfx.dev);
 	SfxVoice* v = &g_sfx.voices[voice.index];
-	if (v->alive && v->generation == voice.generation) {
-		v->gain = clamp01(gain);
+	if (v->generation != voice.generation || !sfx_voice_is_live(voice.index)) {
+		return NULL;
 	}
-	SDL_UnlockAudioDevice(g_sfx.dev);
+	return v;
+}
+
+static void sfx_push_voice_command(SfxVoiceId voice, SfxCommandKind kind, float value) {
+	SfxCommand cmd;
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.kind = (uint8_t)kind;
+	cmd.voice = voice.index;
+	cmd.generation = voice.generation;
+	cmd.value = value;
+	sfx_push_command(&cmd);
+}
+
+void sfx_voice_set_gain(SfxVoiceId voice, float gain) {
+	SfxVoice* v = sfx_live_voice(voice);
+	if (!v) {
+		return;
+	}
+	gain = clamp01(gain);
+	if (gain == v->gain) {
+		return;
+	}
+	v->gain = gain;
+	sfx_push_voice_command(voice, SFX_CMD_SET_GAIN, gain);
+}
+
+void sfx_voice_set_pan(SfxVoiceId voice, float pan) {
+	SfxVoice* v = sfx_live_voice(voice);
+	if (!v) {
+		return;
+	}
+	pan = pan < -1.0f ? -1.0f : (pan > 1.0f ? 1.0f : pan);
+	if (pan == v->pan) {
+		return;
+	}
+	v->pan = pan;
+	sfx_push_voice_command(voice, SFX_CMD_SET_PAN, pan);
 }
 
 void sfx_voice_stop(SfxVoiceId voice) {
-	if (!g_sfx.initialized || !g_sfx.enabled || !sfx_id_is_valid_voice(voice)) {
+	SfxVoice* v = sfx_live_voice(voice);
+	if (!v) {
 		return;
 	}
-	if (g_sfx.dev == 0 || voice.index >= (uint16_t)SFX_MAX_VOICES) {
+	v->playing = false;
+	sfx_push_voice_command(voice, SFX_CMD_STOP, 0.0f);
+}
+
+void sfx_get_memory_stats(SfxMemoryStats* out) {
+	if (!out) {
 		return;
 	}
-	SDL_LockAudioDevice(g_sfx.dev);
-	SfxVoice* v = &g_sfx.voices[voice.index];
-	if (v->alive && v->generation == voice.generation) {
-		v->alive = false;
+	memset(out, 0, sizeof(*out));
+	if (!g_sfx.initialized) {
+		return;
 	}
-	SDL_UnlockAudioDevice(g_sfx.dev);
+	for (uint16_t i = 0; i < (uint16_t)SFX_MAX_SAMPLES; i++) {
+		const SfxSample* s = &g_sfx.samples[i];
+		if (!s->alive) {
+			continue;
+		}
+		if (s->path) {
+			out->streamed_samples++;
+			out->streamed_source_bytes += s->wav.data_bytes;
+		} else {
+			out->resident_samples++;
+			out->resident_bytes += (size_t)s->frame_count * s->channels * sizeof(int16_t);
+			out->resident_float_bytes += (size_t)s->frame_count * 2u * sizeof(float);
+		}
+	}
+	for (uint16_t i = 0; i < (uint16_t)SFX_MAX_VOICES; i++) {
+		out->voices_playing += sfx_voice_is_live(i) ? 1 : 0;
+	}
+	out->voice_slots = SFX_MAX_VOICES;
+	if (g_sfx.streamer.running) {
+		out->stream_buffer_bytes = g_sfx.streamer.ring_bytes;
+		out->stream_slots = SFX_MAX_STREAMS;
+		out->streams_active = sfx_streamer_active(&g_sfx.streamer);
+		out->stream_underruns = sfx_streamer_underruns(&g_sfx.streamer);
+	}
+	out->stream_rejects = g_sfx.stream_rejects;
 }
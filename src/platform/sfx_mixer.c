@@ -0,0 +1,358 @@
+#include "platform/sfx_mixer.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define MORTUM_SFX_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#define MORTUM_SFX_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Below this effective gain a voice is inaudible and only its position advances.
+static const float SFX_MIX_SILENT_GAIN = 0.0001f;
+
+// int16 full scale; folded into the gains so the kernels do one multiply per sample.
+static const float SFX_MIX_S16_SCALE = 1.0f / 32768.0f;
+
+void sfx_mix_madd_s16_stereo(float* dst, const int16_t* src, int frames, float gain_l, float gain_r) {
+	gain_l *= SFX_MIX_S16_SCALE;
+	gain_r *= SFX_MIX_S16_SCALE;
+	int n = frames * 2;
+	int i = 0;
+#if MORTUM_SFX_SSE2
+	__m128 g = _mm_setr_ps(gain_l, gain_r, gain_l, gain_r);
+	for (; i + 8 <= n; i += 8) {
+		__m128i s = _mm_loadu_si128((const __m128i*)(const void*)(src + i));
+		// Sign-extend by unpacking each sample into the high half and shifting it back.
+		__m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+		__m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+		_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(lo, g)));
+		_mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(hi, g)));
+	}
+#elif MORTUM_SFX_NEON
+	const float gains[4] = {gain_l, gain_r, gain_l, gain_r};
+	float32x4_t g = vld1q_f32(gains);
+	for (; i + 8 <= n; i += 8) {
+		int16x8_t s = vld1q_s16(src + i);
+		float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+		float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+		// Separate multiply and add so results match the scalar tail exactly.
+		vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vmulq_f32(lo, g)));
+		vst1q_f32(dst + i + 4, vaddq_f32(vld1q_f32(dst + i + 4), vmulq_f32(hi, g)));
+	}
+#endif
+	for (; i < n; i += 2) {
+		dst[i] += (float)src[i] * gain_l;
+		dst[i + 1] += (float)src[i + 1] * gain_r;
+	}
+}
+
+void sfx_mix_madd_s16_mono(float* dst, const int16_t* src, int frames, float gain_l, float gain_r) {
+	gain_l *= SFX_MIX_S16_SCALE;
+	gain_r *= SFX_MIX_S16_SCALE;
+	int i = 0;
+#if MORTUM_SFX_SSE2
+	__m128 g = _mm_setr_ps(gain_l, gain_r, gain_l, gain_r);
+	for (; i + 4 <= frames; i += 4) {
+		__m128i s = _mm_loadl_epi64((const __m128i*)(const void*)(src + i));
+		__m128 v = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+		// (a b c d) -> (a a b b), (c c d d): one source sample per output frame.
+		__m128 lo = _mm_unpacklo_ps(v, v);
+		__m128 hi = _mm_unpackhi_ps(v, v);
+		float* d = dst + (size_t)i * 2u;
+		_mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), _mm_mul_ps(lo, g)));
+		_mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), _mm_mul_ps(hi, g)));
+	}
+#elif MORTUM_SFX_NEON
+	const float gains[4] = {gain_l, gain_r, gain_l, gain_r};
+	float32x4_t g = vld1q_f32(gains);
+	for (; i + 4 <= frames; i += 4) {
+		float32x4_t v = vcvtq_f32_s32(vmovl_s16(vld1_s16(src + i)));
+		float32x4x2_t z = vzipq_f32(v, v);
+		float* d = dst + (size_t)i * 2u;
+		vst1q_f32(d, vaddq_f32(vld1q_f32(d), vmulq_f32(z.val[0], g)));
+		vst1q_f32(d + 4, vaddq_f32(vld1q_f32(d + 4), vmulq_f32(z.val[1], g)));
+	}
+#endif
+	for (; i < frames; i++) {
+		float x = (float)src[i];
+		dst[i * 2] += x * gain_l;
+		dst[i * 2 + 1] += x * gain_r;
+	}
+}
+
+static void sfx_mix_madd_s16(float* dst, const int16_t* src, uint8_t channels, int frames, float gain_l, float gain_r) {
+	if (channels == 1u) {
+		sfx_mix_madd_s16_mono(dst, src, frames, gain_l, gain_r);
+	} else {
+		sfx_mix_madd_s16_stereo(dst, src, frames, gain_l, gain_r);
+	}
+}
+
+void sfx_mix_clamp_f32(float* dst, int n) {
+	int i = 0;
+#if MORTUM_SFX_SSE2
+	__m128 lo = _mm_set1_ps(-1.0f);
+	__m128 hi = _mm_set1_ps(1.0f);
+	for (; i + 4 <= n; i += 4) {
+		_mm_storeu_ps(dst + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(dst + i), lo), hi));
+	}
+#elif MORTUM_SFX_NEON
+	float32x4_t lo = vdupq_n_f32(-1.0f);
+	float32x4_t hi = vdupq_n_f32(1.0f);
+	for (; i + 4 <= n; i += 4) {
+		vst1q_f32(dst + i, vminq_f32(vmaxq_f32(vld1q_f32(dst + i), lo), hi));
+	}
+#endif
+	for (; i < n; i++) {
+		float x = dst[i];
+		if (x > 1.0f) {
+			x = 1.0f;
+		} else if (x < -1.0f) {
+			x = -1.0f;
+		}
+		dst[i] = x;
+	}
+}
+
+void sfx_command_ring_init(SfxCommandRing* self) {
+	memset(self->items, 0, sizeof(self->items));
+	atomic_init(&self->head, 0u);
+	atomic_init(&self->tail, 0u);
+}
+
+bool sfx_command_ring_push(SfxCommandRing* self, const SfxCommand* cmd) {
+	unsigned head = atomic_load_explicit(&self->head, memory_order_relaxed);
+	unsigned tail = atomic_load_explicit(&self->tail, memory_order_acquire);
+	if (head - tail >= (unsigned)SFX_COMMAND_RING_SIZE) {
+		return false;
+	}
+	self->items[head & (SFX_COMMAND_RING_SIZE - 1u)] = *cmd;
+	atomic_store_explicit(&self->head, head + 1u, memory_order_release);
+	return true;
+}
+
+bool sfx_command_ring_pop(SfxCommandRing* self, SfxCommand* out) {
+	unsigned tail = atomic_load_explicit(&self->tail, memory_order_relaxed);
+	unsigned head = atomic_load_explicit(&self->head, memory_order_acquire);
+	if (tail == head) {
+		return false;
+	}
+	*out = self->items[tail & (SFX_COMMAND_RING_SIZE - 1u)];
+	atomic_store_explicit(&self->tail, tail + 1u, memory_order_release);
+	return true;
+}
+
+void sfx_mixer_init(SfxMixer* self) {
+	memset(self, 0, sizeof(*self));
+	for (int i = 0; i < SFX_MAX_VOICES; i++) {
+		atomic_init(&self->ended[i], 0u);
+	}
+}
+
+// Lets go of the voice's stream so the game thread may hand it to another playback.
+static void sfx_mixer_release_stream(SfxMixVoice* v) {
+	if (v->src.stream) {
+		atomic_store_explicit(&v->src.stream->in_use, false, memory_order_release);
+		v->src.stream = NULL;
+	}
+}
+
+static void sfx_mixer_unlink(SfxMixer* self, uint16_t voice) {
+	int slot = self->active_slot[voice];
+	uint16_t last = self->active[--self->active_count];
+	self->active[slot] = last;
+	self->active_slot[last] = (uint16_t)slot;
+	SfxMixVoice* v = &self->voices[voice];
+	sfx_mixer_release_stream(v);
+	v->src.frames = NULL;
+	v->live = false;
+	atomic_store_explicit(&self->ended[voice], v->generation, memory_order_release);
+}
+
+void sfx_mixer_start(SfxMixer* self, uint16_t voice, uint16_t generation, const SfxMixSource* src, float gain, bool looping) {
+	if (voice >= (uint16_t)SFX_MAX_VOICES) {
+		return;
+	}
+	SfxMixVoice* v = &self->voices[voice];
+	bool playable = src && (src->stream || (src->frames && src->frame_count > 0u)) && (src->channels == 1u || src->channels == 2u);
+	if (!playable) {
+		sfx_mixer_stop(self, voice);
+		if (src && src->stream) {
+			atomic_store_explicit(&src->stream->in_use, false, memory_order_release);
+		}
+		v->generation = generation;
+		atomic_store_explicit(&self->ended[voice], generation, memory_order_release);
+		return;
+	}
+	if (!v->live) {
+		self->active_slot[voice] = (uint16_t)self->active_count;
+		self->active[self->active_count++] = voice;
+	} else {
+		sfx_mixer_release_stream(v);
+	}
+	v->src = *src;
+	v->frame_pos = 0u;
+	v->gain = gain;
+	v->pan = 0.0f;
+	v->generation = generation;
+	v->looping = looping;
+	v->live = true;
+}
+
+void sfx_mixer_stop(SfxMixer* self, uint16_t voice) {
+	if (voice >= (uint16_t)SFX_MAX_VOICES || !self->voices[voice].live) {
+		return;
+	}
+	sfx_mixer_unlink(self, voice);
+}
+
+bool sfx_mixer_voice_active(const SfxMixer* self, uint16_t voice) {
+	return voice < (uint16_t)SFX_MAX_VOICES && self->voices[voice].live;
+}
+
+bool sfx_mixer_voice_ended(const SfxMixer* self, uint16_t voice, uint16_t generation) {
+	if (voice >= (uint16_t)SFX_MAX_VOICES) {
+		return true;
+	}
+	return atomic_load_explicit(&self->ended[voice], memory_order_acquire) == generation;
+}
+
+void sfx_mixer_apply(SfxMixer* self, const SfxCommand* cmd) {
+	if (cmd->voice >= (uint16_t)SFX_MAX_VOICES) {
+		return;
+	}
+	if (cmd->kind == SFX_CMD_PLAY) {
+		sfx_mixer_start(self, cmd->voice, cmd->generation, &cmd->src, cmd->value, cmd->looping);
+		return;
+	}
+	SfxMixVoice* v = &self->voices[cmd->voice];
+	if (!v->live || v->generation != cmd->generation) {
+		return;
+	}
+	switch ((SfxCommandKind)cmd->kind) {
+		case SFX_CMD_STOP:
+			sfx_mixer_unlink(self, cmd->voice);
+			break;
+		case SFX_CMD_SET_GAIN:
+			v->gain = cmd->value;
+			break;
+		case SFX_CMD_SET_PAN:
+			v->pan = cmd->value;
+			break;
+		default:
+			break;
+	}
+}
+
+int sfx_mixer_drain(SfxMixer* self, SfxCommandRing* ring) {
+	int n = 0;
+	SfxCommand cmd;
+	while (sfx_command_ring_pop(ring, &cmd)) {
+		sfx_mixer_apply(self, &cmd);
+		n++;
+	}
+	return n;
+}
+
+// Mixes up to `frames` frames from the voice's stream (consumed even when silent).
+// Returns false once a one-shot stream has delivered its last frame.
+static bool sfx_mixer_mix_stream(SfxMixVoice* v, float* out, int frames, float gain_l, float gain_r, bool audible) {
+	SfxStreamRing* r = v->src.stream;
+	if (atomic_load_explicit(&r->ready_session, memory_order_acquire) != v->src.session) {
+		return true; // the reader has not primed this session yet
+	}
+	// Read `finished` before write_pos: once it is set, write_pos is final.
+	bool finished = atomic_load_explicit(&r->finished_session, memory_order_acquire) == v->src.session;
+	uint32_t rd = atomic_load_explicit(&r->read_pos, memory_order_relaxed);
+	uint32_t wr = atomic_load_explicit(&r->write_pos, memory_order_acquire);
+	uint32_t n = wr - rd;
+	if (n > (uint32_t)frames) {
+		n = (uint32_t)frames;
+	}
+	if (audible) {
+		uint32_t done = 0;
+		while (done < n) {
+			uint32_t at = (rd + done) & (r->capacity - 1u);
+			uint32_t run = n - done;
+			if (run > r->capacity - at) {
+				run = r->capacity - at;
+			}
+			sfx_mix_madd_s16(out + (size_t)done * 2u, r->frames + (size_t)at * v->src.channels, v->src.channels, (int)run, gain_l, gain_r);
+			done += run;
+		}
+	}
+	atomic_store_explicit(&r->read_pos, rd + n, memory_order_release);
+	if (n < (uint32_t)frames) {
+		if (finished) {
+			return false;
+		}
+		atomic_fetch_add_explicit(&r->underruns, 1u, memory_order_relaxed);
+	}
+	return true;
+}
+
+// Mixes one voice into out[0 .. frames*2). Returns false when a one-shot voice ended.
+static bool sfx_mixer_mix_voice(SfxMixVoice* v, float* out, int frames, float gain) {
+	uint32_t pos = v->frame_pos;
+	// Balance pan: the far channel fades out, the near one stays at full gain.
+	float pan = v->pan < -1.0f ? -1.0f : (v->pan > 1.0f ? 1.0f : v->pan);
+	float gain_l = pan > 0.0f ? gain * (1.0f - pan) : gain;
+	float gain_r = pan < 0.0f ? gain * (1.0f + pan) : gain;
+	if (v->src.stream) {
+		return sfx_mixer_mix_stream(v, out, frames, gain_l, gain_r, gain > SFX_MIX_SILENT_GAIN);
+	}
+	if (gain <= SFX_MIX_SILENT_GAIN) {
+		uint64_t end = (uint64_t)pos + (uint64_t)frames;
+		if (end < v->src.frame_count) {
+			v->frame_pos = (uint32_t)end;
+			return true;
+		}
+		if (!v->looping) {
+			return false;
+		}
+		v->frame_pos = (uint32_t)(end % v->src.frame_count);
+		return true;
+	}
+	int done = 0;
+	while (done < frames) {
+		uint32_t left = v->src.frame_count - pos;
+		int n = frames - done;
+		if ((uint32_t)n > left) {
+			n = (int)left;
+		}
+		sfx_mix_madd_s16(out + (size_t)done * 2u, v->src.frames + (size_t)pos * v->src.channels, v->src.channels, n, gain_l, gain_r);
+		done += n;
+		pos += (uint32_t)n;
+		if (pos >= v->src.frame_count) {
+			if (!v->looping) {
+				return false;
+			}
+			pos = 0u;
+		}
+	}
+	v->frame_pos = pos;
+	return true;
+}
+
+void sfx_mixer_mix(SfxMixer* self, float* out, int frames, float master) {
+	if (!out || frames <= 0) {
+		return;
+	}
+	memset(out, 0, (size_t)frames * 2u * sizeof(float));
+	for (int i = 0; i < self->active_count;) {
+		uint16_t vi = self->active[i];
+		SfxMixVoice* v = &self->voices[vi];
+		float gain = v->gain < 0.0f ? 0.0f : (v->gain > 1.0f ? 1.0f : v->gain);
+		if (!sfx_mixer_mix_voice(v, out, frames, gain * master)) {
+			// The last live voice moves into slot i; mix it next.
+			sfx_mixer_unlink(self, vi);
+			continue;
+		}
+		i++;
+	}
+	sfx_mix_clamp_f32(out, frames * 2);
+}
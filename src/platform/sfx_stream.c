@@ -0,0 +1,378 @@
+#include "platform/sfx_stream.h"
+
+#include "core/log.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Source frames per file read.
+#define SFX_STREAM_READ_FRAMES 4096
+// Reader poll period while no session is posted; rings hold ~80x this much audio.
+#define SFX_STREAM_POLL_MS 4
+
+static uint16_t rd_u16(const uint8_t* p) {
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t rd_u32(const uint8_t* p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool sfx_wav_probe(const char* path, SfxWavInfo* out) {
+	memset(out, 0, sizeof(*out));
+	FILE* f = path ? fopen(path, "rb") : NULL;
+	if (!f) {
+		return false;
+	}
+	bool have_fmt = false;
+	bool have_data = false;
+	uint8_t hdr[12];
+	if (fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0) {
+		fclose(f);
+		return false;
+	}
+	long pos = 12;
+	uint8_t chunk[8];
+	while (!(have_fmt && have_data) && fread(chunk, 1, sizeof(chunk), f) == sizeof(chunk)) {
+		uint32_t size = rd_u32(chunk + 4);
+		pos += 8;
+		if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16u) {
+			uint8_t fmt[40];
+			size_t n = size < sizeof(fmt) ? size : sizeof(fmt);
+			if (fread(fmt, 1, n, f) != n) {
+				break;
+			}
+			out->format = rd_u16(fmt);
+			out->channels = rd_u16(fmt + 2);
+			out->rate = rd_u32(fmt + 4);
+			out->block_align = rd_u16(fmt + 12);
+			out->bits = rd_u16(fmt + 14);
+			if (out->format == 0xFFFEu && n >= 26u) {
+				out->format = rd_u16(fmt + 24); // sub-format GUID starts with the format tag
+			}
+			have_fmt = true;
+		} else if (memcmp(chunk, "data", 4) == 0) {
+			out->data_offset = (uint32_t)pos;
+			out->data_bytes = size;
+			have_data = true;
+		}
+		// Chunks are padded to an even size.
+		pos += (long)size + (long)(size & 1u);
+		if (fseek(f, pos, SEEK_SET) != 0) {
+			break;
+		}
+	}
+	// Clamp a data size that runs past the end of the file (truncated or streamed WAVs).
+	if (have_data && fseek(f, 0, SEEK_END) == 0) {
+		long end = ftell(f);
+		if (end >= 0 && (long)out->data_offset + (long)out->data_bytes > end) {
+			out->data_bytes = (long)out->data_offset <= end ? (uint32_t)(end - (long)out->data_offset) : 0u;
+		}
+	}
+	fclose(f);
+	return have_fmt && have_data;
+}
+
+// SDL format the reader feeds the converter for `info` (24-bit PCM is widened to 32).
+static SDL_AudioFormat sfx_wav_sdl_format(const SfxWavInfo* info) {
+	if (info->format == 1u) {
+		switch (info->bits) {
+			case 8:
+				return AUDIO_U8;
+			case 16:
+				return AUDIO_S16LSB;
+			case 24:
+			case 32:
+				return AUDIO_S32LSB;
+			default:
+				return 0;
+		}
+	}
+	if (info->format == 3u && info->bits == 32u) {
+		return AUDIO_F32LSB;
+	}
+	return 0;
+}
+
+bool sfx_wav_streamable(const SfxWavInfo* info) {
+	if (!info || (info->channels != 1u && info->channels != 2u) || info->rate == 0u) {
+		return false;
+	}
+	if ((uint32_t)info->block_align != (uint32_t)info->channels * (info->bits / 8u) || info->bits % 8u != 0u) {
+		return false;
+	}
+	return sfx_wav_sdl_format(info) != 0;
+}
+
+uint64_t sfx_wav_decoded_bytes(const SfxWavInfo* info, int rate) {
+	if (!info || info->block_align == 0u || info->rate == 0u || rate <= 0) {
+		return 0u;
+	}
+	uint64_t frames = (uint64_t)(info->data_bytes / info->block_align) * (uint64_t)rate / info->rate;
+	return frames * (info->channels >= 2u ? 2u : 1u) * sizeof(int16_t);
+}
+
+// --- Reader thread ---
+
+static void sfx_stream_close(SfxStreamCursor* c) {
+	if (c->file) {
+		fclose(c->file);
+		c->file = NULL;
+	}
+	if (c->convert) {
+		SDL_FreeAudioStream(c->convert);
+		c->convert = NULL;
+	}
+}
+
+// Ends the cursor's session: the mixer retires the voice once the ring is drained.
+static void sfx_stream_finish(SfxStreamSlot* s) {
+	sfx_stream_close(&s->cursor);
+	atomic_store_explicit(&s->ring.finished_session, s->cursor.session, memory_order_release);
+}
+
+// Hands the converter the next block of file data (rewinding loops). Returns false on a
+// read or conversion error.
+static bool sfx_stream_feed(SfxStreamer* self, SfxStreamCursor* c) {
+	if (c->data_left < c->info.block_align && c->looping && c->info.data_bytes >= c->info.block_align) {
+		if (fseek(c->file, (long)c->info.data_offset, SEEK_SET) != 0) {
+			return false;
+		}
+		c->data_left = c->info.data_bytes;
+	}
+	size_t want = (size_t)SFX_STREAM_READ_FRAMES * c->info.block_align;
+	if (want > c->data_left) {
+		want = c->data_left - c->data_left % c->info.block_align;
+	}
+	size_t got = want ? fread(self->read_buf, 1, want, c->file) : 0u;
+	got -= got % c->info.block_align;
+	if (got == 0u) {
+		// End of data (or a truncated file): let the converter emit what it holds.
+		c->flushed = true;
+		return SDL_AudioStreamFlush(c->convert) == 0;
+	}
+	c->data_left -= (uint32_t)got;
+	const void* src = self->read_buf;
+	size_t bytes = got;
+	if (c->info.format == 1u && c->info.bits == 24u) {
+		size_t samples = got / 3u;
+		for (size_t i = 0; i < samples; i++) {
+			const uint8_t* p = self->read_buf + i * 3u;
+			self->widen_buf[i] = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24));
+		}
+		src = self->widen_buf;
+		bytes = samples * sizeof(int32_t);
+	}
+	return SDL_AudioStreamPut(c->convert, src, (int)bytes) == 0;
+}
+
+// Tops up the slot's ring until it is full or the session's data is exhausted.
+static void sfx_stream_fill(SfxStreamer* self, SfxStreamSlot* s) {
+	SfxStreamCursor* c = &s->cursor;
+	SfxStreamRing* r = &s->ring;
+	const uint32_t frame_bytes = (uint32_t)c->channels * (uint32_t)sizeof(int16_t);
+	while (c->convert) {
+		uint32_t wr = atomic_load_explicit(&r->write_pos, memory_order_relaxed);
+		uint32_t rd = atomic_load_explicit(&r->read_pos, memory_order_acquire);
+		uint32_t space = r->capacity - (wr - rd);
+		if (space == 0u) {
+			return;
+		}
+		uint32_t at = wr & (r->capacity - 1u);
+		if (space > r->capacity - at) {
+			space = r->capacity - at;
+		}
+		int got = SDL_AudioStreamGet(c->convert, r->frames + (size_t)at * c->channels, (int)(space * frame_bytes));
+		if (got > 0) {
+			atomic_store_explicit(&r->write_pos, wr + (uint32_t)got / frame_bytes, memory_order_release);
+			continue;
+		}
+		if (got < 0 || c->flushed) {
+			sfx_stream_finish(s);
+			return;
+		}
+		if (!sfx_stream_feed(self, c)) {
+			log_warn("SFX stream read failed: %s", c->path);
+			sfx_stream_finish(s);
+			return;
+		}
+	}
+}
+
+// Resets the ring for the cursor's (new) session, reopens the file and primes the ring
+// before publishing the session, so a voice never starts on an empty ring.
+static void sfx_stream_restart(SfxStreamer* self, SfxStreamSlot* s) {
+	SfxStreamCursor* c = &s->cursor;
+	sfx_stream_close(c);
+	c->flushed = false;
+	c->data_left = c->info.data_bytes;
+	// Nobody reads the ring until ready_session names this session.
+	atomic_store_explicit(&s->ring.read_pos, 0u, memory_order_relaxed);
+	atomic_store_explicit(&s->ring.write_pos, 0u, memory_order_relaxed);
+	c->file = fopen(c->path, "rb");
+	if (c->file && fseek(c->file, (long)c->info.data_offset, SEEK_SET) == 0) {
+		c->convert = SDL_NewAudioStream(sfx_wav_sdl_format(&c->info), (Uint8)c->info.channels, (int)c->info.rate, AUDIO_S16SYS, c->channels, self->rate);
+	}
+	if (!c->convert) {
+		log_warn("SFX stream failed to open %s", c->path);
+		sfx_stream_finish(s);
+	} else {
+		sfx_stream_fill(self, s);
+	}
+	atomic_store_explicit(&s->ring.ready_session, c->session, memory_order_release);
+}
+
+static void* sfx_stream_thread(void* arg) {
+	SfxStreamer* self = (SfxStreamer*)arg;
+	for (;;) {
+		pthread_mutex_lock(&self->lock);
+		if (!self->pending && !self->quit) {
+			struct timespec until;
+			(void)timespec_get(&until, TIME_UTC);
+			until.tv_nsec += SFX_STREAM_POLL_MS * 1000000L;
+			if (until.tv_nsec >= 1000000000L) {
+				until.tv_sec++;
+				until.tv_nsec -= 1000000000L;
+			}
+			(void)pthread_cond_timedwait(&self->wake, &self->lock, &until);
+		}
+		if (self->quit) {
+			pthread_mutex_unlock(&self->lock);
+			break;
+		}
+		self->pending = false;
+		bool restart[SFX_MAX_STREAMS];
+		for (int i = 0; i < SFX_MAX_STREAMS; i++) {
+			SfxStreamSlot* s = &self->slots[i];
+			restart[i] = s->requested != s->cursor.session;
+			if (restart[i]) {
+				s->cursor.session = s->requested;
+				s->cursor.path = s->path;
+				s->cursor.info = s->info;
+				s->cursor.channels = s->channels;
+				s->cursor.looping = s->looping;
+			}
+		}
+		pthread_mutex_unlock(&self->lock);
+
+		for (int i = 0; i < SFX_MAX_STREAMS; i++) {
+			SfxStreamSlot* s = &self->slots[i];
+			if (restart[i]) {
+				sfx_stream_restart(self, s);
+			}
+			if (!atomic_load_explicit(&s->ring.in_use, memory_order_acquire)) {
+				sfx_stream_close(&s->cursor);
+				continue;
+			}
+			sfx_stream_fill(self, s);
+		}
+	}
+	return NULL;
+}
+
+// --- Public API ---
+
+bool sfx_streamer_init(SfxStreamer* self, int rate) {
+	memset(self, 0, sizeof(*self));
+	if (rate <= 0) {
+		return false;
+	}
+	self->rate = rate;
+	self->ring_bytes = (size_t)SFX_MAX_STREAMS * SFX_STREAM_RING_FRAMES * 2u * sizeof(int16_t);
+	self->ring_frames = (int16_t*)calloc(1, self->ring_bytes);
+	self->read_buf = (uint8_t*)malloc((size_t)SFX_STREAM_READ_FRAMES * 2u * 4u);
+	self->widen_buf = (int32_t*)malloc((size_t)SFX_STREAM_READ_FRAMES * 2u * sizeof(int32_t));
+	if (!self->ring_frames || !self->read_buf || !self->widen_buf) {
+		sfx_streamer_destroy(self);
+		return false;
+	}
+	for (int i = 0; i < SFX_MAX_STREAMS; i++) {
+		SfxStreamRing* r = &self->slots[i].ring;
+		r->frames = self->ring_frames + (size_t)i * SFX_STREAM_RING_FRAMES * 2u;
+		r->capacity = SFX_STREAM_RING_FRAMES;
+		atomic_init(&r->ready_session, 0u);
+		atomic_init(&r->finished_session, 0u);
+		atomic_init(&r->in_use, false);
+		atomic_init(&r->underruns, 0u);
+		atomic_init(&r->write_pos, 0u);
+		atomic_init(&r->read_pos, 0u);
+	}
+	pthread_mutex_init(&self->lock, NULL);
+	pthread_cond_init(&self->wake, NULL);
+	if (pthread_create(&self->thread, NULL, sfx_stream_thread, self) != 0) {
+		pthread_cond_destroy(&self->wake);
+		pthread_mutex_destroy(&self->lock);
+		sfx_streamer_destroy(self);
+		return false;
+	}
+	self->running = true;
+	return true;
+}
+
+void sfx_streamer_destroy(SfxStreamer* self) {
+	if (!self) {
+		return;
+	}
+	if (self->running) {
+		pthread_mutex_lock(&self->lock);
+		self->quit = true;
+		pthread_cond_signal(&self->wake);
+		pthread_mutex_unlock(&self->lock);
+		pthread_join(self->thread, NULL);
+		pthread_cond_destroy(&self->wake);
+		pthread_mutex_destroy(&self->lock);
+		for (int i = 0; i < SFX_MAX_STREAMS; i++) {
+			sfx_stream_close(&self->slots[i].cursor);
+		}
+	}
+	free(self->ring_frames);
+	free(self->read_buf);
+	free(self->widen_buf);
+	memset(self, 0, sizeof(*self));
+}
+
+SfxStreamRing* sfx_streamer_open(SfxStreamer* self, const char* path, const SfxWavInfo* info, uint8_t channels, bool looping, uint32_t* out_session) {
+	if (!self->running || !path || !info || (channels != 1u && channels != 2u)) {
+		return NULL;
+	}
+	for (int i = 0; i < SFX_MAX_STREAMS; i++) {
+		SfxStreamSlot* s = &self->slots[i];
+		// Only the mixer clears in_use, so an idle slot stays ours once claimed.
+		if (atomic_load_explicit(&s->ring.in_use, memory_order_acquire)) {
+			continue;
+		}
+		atomic_store_explicit(&s->ring.in_use, true, memory_order_release);
+		pthread_mutex_lock(&self->lock);
+		s->path = path;
+		s->info = *info;
+		s->channels = channels;
+		s->looping = looping;
+		s->requested++;
+		if (s->requested == 0u) {
+			s->requested = 1u; // 0 is the ring's initial "no session"
+		}
+		*out_session = s->requested;
+		self->pending = true;
+		pthread_cond_signal(&self->wake);
+		pthread_mutex_unlock(&self->lock);
+		return &s->ring;
+	}
+	return NULL;
+}
+
+int sfx_streamer_active(SfxStreamer* self) {
+	int n = 0;
+	for (int i = 0; self->running && i < SFX_MAX_STREAMS; i++) {
+		n += atomic_load_explicit(&self->slots[i].ring.in_use, memory_order_relaxed) ? 1 : 0;
+	}
+	return n;
+}
+
+uint32_t sfx_streamer_underruns(SfxStreamer* self) {
+	uint32_t n = 0;
+	for (int i = 0; self->running && i < SFX_MAX_STREAMS; i++) {
+		n += atomic_load_explicit(&self->slots[i].ring.underruns, memory_order_relaxed);
+	}
+	return n;
+}
@@ -0,0 +1,633 @@
+#include "render/compositor.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct CompositorThreadStats {
+	uint32_t pixels[COMPOSITE_LAYER_COUNT];
+} CompositorThreadStats;
+
+typedef struct CompositorWorkerArg {
+	CompositorWorkers* workers;
+	int slot; // stats slot
+} CompositorWorkerArg;
+
+struct CompositorWorkers {
+	pthread_mutex_t lock;
+	pthread_cond_t wake; // a job was posted (or quit)
+	pthread_cond_t done; // the last busy worker finished
+	unsigned generation; // bumped per posted job
+	int busy;            // workers still running the current job
+	bool quit;
+	int count; // worker threads (the calling thread is not one of them)
+	Compositor* owner;
+	atomic_int next_tile;
+	pthread_t threads[COMPOSITOR_MAX_THREADS];
+	CompositorWorkerArg args[COMPOSITOR_MAX_THREADS];
+	CompositorThreadStats stats[COMPOSITOR_MAX_THREADS]; // [0] is the calling thread
+};
+
+static inline float clampf(float v, float lo, float hi) {
+	if (v < lo) {
+		return lo;
+	}
+	if (v > hi) {
+		return hi;
+	}
+	return v;
+}
+
+static inline float lerpf(float a, float b, float t) {
+	return a + (b - a) * t;
+}
+
+static inline uint32_t pack_abgr_u8(uint8_t a, uint8_t b, uint8_t g, uint8_t r) {
+	return ((uint32_t)a << 24u) | ((uint32_t)b << 16u) | ((uint32_t)g << 8u) | (uint32_t)r;
+}
+
+static inline uint32_t blend_abgr8888_over(uint32_t src, uint32_t dst) {
+	uint32_t sa = (src >> 24u) & 0xFFu;
+	if (sa == 0u) {
+		return dst;
+	}
+	if (sa == 255u) {
+		return src;
+	}
+	uint32_t inv = 255u - sa;
+	uint32_t sb = (src >> 16u) & 0xFFu;
+	uint32_t sg = (src >> 8u) & 0xFFu;
+	uint32_t sr = src & 0xFFu;
+	uint32_t da = (dst >> 24u) & 0xFFu;
+	uint32_t db = (dst >> 16u) & 0xFFu;
+	uint32_t dg = (dst >> 8u) & 0xFFu;
+	uint32_t dr = dst & 0xFFu;
+	uint32_t oa = sa + (da * inv + 127u) / 255u;
+	uint32_t ob = (sb * sa + db * inv + 127u) / 255u;
+	uint32_t og = (sg * sa + dg * inv + 127u) / 255u;
+	uint32_t or_ = (sr * sa + dr * inv + 127u) / 255u;
+	return (oa << 24u) | (ob << 16u) | (og << 8u) | or_;
+}
+
+static inline uint32_t mul_alpha_u8(uint32_t abgr, uint8_t a_mul) {
+	uint32_t a = (abgr >> 24u) & 0xFFu;
+	a = (a * (uint32_t)a_mul + 127u) / 255u;
+	return (abgr & 0x00FFFFFFu) | (a << 24u);
+}
+
+static int resolve_threads(int threads) {
+	if (threads <= 0) {
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = n > 0 ? (int)n : 1;
+	}
+	return threads > COMPOSITOR_MAX_THREADS ? COMPOSITOR_MAX_THREADS : threads;
+}
+
+// Draws the part of `it` inside [rx0, rx1) x [ry0, ry1); returns pixels written.
+static uint32_t composite_item_raster(const Compositor* self, const CompositeItem* it, int rx0, int ry0, int rx1, int ry1) {
+	Framebuffer* fb = self->fb;
+	const float* wall_depth = self->wall_depth;
+	const float* depth_pixels = self->depth_pixels;
+	const DepthSpans* depth_spans = self->depth_spans;
+	float depth = it->depth;
+	float bias = it->depth_bias;
+	bool test_pixels = it->test_pixels && (depth_pixels || depth_spans);
+	const Texture* tex = it->tex;
+	int tex_w = tex ? tex->width : 0;
+	int tex_h = tex ? tex->height : 0;
+	bool rotate = it->rotate && (tex || it->shape == COMPOSITE_SHAPE_SQUARE);
+	// Texture already at the item's size and orientation: copy texels straight across.
+	bool blit = tex && !rotate && tex_w == it->w && tex_h == it->h;
+	// Plain square: every covered pixel takes the item color, no texture coordinates.
+	bool flat = !tex && !rotate && it->shape == COMPOSITE_SHAPE_SQUARE;
+	float cr = it->rot_cos;
+	float sr = it->rot_sin;
+	uint8_t out_a = (uint8_t)(it->color >> 24u);
+	uint8_t tint_r = (uint8_t)(it->color & 0xFFu);
+	uint8_t tint_g = (uint8_t)((it->color >> 8u) & 0xFFu);
+	uint8_t tint_b = (uint8_t)((it->color >> 16u) & 0xFFu);
+	float blend = it->tint_blend;
+	uint32_t written = 0u;
+
+	for (int x = rx0; x < rx1; x++) {
+		if (wall_depth && depth >= (wall_depth[x] + bias)) {
+			continue;
+		}
+		bool test_column = test_pixels;
+		if (test_pixels) {
+			DepthPyramidResult col = depth_pyramid_test_column(self->depth_pyramid, x, depth - bias);
+			if (col == DEPTH_PYRAMID_HIDDEN) {
+				continue;
+			}
+			test_column = col != DEPTH_PYRAMID_VISIBLE;
+		}
+		for (int y = ry0; y < ry1; y++) {
+			if (test_column) {
+				float world_depth = depth_pixels ? depth_pixels[y * fb->width + x] : depth_spans_depth_at(depth_spans, x, y);
+				if (depth >= (world_depth + bias)) {
+					continue;
+				}
+			}
+			if (it->shape == COMPOSITE_SHAPE_SOLID) {
+				fb->pixels[y * fb->width + x] = it->color;
+				written++;
+				continue;
+			}
+
+			uint32_t src_px = 0;
+			if (flat) {
+				src_px = it->color;
+			} else if (blit) {
+				// Pre-scaled image (render/image_cache.h): texels map 1:1 onto the rect.
+				src_px = tex->pixels[(y - it->y0) * tex_w + (x - it->x0)];
+			} else {
+				// Local coords in [-0.5,0.5] range.
+				float u = (float)(x - it->x0) / (float)(it->w - 1);
+				float v = (float)(y - it->y0) / (float)(it->h - 1);
+				u = clampf(u, 0.0f, 1.0f);
+				v = clampf(v, 0.0f, 1.0f);
+				float lx = (u - 0.5f);
+				float ly = (v - 0.5f);
+
+				// Apply rotation for squares/images; circles ignore rotation.
+				float ru = u;
+				float rv = v;
+				if (rotate) {
+					float rxu = lx * cr - ly * sr;
+					float ryu = lx * sr + ly * cr;
+					ru = rxu + 0.5f;
+					rv = ryu + 0.5f;
+					if (ru < 0.0f || ru > 1.0f || rv < 0.0f || rv > 1.0f) {
+						continue;
+					}
+				}
+
+				if (tex) {
+					// Nearest sample.
+					int sx = (int)(ru * (float)(tex_w - 1) + 0.5f);
+					int sy = (int)(rv * (float)(tex_h - 1) + 0.5f);
+					src_px = tex->pixels[sy * tex_w + sx];
+				} else {
+					if (it->shape == COMPOSITE_SHAPE_CIRCLE) {
+						float rr = lx * lx + ly * ly;
+						if (rr > 0.25f) {
+							continue;
+						}
+					}
+					// Shape item: ignore tint_blend, always full tint.
+					src_px = it->color;
+				}
+			}
+
+			if (tex) {
+				// Treat magenta as transparent for consistency with sprites.
+				if ((src_px & 0x00FFFFFFu) == 0x00FF00FFu) {
+					continue;
+				}
+				// Apply tint blend if requested.
+				if (blend > 0.0f) {
+					uint8_t sa = (src_px >> 24u) & 0xFFu;
+					uint8_t sb = (src_px >> 16u) & 0xFFu;
+					uint8_t sg = (src_px >> 8u) & 0xFFu;
+					uint8_t sr0 = src_px & 0xFFu;
+					uint8_t nr = (uint8_t)lroundf(lerpf((float)sr0, (float)tint_r, blend));
+					uint8_t ng = (uint8_t)lroundf(lerpf((float)sg, (float)tint_g, blend));
+					uint8_t nb = (uint8_t)lroundf(lerpf((float)sb, (float)tint_b, blend));
+					src_px = pack_abgr_u8(sa, nb, ng, nr);
+				}
+				// Apply item opacity.
+				src_px = mul_alpha_u8(src_px, out_a);
+				if (((src_px >> 24u) & 0xFFu) == 0u) {
+					continue;
+				}
+			}
+
+			uint32_t dst_px = fb->pixels[y * fb->width + x];
+			fb->pixels[y * fb->width + x] = blend_abgr8888_over(src_px, dst_px);
+			written++;
+		}
+	}
+	return written;
+}
+
+static void composite_tile(Compositor* self, int tile, CompositorThreadStats* st) {
+	int tx = tile % self->tiles_x;
+	int ty = tile / self->tiles_x;
+	int rx0 = tx << COMPOSITOR_TILE_SHIFT;
+	int ry0 = ty << COMPOSITOR_TILE_SHIFT;
+	int rx1 = rx0 + COMPOSITOR_TILE;
+	int ry1 = ry0 + COMPOSITOR_TILE;
+	for (int k = self->bin_start[tile]; k < self->bin_start[tile + 1]; k++) {
+		const CompositeItem* it = &self->items[self->bins[k]];
+		int x0 = it->clip_x0 > rx0 ? it->clip_x0 : rx0;
+		int y0 = it->clip_y0 > ry0 ? it->clip_y0 : ry0;
+		int x1 = it->clip_x1 < rx1 ? it->clip_x1 : rx1;
+		int y1 = it->clip_y1 < ry1 ? it->clip_y1 : ry1;
+		uint32_t n = composite_item_raster(self, it, x0, y0, x1, y1);
+		self->bin_drawn[k] = n > 0u;
+		st->pixels[it->layer] += n;
+	}
+}
+
+static void composite_run_tiles(Compositor* self, CompositorThreadStats* st) {
+	CompositorWorkers* w = self->workers;
+	int tiles = self->tiles_x * self->tiles_y;
+	for (;;) {
+		int t = atomic_fetch_add_explicit(&w->next_tile, 1, memory_order_relaxed);
+		if (t >= tiles) {
+			break;
+		}
+		if (self->bin_start[t] != self->bin_start[t + 1]) {
+			composite_tile(self, t, st);
+		}
+	}
+}
+
+static void* compositor_worker_main(void* arg) {
+	const CompositorWorkerArg* a = (const CompositorWorkerArg*)arg;
+	CompositorWorkers* w = a->workers;
+	unsigned seen = 0u;
+	for (;;) {
+		pthread_mutex_lock(&w->lock);
+		while (!w->quit && w->generation == seen) {
+			pthread_cond_wait(&w->wake, &w->lock);
+		}
+		if (w->quit) {
+			pthread_mutex_unlock(&w->lock);
+			break;
+		}
+		seen = w->generation;
+		pthread_mutex_unlock(&w->lock);
+
+		composite_run_tiles(w->owner, &w->stats[a->slot]);
+
+		pthread_mutex_lock(&w->lock);
+		if (--w->busy == 0) {
+			pthread_cond_signal(&w->done);
+		}
+		pthread_mutex_unlock(&w->lock);
+	}
+	return NULL;
+}
+
+static void compositor_stop_workers(Compositor* self) {
+	CompositorWorkers* w = self->workers;
+	if (!w) {
+		return;
+	}
+	pthread_mutex_lock(&w->lock);
+	w->quit = true;
+	pthread_cond_broadcast(&w->wake);
+	pthread_mutex_unlock(&w->lock);
+	for (int i = 0; i < w->count; i++) {
+		pthread_join(w->threads[i], NULL);
+	}
+	pthread_cond_destroy(&w->done);
+	pthread_cond_destroy(&w->wake);
+	pthread_mutex_destroy(&w->lock);
+	free(w);
+	self->workers = NULL;
+}
+
+static bool compositor_start_workers(Compositor* self, int count) {
+	CompositorWorkers* w = (CompositorWorkers*)calloc(1, sizeof(*w));
+	if (!w) {
+		return false;
+	}
+	pthread_mutex_init(&w->lock, NULL);
+	pthread_cond_init(&w->wake, NULL);
+	pthread_cond_init(&w->done, NULL);
+	atomic_init(&w->next_tile, 0);
+	w->owner = self;
+	self->workers = w;
+	for (int i = 0; i < count; i++) {
+		// Stats slot 0 belongs to the calling thread.
+		w->args[i].workers = w;
+		w->args[i].slot = i + 1;
+		if (pthread_create(&w->threads[i], NULL, compositor_worker_main, &w->args[i]) != 0) {
+			compositor_stop_workers(self);
+			return false;
+		}
+		w->count++;
+	}
+	return true;
+}
+
+// Replaces the worker pool with one for `n` threads (calling thread included).
+static bool compositor_restart_workers(Compositor* self, int n) {
+	compositor_stop_workers(self);
+	self->threads = 1;
+	if (n > 1) {
+		if (!compositor_start_workers(self, n - 1)) {
+			return false;
+		}
+		self->threads = n;
+	}
+	return true;
+}
+
+bool compositor_init(Compositor* self, int threads) {
+	if (!self) {
+		return false;
+	}
+	memset(self, 0, sizeof(*self));
+	self->threads = 1;
+	self->threads_requested = threads;
+	return compositor_restart_workers(self, resolve_threads(threads));
+}
+
+void compositor_destroy(Compositor* self) {
+	if (!self) {
+		return;
+	}
+	compositor_stop_workers(self);
+	free(self->items);
+	free(self->sorted);
+	free(self->drawn);
+	free(self->keys);
+	free(self->bins);
+	free(self->bin_drawn);
+	free(self->bin_start);
+	memset(self, 0, sizeof(*self));
+}
+
+bool compositor_set_threads(Compositor* self, int threads) {
+	if (!self) {
+		return false;
+	}
+	if (threads == self->threads_requested) {
+		return true;
+	}
+	self->threads_requested = threads;
+	int n = resolve_threads(threads);
+	if (n == self->threads) {
+		return true;
+	}
+	return compositor_restart_workers(self, n);
+}
+
+static void compositor_clear_stats(Compositor* self) {
+	memset(self->stats_items, 0, sizeof(self->stats_items));
+	memset(self->stats_items_drawn, 0, sizeof(self->stats_items_drawn));
+	memset(self->stats_pixels_written, 0, sizeof(self->stats_pixels_written));
+	self->stats_tiles = 0u;
+}
+
+void compositor_begin(
+	Compositor* self,
+	Framebuffer* fb,
+	const float* wall_depth,
+	const float* depth_pixels,
+	const DepthSpans* depth_spans,
+	const DepthPyramid* depth_pyramid) {
+	if (!self) {
+		return;
+	}
+	self->fb = fb;
+	self->wall_depth = wall_depth;
+	self->depth_pixels = depth_pixels;
+	self->depth_spans = depth_spans;
+	self->depth_pyramid = depth_pyramid;
+	self->item_count = 0;
+	self->ready = fb && fb->pixels && fb->width > 0 && fb->height > 0 && (wall_depth || depth_pixels || depth_spans);
+}
+
+CompositeItem* compositor_push(Compositor* self) {
+	if (!self || !self->ready) {
+		return NULL;
+	}
+	if (self->item_count >= self->item_cap) {
+		int cap = self->item_cap > 0 ? self->item_cap * 2 : 1024;
+		CompositeItem* items = (CompositeItem*)realloc(self->items, (size_t)cap * sizeof(CompositeItem));
+		if (!items) {
+			return NULL;
+		}
+		self->items = items;
+		CompositeItem* sorted = (CompositeItem*)realloc(self->sorted, (size_t)cap * sizeof(CompositeItem));
+		if (!sorted) {
+			return NULL;
+		}
+		self->sorted = sorted;
+		uint8_t* drawn = (uint8_t*)realloc(self->drawn, (size_t)cap);
+		if (!drawn) {
+			return NULL;
+		}
+		self->drawn = drawn;
+		self->item_cap = cap;
+	}
+	return &self->items[self->item_count++];
+}
+
+// Puts the items in stable back-to-front order: LSD radix sort of (key, index) pairs,
+// where the key is the inverted bit pattern of the depth (depths are positive, so their
+// IEEE bits order like the values), then one gather pass into the scratch array.
+static bool compositor_sort(Compositor* self) {
+	int n = self->item_count;
+	if (2 * n > self->keys_cap) {
+		uint64_t* keys = (uint64_t*)realloc(self->keys, (size_t)(2 * n) * sizeof(uint64_t));
+		if (!keys) {
+			return false;
+		}
+		self->keys = keys;
+		self->keys_cap = 2 * n;
+	}
+	uint64_t* src = self->keys;
+	uint64_t* dst = self->keys + n;
+	for (int i = 0; i < n; i++) {
+		uint32_t bits;
+		memcpy(&bits, &self->items[i].depth, sizeof(bits));
+		src[i] = ((uint64_t)~bits << 32u) | (uint64_t)(uint32_t)i;
+	}
+	for (int shift = 32; shift < 64; shift += 8) {
+		int count[257];
+		memset(count, 0, sizeof(count));
+		for (int i = 0; i < n; i++) {
+			count[((src[i] >> shift) & 0xFFu) + 1]++;
+		}
+		// All keys share this byte: the pass would not move anything.
+		bool trivial = false;
+		for (int b = 1; b <= 256; b++) {
+			if (count[b] == n) {
+				trivial = true;
+				break;
+			}
+		}
+		if (trivial) {
+			continue;
+		}
+		for (int b = 0; b < 256; b++) {
+			count[b + 1] += count[b];
+		}
+		for (int i = 0; i < n; i++) {
+			dst[count[(src[i] >> shift) & 0xFFu]++] = src[i];
+		}
+		uint64_t* t = src;
+		src = dst;
+		dst = t;
+	}
+	const int ahead = 16;
+	for (int k = 0; k < n; k++) {
+		if (k + ahead < n) {
+			// An item can straddle two cache lines.
+			const char* p = (const char*)&self->items[(uint32_t)src[k + ahead]];
+			__builtin_prefetch(p);
+			__builtin_prefetch(p + sizeof(CompositeItem) - 1);
+		}
+		self->sorted[k] = self->items[(uint32_t)src[k]];
+	}
+	CompositeItem* t = self->items;
+	self->items = self->sorted;
+	self->sorted = t;
+	return true;
+}
+
+// Tile-major lists of (sorted) item indices, each in order.
+static bool compositor_bin(Compositor* self) {
+	int n = self->item_count;
+	self->tiles_x = (self->fb->width + COMPOSITOR_TILE - 1) >> COMPOSITOR_TILE_SHIFT;
+	self->tiles_y = (self->fb->height + COMPOSITOR_TILE - 1) >> COMPOSITOR_TILE_SHIFT;
+	int tiles = self->tiles_x * self->tiles_y;
+	if (tiles + 1 > self->bin_start_cap) {
+		int* bs = (int*)realloc(self->bin_start, (size_t)(tiles + 1) * sizeof(int));
+		if (!bs) {
+			return false;
+		}
+		self->bin_start = bs;
+		self->bin_start_cap = tiles + 1;
+	}
+	int* start = self->bin_start;
+	memset(start, 0, (size_t)(tiles + 1) * sizeof(int));
+	for (int i = 0; i < n; i++) {
+		const CompositeItem* it = &self->items[i];
+		int tx0 = it->clip_x0 >> COMPOSITOR_TILE_SHIFT;
+		int tx1 = (it->clip_x1 - 1) >> COMPOSITOR_TILE_SHIFT;
+		int ty0 = it->clip_y0 >> COMPOSITOR_TILE_SHIFT;
+		int ty1 = (it->clip_y1 - 1) >> COMPOSITOR_TILE_SHIFT;
+		for (int ty = ty0; ty <= ty1; ty++) {
+			for (int tx = tx0; tx <= tx1; tx++) {
+				start[ty * self->tiles_x + tx + 1]++;
+			}
+		}
+	}
+	for (int t = 0; t < tiles; t++) {
+		start[t + 1] += start[t];
+	}
+	int total = start[tiles];
+	if (total > self->bins_cap) {
+		uint32_t* bins = (uint32_t*)realloc(self->bins, (size_t)total * sizeof(uint32_t));
+		if (!bins) {
+			return false;
+		}
+		self->bins = bins;
+		uint8_t* bd = (uint8_t*)realloc(self->bin_drawn, (size_t)total);
+		if (!bd) {
+			return false;
+		}
+		self->bin_drawn = bd;
+		self->bins_cap = total;
+	}
+	// Fill in item order, using start[t] as the cursor of tile t; afterwards start[t]
+	// holds the end of tile t, which the shift below turns back into its start.
+	for (int i = 0; i < n; i++) {
+		const CompositeItem* it = &self->items[i];
+		int tx0 = it->clip_x0 >> COMPOSITOR_TILE_SHIFT;
+		int tx1 = (it->clip_x1 - 1) >> COMPOSITOR_TILE_SHIFT;
+		int ty0 = it->clip_y0 >> COMPOSITOR_TILE_SHIFT;
+		int ty1 = (it->clip_y1 - 1) >> COMPOSITOR_TILE_SHIFT;
+		for (int ty = ty0; ty <= ty1; ty++) {
+			for (int tx = tx0; tx <= tx1; tx++) {
+				self->bins[start[ty * self->tiles_x + tx]++] = (uint32_t)i;
+			}
+		}
+	}
+	memmove(start + 1, start, (size_t)tiles * sizeof(int));
+	start[0] = 0;
+	return true;
+}
+
+static void compositor_flush_serial(Compositor* self) {
+	uint32_t pixels[COMPOSITE_LAYER_COUNT] = {0};
+	for (int i = 0; i < self->item_count; i++) {
+		const CompositeItem* it = &self->items[i];
+		uint32_t n = composite_item_raster(self, it, it->clip_x0, it->clip_y0, it->clip_x1, it->clip_y1);
+		self->drawn[i] = n > 0u;
+		pixels[it->layer] += n;
+	}
+	for (int l = 0; l < COMPOSITE_LAYER_COUNT; l++) {
+		self->stats_pixels_written[l] = pixels[l];
+	}
+}
+
+static void compositor_flush_tiled(Compositor* self) {
+	CompositorWorkers* w = self->workers;
+	memset(w->stats, 0, sizeof(w->stats));
+	atomic_store_explicit(&w->next_tile, 0, memory_order_relaxed);
+
+	pthread_mutex_lock(&w->lock);
+	w->busy = w->count;
+	w->generation++;
+	pthread_cond_broadcast(&w->wake);
+	pthread_mutex_unlock(&w->lock);
+
+	composite_run_tiles(self, &w->stats[0]);
+
+	pthread_mutex_lock(&w->lock);
+	while (w->busy > 0) {
+		pthread_cond_wait(&w->done, &w->lock);
+	}
+	pthread_mutex_unlock(&w->lock);
+
+	int tiles = self->tiles_x * self->tiles_y;
+	memset(self->drawn, 0, (size_t)self->item_count);
+	for (int k = 0; k < self->bin_start[tiles]; k++) {
+		if (self->bin_drawn[k]) {
+			self->drawn[self->bins[k]] = 1u;
+		}
+	}
+	uint32_t used = 0u;
+	for (int t = 0; t < tiles; t++) {
+		used += self->bin_start[t] != self->bin_start[t + 1] ? 1u : 0u;
+	}
+	self->stats_tiles = used;
+	for (int l = 0; l < COMPOSITE_LAYER_COUNT; l++) {
+		uint32_t sum = 0u;
+		for (int i = 0; i <= w->count; i++) {
+			sum += w->stats[i].pixels[l];
+		}
+		self->stats_pixels_written[l] = sum;
+	}
+}
+
+void compositor_flush(Compositor* self) {
+	if (!self) {
+		return;
+	}
+	compositor_clear_stats(self);
+	if (!self->ready || self->item_count == 0) {
+		self->ready = false;
+		self->item_count = 0;
+		return;
+	}
+	if (!compositor_sort(self)) {
+		self->ready = false;
+		self->item_count = 0;
+		return;
+	}
+	// Small frames are not worth waking the workers for; the serial pass draws the same
+	// sorted list.
+	if (self->workers && self->item_count >= COMPOSITOR_TILED_MIN_ITEMS && compositor_bin(self)) {
+		compositor_flush_tiled(self);
+	} else {
+		compositor_flush_serial(self);
+	}
+	for (int i = 0; i < self->item_count; i++) {
+		const CompositeItem* it = &self->items[i];
+		self->stats_items[it->layer]++;
+		self->stats_items_drawn[it->layer] += self->drawn[i];
+	}
+	self->ready = false;
+	self->item_count = 0;
+}
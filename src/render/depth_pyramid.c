@@ -0,0 +1,242 @@
+#include "render/depth_pyramid.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void depth_pyramid_init(DepthPyramid* self) {
+	memset(self, 0, sizeof(*self));
+}
+
+void depth_pyramid_destroy(DepthPyramid* self) {
+	if (!self) {
+		return;
+	}
+	free(self->tile_min);
+	free(self->tile_max);
+	free(self->col_min);
+	free(self->col_max);
+	memset(self, 0, sizeof(*self));
+}
+
+static bool grow_floats(float** p, int* cap, int n) {
+	if (n <= *cap) {
+		return true;
+	}
+	float* np = (float*)realloc(*p, (size_t)n * sizeof(float));
+	if (!np) {
+		return false;
+	}
+	*p = np;
+	*cap = n;
+	return true;
+}
+
+static bool depth_pyramid_reserve(DepthPyramid* self, int width, int height) {
+	int tiles_x = (width + DEPTH_PYRAMID_TILE - 1) >> DEPTH_PYRAMID_TILE_SHIFT;
+	int tiles_y = (height + DEPTH_PYRAMID_TILE - 1) >> DEPTH_PYRAMID_TILE_SHIFT;
+	int tile_cap = self->tile_cap;
+	if (!grow_floats(&self->tile_min, &tile_cap, tiles_x * tiles_y)) {
+		return false;
+	}
+	tile_cap = self->tile_cap;
+	if (!grow_floats(&self->tile_max, &tile_cap, tiles_x * tiles_y)) {
+		return false;
+	}
+	self->tile_cap = tile_cap;
+	int col_cap = self->col_cap;
+	if (!grow_floats(&self->col_min, &col_cap, width)) {
+		return false;
+	}
+	col_cap = self->col_cap;
+	if (!grow_floats(&self->col_max, &col_cap, width)) {
+		return false;
+	}
+	self->col_cap = col_cap;
+	self->width = width;
+	self->height = height;
+	self->tiles_x = tiles_x;
+	self->tiles_y = tiles_y;
+	return true;
+}
+
+// Folds a depth range covering rows [y0, y1) of column x into the column and into
+// every tile row the range touches.
+static void fold_rows(DepthPyramid* self, int x, int y0, int y1, float d_min, float d_max) {
+	y0 = y0 < 0 ? 0 : y0;
+	y1 = y1 > self->height ? self->height : y1;
+	if (y0 >= y1) {
+		return;
+	}
+	if (d_min < self->col_min[x]) {
+		self->col_min[x] = d_min;
+	}
+	if (d_max > self->col_max[x]) {
+		self->col_max[x] = d_max;
+	}
+	int tx = x >> DEPTH_PYRAMID_TILE_SHIFT;
+	for (int ty = y0 >> DEPTH_PYRAMID_TILE_SHIFT; ty <= (y1 - 1) >> DEPTH_PYRAMID_TILE_SHIFT; ty++) {
+		int t = ty * self->tiles_x + tx;
+		if (d_min < self->tile_min[t]) {
+			self->tile_min[t] = d_min;
+		}
+		if (d_max > self->tile_max[t]) {
+			self->tile_max[t] = d_max;
+		}
+	}
+}
+
+// Folds one column of spans without evaluating pixels. Inverse depth is linear in y, so
+// a span's depth range is set by its end rows. Where spans overlap, each contributes
+// its whole range, which can only widen [min, max]; both tests stay conservative. Rows
+// no span covers (and rows at or behind the horizon, inv <= 0) are sky: FAR.
+static void fold_spans_column(DepthPyramid* self, const DepthSpans* spans, int x) {
+	int covered = 0; // rows above this are covered by some span (spans are sorted by y0)
+	if (x < spans->width) {
+		for (int32_t i = spans->head[x]; i >= 0; i = spans->spans[i].next) {
+			const DepthSpan* sp = &spans->spans[i];
+			int y0 = sp->y0;
+			int y1 = sp->y1 < self->height ? sp->y1 : self->height;
+			if (y0 >= y1) {
+				continue;
+			}
+			float inv0 = sp->inv_a + sp->inv_b * (float)y0;
+			float inv1 = sp->inv_a + sp->inv_b * (float)(y1 - 1);
+			float inv_hi = inv0 > inv1 ? inv0 : inv1;
+			float inv_lo = inv0 > inv1 ? inv1 : inv0;
+			if (inv_hi <= 0.0f) {
+				continue; // no world depth on any of its rows
+			}
+			if (y0 > covered) {
+				fold_rows(self, x, covered, y0, DEPTH_SPANS_FAR, DEPTH_SPANS_FAR);
+			}
+			// Nudged outward so per-pixel rounding cannot fall outside the range.
+			float d_min = (1.0f / inv_hi) * (1.0f - 1e-6f);
+			float d_max = inv_lo > 0.0f ? (1.0f / inv_lo) * (1.0f + 1e-6f) : DEPTH_SPANS_FAR;
+			fold_rows(self, x, y0, y1, d_min, d_max);
+			if (y1 > covered) {
+				covered = y1;
+			}
+		}
+	}
+	if (covered < self->height) {
+		fold_rows(self, x, covered, self->height, DEPTH_SPANS_FAR, DEPTH_SPANS_FAR);
+	}
+}
+
+static void fold_pixel(DepthPyramid* self, int x, int y, float d) {
+	int t = (y >> DEPTH_PYRAMID_TILE_SHIFT) * self->tiles_x + (x >> DEPTH_PYRAMID_TILE_SHIFT);
+	if (d < self->tile_min[t]) {
+		self->tile_min[t] = d;
+	}
+	if (d > self->tile_max[t]) {
+		self->tile_max[t] = d;
+	}
+	if (d < self->col_min[x]) {
+		self->col_min[x] = d;
+	}
+	if (d > self->col_max[x]) {
+		self->col_max[x] = d;
+	}
+}
+
+bool depth_pyramid_build(DepthPyramid* self, int width, int height, const float* depth_pixels, const DepthSpans* spans) {
+	if (!self) {
+		return false;
+	}
+	self->valid = false;
+	if (width <= 0 || height <= 0 || (!depth_pixels && (!spans || !spans->head || spans->width <= 0))) {
+		return false;
+	}
+	if (!depth_pyramid_reserve(self, width, height)) {
+		return false;
+	}
+	int tiles = self->tiles_x * self->tiles_y;
+	for (int i = 0; i < tiles; i++) {
+		self->tile_min[i] = DEPTH_SPANS_FAR;
+		self->tile_max[i] = 0.0f;
+	}
+	for (int x = 0; x < width; x++) {
+		self->col_min[x] = DEPTH_SPANS_FAR;
+		self->col_max[x] = 0.0f;
+	}
+
+	if (depth_pixels) {
+		for (int y = 0; y < height; y++) {
+			const float* row = &depth_pixels[(size_t)y * (size_t)width];
+			for (int x = 0; x < width; x++) {
+				fold_pixel(self, x, y, row[x]);
+			}
+		}
+	} else {
+		for (int x = 0; x < width; x++) {
+			fold_spans_column(self, spans, x);
+		}
+	}
+	self->valid = true;
+	return true;
+}
+
+DepthPyramidResult depth_pyramid_test_rect(const DepthPyramid* self, int x0, int y0, int x1, int y1, float depth) {
+	if (!self || !self->valid) {
+		return DEPTH_PYRAMID_PARTIAL;
+	}
+	x0 = x0 < 0 ? 0 : x0;
+	y0 = y0 < 0 ? 0 : y0;
+	x1 = x1 > self->width ? self->width : x1;
+	y1 = y1 > self->height ? self->height : y1;
+	if (x0 >= x1 || y0 >= y1) {
+		return DEPTH_PYRAMID_HIDDEN;
+	}
+	int tx0 = x0 >> DEPTH_PYRAMID_TILE_SHIFT;
+	int ty0 = y0 >> DEPTH_PYRAMID_TILE_SHIFT;
+	int tx1 = (x1 - 1) >> DEPTH_PYRAMID_TILE_SHIFT;
+	int ty1 = (y1 - 1) >> DEPTH_PYRAMID_TILE_SHIFT;
+	bool hidden = true;
+	bool visible = true;
+	for (int ty = ty0; ty <= ty1; ty++) {
+		const float* tmin = &self->tile_min[ty * self->tiles_x];
+		const float* tmax = &self->tile_max[ty * self->tiles_x];
+		for (int tx = tx0; tx <= tx1; tx++) {
+			hidden = hidden && depth >= tmax[tx];
+			visible = visible && depth < tmin[tx];
+			if (!hidden && !visible) {
+				return DEPTH_PYRAMID_PARTIAL;
+			}
+		}
+	}
+	return hidden ? DEPTH_PYRAMID_HIDDEN : DEPTH_PYRAMID_VISIBLE;
+}
+
+DepthPyramidResult depth_pyramid_test_column(const DepthPyramid* self, int x, float depth) {
+	if (!self || !self->valid || x < 0 || x >= self->width) {
+		return DEPTH_PYRAMID_PARTIAL;
+	}
+	if (depth >= self->col_max[x]) {
+		return DEPTH_PYRAMID_HIDDEN;
+	}
+	if (depth < self->col_min[x]) {
+		return DEPTH_PYRAMID_VISIBLE;
+	}
+	return DEPTH_PYRAMID_PARTIAL;
+}
+
+void depth_pyramid_lower(DepthPyramid* self, int x, int y0, int y1, float depth) {
+	if (!self || !self->valid || x < 0 || x >= self->width) {
+		return;
+	}
+	y0 = y0 < 0 ? 0 : y0;
+	y1 = y1 > self->height ? self->height : y1;
+	if (y0 >= y1) {
+		return;
+	}
+	if (depth < self->col_min[x]) {
+		self->col_min[x] = depth;
+	}
+	int tx = x >> DEPTH_PYRAMID_TILE_SHIFT;
+	for (int ty = y0 >> DEPTH_PYRAMID_TILE_SHIFT; ty <= (y1 - 1) >> DEPTH_PYRAMID_TILE_SHIFT; ty++) {
+		float* tmin = &self->tile_min[ty * self->tiles_x + tx];
+		if (depth < *tmin) {
+			*tmin = depth;
+		}
+	}
+}
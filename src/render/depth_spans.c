@@ -0,0 +1,136 @@
+#include "render/depth_spans.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Initial pool size in spans per column; the pool grows on demand and is kept.
+#define DEPTH_SPANS_INITIAL_PER_COLUMN 8
+
+void depth_spans_init(DepthSpans* self) {
+	memset(self, 0, sizeof(*self));
+}
+
+void depth_spans_destroy(DepthSpans* self) {
+	if (!self) {
+		return;
+	}
+	free(self->head);
+	free(self->spans);
+	memset(self, 0, sizeof(*self));
+}
+
+bool depth_spans_begin(DepthSpans* self, int width, int height) {
+	if (!self) {
+		return false;
+	}
+	// Leave the set empty (no occlusion) if anything below fails.
+	self->width = 0;
+	self->height = 0;
+	self->count = 0;
+	self->dropped = 0u;
+	if (width <= 0 || height <= 0 || height > INT16_MAX) {
+		return false;
+	}
+	if (width > self->head_cap) {
+		int32_t* head = (int32_t*)realloc(self->head, (size_t)width * sizeof(int32_t));
+		if (!head) {
+			return false;
+		}
+		self->head = head;
+		self->head_cap = width;
+	}
+	if (!self->spans) {
+		int cap = width * DEPTH_SPANS_INITIAL_PER_COLUMN;
+		self->spans = (DepthSpan*)malloc((size_t)cap * sizeof(DepthSpan));
+		if (!self->spans) {
+			return false;
+		}
+		self->capacity = cap;
+	}
+	self->width = width;
+	self->height = height;
+	memset(self->head, 0xFF, (size_t)width * sizeof(int32_t));
+	return true;
+}
+
+static bool depth_spans_reserve_one(DepthSpans* self) {
+	if (self->count < self->capacity) {
+		return true;
+	}
+	int cap = self->capacity > 0 ? self->capacity * 2 : 1024;
+	DepthSpan* spans = (DepthSpan*)realloc(self->spans, (size_t)cap * sizeof(DepthSpan));
+	if (!spans) {
+		return false;
+	}
+	self->spans = spans;
+	self->capacity = cap;
+	return true;
+}
+
+void depth_spans_push_linear(DepthSpans* self, int x, int y0, int y1, float inv_a, float inv_b) {
+	if (!self || !self->head || x < 0 || x >= self->width) {
+		return;
+	}
+	if (y0 < 0) {
+		y0 = 0;
+	}
+	if (y1 > self->height) {
+		y1 = self->height;
+	}
+	if (y0 >= y1) {
+		return;
+	}
+	if (!depth_spans_reserve_one(self)) {
+		self->dropped++;
+		return;
+	}
+	int32_t idx = (int32_t)self->count++;
+	DepthSpan* s = &self->spans[idx];
+	s->inv_a = inv_a;
+	s->inv_b = inv_b;
+	s->y0 = (int16_t)y0;
+	s->y1 = (int16_t)y1;
+
+	// Keep the column sorted by y0 so queries can stop early.
+	int32_t* link = &self->head[x];
+	while (*link >= 0 && self->spans[*link].y0 <= y0) {
+		link = &self->spans[*link].next;
+	}
+	s->next = *link;
+	*link = idx;
+}
+
+void depth_spans_push_const(DepthSpans* self, int x, int y0, int y1, float depth) {
+	if (!(depth > 0.0f)) {
+		return;
+	}
+	depth_spans_push_linear(self, x, y0, y1, 1.0f / depth, 0.0f);
+}
+
+float depth_spans_depth_at(const DepthSpans* self, int x, int y) {
+	if (!self || !self->head || x < 0 || x >= self->width) {
+		return DEPTH_SPANS_FAR;
+	}
+	float best_inv = 0.0f;
+	for (int32_t i = self->head[x]; i >= 0;) {
+		const DepthSpan* s = &self->spans[i];
+		if (s->y0 > y) {
+			break;
+		}
+		if (y < s->y1) {
+			float inv = s->inv_a + s->inv_b * (float)y;
+			if (inv > best_inv) {
+				best_inv = inv;
+			}
+		}
+		i = s->next;
+	}
+	return best_inv > 0.0f ? 1.0f / best_inv : DEPTH_SPANS_FAR;
+}
+
+size_t depth_spans_bytes(const DepthSpans* self) {
+	if (!self) {
+		return 0;
+	}
+	return (size_t)self->head_cap * sizeof(int32_t) + (size_t)self->capacity * sizeof(DepthSpan);
+}
@@ -1,7 +1,12 @@
 #include "render/draw.h"
 
+#include "render/simd.h"
+
 #include <stddef.h>
 
+// Scaled alpha blits resample this many source pixels per SIMD blend call.
+#define BLIT_CHUNK 256
+
 static int clampi(int v, int lo, int hi) {
 	if (v < lo) {
 		return lo;
@@ -32,8 +37,6 @@ void draw_rect(Framebuffer* fb, int x, int y, int w, int h, uint32_t rgba) {
 	}
 }
 
-static inline uint32_t blend_abgr8888_over(uint32_t src, uint32_t dst);
-
 void draw_rect_abgr8888_alpha(Framebuffer* fb, int x, int y, int w, int h, uint32_t abgr) {
 	int x0 = clampi(x, 0, fb->width);
 	int y0 = clampi(y, 0, fb->height);
@@ -49,12 +52,9 @@ void draw_rect_abgr8888_alpha(Framebuffer* fb, int x, int y, int w, int h, uint3
 		return;
 	}
 
+	const SimdKernels* simd = simd_kernels();
 	for (int yy = y0; yy < y1; yy++) {
-		uint32_t* row = &fb->pixels[yy * fb->width + x0];
-		int count = x1 - x0;
-		for (int xx = 0; xx < count; xx++) {
-			row[xx] = blend_abgr8888_over(abgr, row[xx]);
-		}
+		simd->blend_const(&fb->pixels[yy * fb->width + x0], x1 - x0, abgr);
 	}
 }
 
@@ -121,31 +121,6 @@ void draw_blit_rgba8888(Framebuffer* fb, int dst_x, int dst_y, const uint32_t* s
 	}
 }
 
-static inline uint32_t blend_abgr8888_over(uint32_t src, uint32_t dst) {
-	unsigned a = (unsigned)(src >> 24) & 0xFFu;
-	if (a == 0u) {
-		return dst;
-	}
-	if (a == 255u) {
-		return src;
-	}
-
-	unsigned inv_a = 255u - a;
-	unsigned src_r = (unsigned)(src)&0xFFu;
-	unsigned src_g = (unsigned)(src >> 8) & 0xFFu;
-	unsigned src_b = (unsigned)(src >> 16) & 0xFFu;
-
-	unsigned dst_r = (unsigned)(dst)&0xFFu;
-	unsigned dst_g = (unsigned)(dst >> 8) & 0xFFu;
-	unsigned dst_b = (unsigned)(dst >> 16) & 0xFFu;
-
-	unsigned out_r = (src_r * a + dst_r * inv_a + 127u) / 255u;
-	unsigned out_g = (src_g * a + dst_g * inv_a + 127u) / 255u;
-	unsigned out_b = (src_b * a + dst_b * inv_a + 127u) / 255u;
-
-	return (0xFFu << 24) | (out_b << 16) | (out_g << 8) | out_r;
-}
-
 void draw_blit_abgr8888_alpha(Framebuffer* fb, int dst_x, int dst_y, const uint32_t* src_pixels, int src_w, int src_h) {
 	if (!src_pixels || src_w <= 0 || src_h <= 0) {
 		return;
@@ -164,14 +139,12 @@ void draw_blit_abgr8888_alpha(Framebuffer* fb, int dst_x, int dst_y, const uint3
 	int src_off_x = clip_x0 - x0;
 	int src_off_y = clip_y0 - y0;
 
+	const SimdKernels* simd = simd_kernels();
 	for (int y = clip_y0; y < clip_y1; y++) {
 		int sy = (y - clip_y0) + src_off_y;
 		const uint32_t* src_row = &src_pixels[sy * src_w + src_off_x];
 		uint32_t* dst_row = &fb->pixels[y * fb->width + clip_x0];
-		int count = clip_x1 - clip_x0;
-		for (int x = 0; x < count; x++) {
-			dst_row[x] = blend_abgr8888_over(src_row[x], dst_row[x]);
-		}
+		simd->blend_over(dst_row, src_row, clip_x1 - clip_x0);
 	}
 }
 
@@ -257,6 +230,8 @@ void draw_blit_abgr8888_scaled_nearest_alpha(
 	const int dst_off_x = x0 - dst_x;
 	const int dst_off_y = y0 - dst_y;
 
+	const SimdKernels* simd = simd_kernels();
+	uint32_t chunk[BLIT_CHUNK];
 	for (int dy = 0; dy < clipped_h; dy++) {
 		int dst_yi = y0 + dy;
 		int sy = (int)((int64_t)(dy + dst_off_y) * (int64_t)src_h / (int64_t)dst_h);
@@ -265,12 +240,16 @@ void draw_blit_abgr8888_scaled_nearest_alpha(
 		const uint32_t* src_row = src_pixels + (size_t)sy * (size_t)src_w;
 		uint32_t* dst_row = fb->pixels + (size_t)dst_yi * (size_t)fb->width;
 
-		for (int dx = 0; dx < clipped_w; dx++) {
-			int sx = (int)((int64_t)(dx + dst_off_x) * (int64_t)src_w / (int64_t)dst_w);
-			if (sx < 0) sx = 0;
-			if (sx >= src_w) sx = src_w - 1;
-			uint32_t src = src_row[sx];
-			dst_row[x0 + dx] = blend_abgr8888_over(src, dst_row[x0 + dx]);
+		// Resample a chunk of the source row, then blend it in one SIMD call.
+		for (int dx0 = 0; dx0 < clipped_w; dx0 += BLIT_CHUNK) {
+			int n = clipped_w - dx0 < BLIT_CHUNK ? clipped_w - dx0 : BLIT_CHUNK;
+			for (int i = 0; i < n; i++) {
+				int sx = (int)((int64_t)(dx0 + i + dst_off_x) * (int64_t)src_w / (int64_t)dst_w);
+				if (sx < 0) sx = 0;
+				if (sx >= src_w) sx = src_w - 1;
+				chunk[i] = src_row[sx];
+			}
+			simd->blend_over(dst_row + x0 + dx0, chunk, n);
 		}
 	}
 }
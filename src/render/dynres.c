@@ -0,0 +1,158 @@
+#include "render/dynres.h"
+
+#include "render/draw.h"
+
+#include <string.h>
+
+// Weight of the newest sample in the render3d moving average.
+#define DYNRES_AVG_ALPHA 0.1
+
+static float dynres_clamp_scale(const DynamicResolutionConfig* cfg, float s) {
+	float lo = cfg->min_scale;
+	float hi = cfg->max_scale > lo ? cfg->max_scale : lo;
+	if (s < lo) {
+		s = lo;
+	}
+	if (s > hi) {
+		s = hi;
+	}
+	return s;
+}
+
+void dynres_init(DynRes* self) {
+	memset(self, 0, sizeof(*self));
+	self->scale = 1.0f;
+	self->avg_ms = -1.0;
+}
+
+void dynres_destroy(DynRes* self) {
+	if (!self) {
+		return;
+	}
+	framebuffer_destroy(&self->scratch);
+	memset(self, 0, sizeof(*self));
+}
+
+Framebuffer* dynres_begin_frame(DynRes* self, const DynamicResolutionConfig* cfg, Framebuffer* fb) {
+	if (!self || !cfg || !fb) {
+		return fb;
+	}
+	int prev_w = self->width;
+	int prev_h = self->height;
+	if (!cfg->enabled) {
+		// Start from full resolution again the next time it is enabled.
+		self->scale = 1.0f;
+		self->avg_ms = -1.0;
+		self->cooldown = 0;
+		self->last_decision = DYNRES_HOLD;
+	} else {
+		self->scale = dynres_clamp_scale(cfg, self->scale);
+	}
+	self->width = fb->width;
+	self->height = fb->height;
+	float scale = cfg->enabled ? self->scale : 1.0f;
+	if (scale >= 1.0f) {
+		self->resized = self->width != prev_w || self->height != prev_h;
+		return fb;
+	}
+
+	int w = (int)((float)fb->width * scale + 0.5f);
+	int h = (int)((float)fb->height * scale + 0.5f);
+	w = w < 1 ? 1 : (w > fb->width ? fb->width : w);
+	h = h < 1 ? 1 : (h > fb->height ? fb->height : h);
+	if (w >= fb->width && h >= fb->height) {
+		self->resized = self->width != prev_w || self->height != prev_h;
+		return fb;
+	}
+	size_t need = (size_t)w * (size_t)h;
+	if (!self->scratch.pixels || need > self->scratch_cap) {
+		framebuffer_destroy(&self->scratch);
+		self->scratch_cap = 0;
+		if (!framebuffer_init(&self->scratch, w, h)) {
+			framebuffer_destroy(&self->scratch);
+			self->resized = self->width != prev_w || self->height != prev_h;
+			return fb;
+		}
+		self->scratch_cap = need;
+	}
+	// Reuse the allocation at any smaller size.
+	self->scratch.width = w;
+	self->scratch.height = h;
+	self->width = w;
+	self->height = h;
+	self->resized = w != prev_w || h != prev_h;
+	return &self->scratch;
+}
+
+void dynres_end_frame(DynRes* self, const Framebuffer* world_fb, Framebuffer* fb) {
+	(void)self;
+	if (!world_fb || !fb || world_fb == fb || !world_fb->pixels) {
+		return;
+	}
+	draw_blit_abgr8888_scaled_nearest(fb, 0, 0, fb->width, fb->height, world_fb->pixels, world_fb->width, world_fb->height);
+}
+
+DynResDecision dynres_update(DynRes* self, const DynamicResolutionConfig* cfg, double render3d_ms) {
+	if (!self || !cfg || !cfg->enabled || !(render3d_ms >= 0.0)) {
+		if (self) {
+			self->last_decision = DYNRES_HOLD;
+		}
+		return DYNRES_HOLD;
+	}
+	if (self->resized) {
+		// The first frame at a new size pays one-off rebuilds (sky strip, scratch
+		// buffer) that say nothing about the steady-state cost; keep it out of the average.
+	} else if (self->avg_ms < 0.0) {
+		self->avg_ms = render3d_ms;
+	} else {
+		self->avg_ms += (render3d_ms - self->avg_ms) * DYNRES_AVG_ALPHA;
+	}
+
+	DynResDecision d = DYNRES_HOLD;
+	if (self->cooldown > 0) {
+		self->cooldown--;
+	} else {
+		float step = cfg->step > 0.0f ? cfg->step : 0.125f;
+		float cur = self->scale;
+		float next = cur;
+		if (self->avg_ms > (double)cfg->target_ms) {
+			next = dynres_clamp_scale(cfg, cur - step);
+			d = next < cur ? DYNRES_DOWN : DYNRES_HOLD;
+		} else {
+			float up = dynres_clamp_scale(cfg, cur + step);
+			if (up > cur) {
+				double ratio = (double)up / (double)cur;
+				if (self->avg_ms * ratio * ratio < DYNRES_UP_HEADROOM * (double)cfg->target_ms) {
+					next = up;
+					d = DYNRES_UP;
+				}
+			}
+		}
+		if (d != DYNRES_HOLD) {
+			// Carry the average over to the new pixel count so the next decision does
+			// not wait for the filter to settle.
+			double ratio = (double)next / (double)cur;
+			self->avg_ms *= ratio * ratio;
+			self->scale = next;
+			self->cooldown = DYNRES_COOLDOWN_FRAMES;
+			if (d == DYNRES_DOWN) {
+				self->steps_down++;
+			} else {
+				self->steps_up++;
+			}
+		}
+	}
+	self->last_decision = d;
+	return d;
+}
+
+const char* dynres_decision_name(DynResDecision d) {
+	switch (d) {
+		case DYNRES_DOWN:
+			return "down";
+		case DYNRES_UP:
+			return "up";
+		default:
+			return "hold";
+	}
+}
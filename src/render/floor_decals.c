@@ -0,0 +1,221 @@
+#include "render/floor_decals.h"
+
+#include "game/world.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Largest page table a single sector may have (entries); bigger sectors get no decals.
+#define FLOOR_DECAL_MAX_TABLE (1 << 18)
+
+void floor_decals_init(FloorDecals* self) {
+	memset(self, 0, sizeof(*self));
+}
+
+void floor_decals_destroy(FloorDecals* self) {
+	if (!self) {
+		return;
+	}
+	for (int i = 0; i < self->sector_count; i++) {
+		free(self->sectors[i].pages);
+	}
+	free(self->sectors);
+	for (int i = 0; i < self->block_count; i++) {
+		free(self->blocks[i]);
+	}
+	free(self->blocks);
+	memset(self, 0, sizeof(*self));
+}
+
+// Creates the sector's (empty) page table on first use.
+static SectorFloorDecals* floor_decals_sector_table(FloorDecals* self, const World* world, int sector) {
+	if (!self->sectors) {
+		if (world->sector_count <= 0) {
+			return NULL;
+		}
+		self->sectors = (SectorFloorDecals*)calloc((size_t)world->sector_count, sizeof(SectorFloorDecals));
+		if (!self->sectors) {
+			return NULL;
+		}
+		self->sector_count = world->sector_count;
+		self->bytes += (size_t)self->sector_count * sizeof(SectorFloorDecals);
+	}
+	if ((unsigned)sector >= (unsigned)self->sector_count) {
+		return NULL;
+	}
+	SectorFloorDecals* sd = &self->sectors[sector];
+	if (sd->pages) {
+		return sd;
+	}
+	float min_x = 0.0f, min_y = 0.0f, max_x = 0.0f, max_y = 0.0f;
+	if (!world_sector_bounds(world, sector, &min_x, &min_y, &max_x, &max_y)) {
+		return NULL;
+	}
+	const float page_world = (float)FLOOR_DECAL_PAGE_DIM / (float)FLOOR_DECAL_TEXELS_PER_UNIT;
+	int pw = (int)ceilf((max_x - min_x) / page_world);
+	int ph = (int)ceilf((max_y - min_y) / page_world);
+	if (pw < 1) {
+		pw = 1;
+	}
+	if (ph < 1) {
+		ph = 1;
+	}
+	if ((long long)pw * (long long)ph > FLOOR_DECAL_MAX_TABLE) {
+		return NULL;
+	}
+	sd->pages = (uint32_t**)calloc((size_t)pw * (size_t)ph, sizeof(uint32_t*));
+	if (!sd->pages) {
+		return NULL;
+	}
+	sd->origin_x = min_x;
+	sd->origin_y = min_y;
+	sd->pages_w = pw;
+	sd->pages_h = ph;
+	self->bytes += (size_t)pw * (size_t)ph * sizeof(uint32_t*);
+	return sd;
+}
+
+// Hands out a zeroed atlas page, or NULL when the atlas is full.
+static uint32_t* floor_decals_alloc_page(FloorDecals* self) {
+	if (self->free_pages) {
+		uint32_t* page = self->free_pages;
+		memcpy(&self->free_pages, page, sizeof(uint32_t*));
+		memset(page, 0, (size_t)FLOOR_DECAL_PAGE_TEXELS * sizeof(uint32_t));
+		self->page_count++;
+		return page;
+	}
+	if (self->pages_carved >= FLOOR_DECAL_MAX_PAGES) {
+		return NULL;
+	}
+	int block = self->pages_carved / FLOOR_DECAL_BLOCK_PAGES;
+	if (block >= self->block_count) {
+		if (self->block_count == self->block_cap) {
+			int cap = self->block_cap ? self->block_cap * 2 : 8;
+			uint32_t** blocks = (uint32_t**)realloc(self->blocks, (size_t)cap * sizeof(uint32_t*));
+			if (!blocks) {
+				return NULL;
+			}
+			self->blocks = blocks;
+			self->block_cap = cap;
+		}
+		uint32_t* texels = (uint32_t*)calloc((size_t)FLOOR_DECAL_BLOCK_PAGES * FLOOR_DECAL_PAGE_TEXELS, sizeof(uint32_t));
+		if (!texels) {
+			return NULL;
+		}
+		self->blocks[self->block_count++] = texels;
+		self->bytes += (size_t)FLOOR_DECAL_BLOCK_PAGES * FLOOR_DECAL_PAGE_TEXELS * sizeof(uint32_t);
+	}
+	int slot = self->pages_carved % FLOOR_DECAL_BLOCK_PAGES;
+	self->pages_carved++;
+	self->page_count++;
+	return &self->blocks[block][(size_t)slot * FLOOR_DECAL_PAGE_TEXELS];
+}
+
+// Returns the pages of the least recently splatted sector other than `keep` to the free
+// list. Returns false when no other sector has any.
+static bool floor_decals_evict_lru(FloorDecals* self, int keep) {
+	int victim = -1;
+	for (int i = 0; i < self->sector_count; i++) {
+		const SectorFloorDecals* sd = &self->sectors[i];
+		if (i == keep || sd->page_count == 0) {
+			continue;
+		}
+		// Wrap-safe: the oldest stamp is the furthest behind the clock.
+		if (victim < 0 || self->splat_clock - sd->last_splat > self->splat_clock - self->sectors[victim].last_splat) {
+			victim = i;
+		}
+	}
+	if (victim < 0) {
+		return false;
+	}
+	SectorFloorDecals* sd = &self->sectors[victim];
+	for (int k = 0; k < sd->pages_w * sd->pages_h; k++) {
+		uint32_t* page = sd->pages[k];
+		if (!page) {
+			continue;
+		}
+		memcpy(page, &self->free_pages, sizeof(uint32_t*));
+		self->free_pages = page;
+		sd->pages[k] = NULL;
+	}
+	self->page_count -= sd->page_count;
+	sd->page_count = 0;
+	self->evictions++;
+	return true;
+}
+
+bool floor_decals_splat(FloorDecals* self, const World* world, int sector, float x, float y, float radius, uint32_t abgr) {
+	if (!self || !world || radius <= 0.0f) {
+		return false;
+	}
+	SectorFloorDecals* sd = floor_decals_sector_table(self, world, sector);
+	if (!sd) {
+		return false;
+	}
+	sd->last_splat = ++self->splat_clock;
+	const float tpu = (float)FLOOR_DECAL_TEXELS_PER_UNIT;
+	int tw = sd->pages_w << FLOOR_DECAL_PAGE_SHIFT;
+	int th = sd->pages_h << FLOOR_DECAL_PAGE_SHIFT;
+	float cx = (x - sd->origin_x) * tpu;
+	float cy = (y - sd->origin_y) * tpu;
+	float r = radius * tpu;
+	// Tiny droplets still cover the texel they land in.
+	if (r < 0.75f) {
+		r = 0.75f;
+	}
+	int x0 = (int)floorf(cx - r);
+	int y0 = (int)floorf(cy - r);
+	int x1 = (int)ceilf(cx + r);
+	int y1 = (int)ceilf(cy + r);
+	if (x0 < 0) {
+		x0 = 0;
+	}
+	if (y0 < 0) {
+		y0 = 0;
+	}
+	if (x1 > tw) {
+		x1 = tw;
+	}
+	if (y1 > th) {
+		y1 = th;
+	}
+	uint32_t c = abgr | 0xFF000000u;
+	float r2 = r * r;
+	const int mask = FLOOR_DECAL_PAGE_DIM - 1;
+	bool ok = true;
+	for (int ty = y0; ty < y1; ty++) {
+		float dy = ((float)ty + 0.5f) - cy;
+		for (int tx = x0; tx < x1; tx++) {
+			float dx = ((float)tx + 0.5f) - cx;
+			if (dx * dx + dy * dy > r2) {
+				continue;
+			}
+			uint32_t** slot = &sd->pages[(ty >> FLOOR_DECAL_PAGE_SHIFT) * sd->pages_w + (tx >> FLOOR_DECAL_PAGE_SHIFT)];
+			if (!*slot) {
+				if (!ok) {
+					continue; // already out of pages for this splat
+				}
+				*slot = floor_decals_alloc_page(self);
+				while (!*slot && self->pages_carved >= FLOOR_DECAL_MAX_PAGES && floor_decals_evict_lru(self, sector)) {
+					*slot = floor_decals_alloc_page(self);
+				}
+				if (!*slot) {
+					ok = false;
+					continue;
+				}
+				sd->page_count++;
+			}
+			(*slot)[((ty & mask) << FLOOR_DECAL_PAGE_SHIFT) | (tx & mask)] = c;
+		}
+	}
+	return ok;
+}
+
+const SectorFloorDecals* floor_decals_sector(const FloorDecals* self, int sector) {
+	if (!self || !self->sectors || (unsigned)sector >= (unsigned)self->sector_count) {
+		return NULL;
+	}
+	const SectorFloorDecals* sd = &self->sectors[sector];
+	return sd->page_count > 0 ? sd : NULL;
+}
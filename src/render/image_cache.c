@@ -0,0 +1,311 @@
+#include "render/image_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const uint16_t k_bucket_sizes[] = {2, 3, 4, 6, 8, 11, 16, 23, 32, 45, 64, 91, 128, 181, 256};
+
+#define IMAGE_CACHE_INITIAL_HEADS 256
+
+static float clampf_ic(float v, float lo, float hi) {
+	return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static uint32_t image_cache_hash(const Texture* source, int size, uint16_t rot_key) {
+	uintptr_t p = (uintptr_t)source;
+	uint32_t h = (uint32_t)(p >> 4) ^ (uint32_t)((uint64_t)p >> 32);
+	h ^= (uint32_t)size * 0x9E3779B1u;
+	h ^= (uint32_t)rot_key * 0x85EBCA77u;
+	h ^= h >> 15;
+	h *= 0x2C1B3C6Du;
+	h ^= h >> 12;
+	return h;
+}
+
+static size_t image_cache_entry_bytes(int size) {
+	return sizeof(Texture) + (size_t)size * (size_t)size * sizeof(uint32_t);
+}
+
+bool image_cache_init(ImageCache* self, size_t budget_bytes) {
+	if (!self) {
+		return false;
+	}
+	memset(self, 0, sizeof(*self));
+	self->free_head = -1;
+	self->lru_head = -1;
+	self->lru_tail = -1;
+	self->budget_bytes = budget_bytes;
+	self->heads = (int*)malloc((size_t)IMAGE_CACHE_INITIAL_HEADS * sizeof(int));
+	if (!self->heads) {
+		return false;
+	}
+	self->head_count = IMAGE_CACHE_INITIAL_HEADS;
+	for (int i = 0; i < self->head_count; i++) {
+		self->heads[i] = -1;
+	}
+	return true;
+}
+
+void image_cache_clear(ImageCache* self) {
+	if (!self) {
+		return;
+	}
+	for (int i = 0; i < self->entry_count; i++) {
+		free(self->entries[i].image);
+	}
+	self->entry_count = 0;
+	self->free_head = -1;
+	self->lru_head = -1;
+	self->lru_tail = -1;
+	self->live = 0;
+	self->used_bytes = 0u;
+	for (int i = 0; i < self->head_count; i++) {
+		self->heads[i] = -1;
+	}
+}
+
+void image_cache_destroy(ImageCache* self) {
+	if (!self) {
+		return;
+	}
+	image_cache_clear(self);
+	free(self->entries);
+	free(self->heads);
+	memset(self, 0, sizeof(*self));
+}
+
+static void image_cache_lru_unlink(ImageCache* self, int idx) {
+	ImageCacheEntry* e = &self->entries[idx];
+	if (e->lru_prev >= 0) {
+		self->entries[e->lru_prev].lru_next = e->lru_next;
+	} else {
+		self->lru_head = e->lru_next;
+	}
+	if (e->lru_next >= 0) {
+		self->entries[e->lru_next].lru_prev = e->lru_prev;
+	} else {
+		self->lru_tail = e->lru_prev;
+	}
+	e->lru_prev = -1;
+	e->lru_next = -1;
+}
+
+static void image_cache_lru_push_front(ImageCache* self, int idx) {
+	ImageCacheEntry* e = &self->entries[idx];
+	e->lru_prev = -1;
+	e->lru_next = self->lru_head;
+	if (self->lru_head >= 0) {
+		self->entries[self->lru_head].lru_prev = idx;
+	} else {
+		self->lru_tail = idx;
+	}
+	self->lru_head = idx;
+}
+
+static void image_cache_evict(ImageCache* self, int idx) {
+	ImageCacheEntry* e = &self->entries[idx];
+	int* link = &self->heads[image_cache_hash(e->source, e->size, e->rot_key) & (uint32_t)(self->head_count - 1)];
+	while (*link != idx) {
+		link = &self->entries[*link].hash_next;
+	}
+	*link = e->hash_next;
+	image_cache_lru_unlink(self, idx);
+	self->used_bytes -= image_cache_entry_bytes(e->size);
+	free(e->image);
+	e->image = NULL;
+	e->source = NULL;
+	e->hash_next = self->free_head;
+	self->free_head = idx;
+	self->live--;
+	self->stats_evictions++;
+}
+
+// Evicts least recently used entries not touched this frame until `bytes` more fit.
+static bool image_cache_make_room(ImageCache* self, size_t bytes) {
+	while (self->used_bytes + bytes > self->budget_bytes) {
+		int idx = self->lru_tail;
+		if (idx < 0 || self->entries[idx].last_frame == self->frame) {
+			return false;
+		}
+		image_cache_evict(self, idx);
+	}
+	return true;
+}
+
+void image_cache_set_budget(ImageCache* self, size_t budget_bytes) {
+	if (!self || self->budget_bytes == budget_bytes) {
+		return;
+	}
+	self->budget_bytes = budget_bytes;
+	(void)image_cache_make_room(self, 0u);
+}
+
+void image_cache_begin_frame(ImageCache* self) {
+	if (!self) {
+		return;
+	}
+	// Frame 0 is never current, so fresh entries can always be told apart.
+	self->frame++;
+	if (self->frame == 0u) {
+		self->frame = 1u;
+	}
+	self->stats_hits = 0u;
+	self->stats_misses = 0u;
+	self->stats_evictions = 0u;
+	self->stats_bypassed = 0u;
+}
+
+int image_cache_bucket_size(int px) {
+	if (px <= IMAGE_CACHE_MIN_SIZE) {
+		return IMAGE_CACHE_MIN_SIZE;
+	}
+	int n = (int)(sizeof(k_bucket_sizes) / sizeof(k_bucket_sizes[0]));
+	if (px > (int)k_bucket_sizes[n - 1]) {
+		return 0;
+	}
+	for (int i = 1; i < n; i++) {
+		int hi = (int)k_bucket_sizes[i];
+		if (px <= hi) {
+			// Nearest in log space: above the geometric mean of the neighbours rounds up.
+			int lo = (int)k_bucket_sizes[i - 1];
+			return px * px > lo * hi ? hi : lo;
+		}
+	}
+	return 0;
+}
+
+static bool image_cache_grow_heads(ImageCache* self) {
+	int count = self->head_count * 2;
+	int* heads = (int*)malloc((size_t)count * sizeof(int));
+	if (!heads) {
+		return false;
+	}
+	for (int i = 0; i < count; i++) {
+		heads[i] = -1;
+	}
+	for (int i = 0; i < self->entry_count; i++) {
+		ImageCacheEntry* e = &self->entries[i];
+		if (!e->source) {
+			continue;
+		}
+		uint32_t h = image_cache_hash(e->source, e->size, e->rot_key) & (uint32_t)(count - 1);
+		e->hash_next = heads[h];
+		heads[h] = i;
+	}
+	free(self->heads);
+	self->heads = heads;
+	self->head_count = count;
+	return true;
+}
+
+static int image_cache_alloc_slot(ImageCache* self) {
+	if (self->free_head >= 0) {
+		int idx = self->free_head;
+		self->free_head = self->entries[idx].hash_next;
+		return idx;
+	}
+	if (self->entry_count == self->entry_cap) {
+		int cap = self->entry_cap ? self->entry_cap * 2 : 64;
+		ImageCacheEntry* entries = (ImageCacheEntry*)realloc(self->entries, (size_t)cap * sizeof(ImageCacheEntry));
+		if (!entries) {
+			return -1;
+		}
+		self->entries = entries;
+		self->entry_cap = cap;
+	}
+	return self->entry_count++;
+}
+
+// Same sampling as the per-pixel path in composite_item_raster, for a size x size item.
+static void image_cache_bake(Texture* out, const Texture* src, int size, bool rotate, float cr, float sr) {
+	int tw = src->width;
+	int th = src->height;
+	for (int y = 0; y < size; y++) {
+		uint32_t* row = &out->pixels[(size_t)y * (size_t)size];
+		for (int x = 0; x < size; x++) {
+			float u = clampf_ic((float)x / (float)(size - 1), 0.0f, 1.0f);
+			float v = clampf_ic((float)y / (float)(size - 1), 0.0f, 1.0f);
+			float ru = u;
+			float rv = v;
+			if (rotate) {
+				float lx = (u - 0.5f);
+				float ly = (v - 0.5f);
+				ru = (lx * cr - ly * sr) + 0.5f;
+				rv = (lx * sr + ly * cr) + 0.5f;
+				if (ru < 0.0f || ru > 1.0f || rv < 0.0f || rv > 1.0f) {
+					row[x] = 0x00FF00FFu;
+					continue;
+				}
+			}
+			int sx = (int)(ru * (float)(tw - 1) + 0.5f);
+			int sy = (int)(rv * (float)(th - 1) + 0.5f);
+			row[x] = src->pixels[sy * tw + sx];
+		}
+	}
+}
+
+const Texture* image_cache_get(ImageCache* self, const Texture* source, int size, uint16_t rot_key, float rot_cos, float rot_sin) {
+	if (!self || !self->heads || !source || !source->pixels || source->width <= 0 || source->height <= 0) {
+		return NULL;
+	}
+	if (source->layout != TEXTURE_LAYOUT_ROW_MAJOR || size < IMAGE_CACHE_MIN_SIZE || size > IMAGE_CACHE_MAX_SIZE) {
+		self->stats_bypassed++;
+		return NULL;
+	}
+	uint32_t h = image_cache_hash(source, size, rot_key);
+	for (int i = self->heads[h & (uint32_t)(self->head_count - 1)]; i >= 0; i = self->entries[i].hash_next) {
+		ImageCacheEntry* e = &self->entries[i];
+		if (e->source == source && e->size == (uint16_t)size && e->rot_key == rot_key) {
+			e->last_frame = self->frame;
+			if (self->lru_head != i) {
+				image_cache_lru_unlink(self, i);
+				image_cache_lru_push_front(self, i);
+			}
+			self->stats_hits++;
+			return e->image;
+		}
+	}
+
+	self->stats_misses++;
+	size_t bytes = image_cache_entry_bytes(size);
+	if (bytes > self->budget_bytes || !image_cache_make_room(self, bytes)) {
+		self->stats_bypassed++;
+		return NULL;
+	}
+	if (self->live >= self->head_count * 2 && !image_cache_grow_heads(self)) {
+		self->stats_bypassed++;
+		return NULL;
+	}
+	Texture* image = (Texture*)malloc(bytes);
+	if (!image) {
+		self->stats_bypassed++;
+		return NULL;
+	}
+	int idx = image_cache_alloc_slot(self);
+	if (idx < 0) {
+		free(image);
+		self->stats_bypassed++;
+		return NULL;
+	}
+	memset(image, 0, sizeof(*image));
+	image->width = size;
+	image->height = size;
+	image->pixels = (uint32_t*)(image + 1);
+	image->layout = TEXTURE_LAYOUT_ROW_MAJOR;
+	memcpy(image->name, source->name, sizeof(image->name));
+	image_cache_bake(image, source, size, rot_key != IMAGE_CACHE_NO_ROTATION, rot_cos, rot_sin);
+
+	ImageCacheEntry* e = &self->entries[idx];
+	e->source = source;
+	e->size = (uint16_t)size;
+	e->rot_key = rot_key;
+	e->image = image;
+	e->last_frame = self->frame;
+	uint32_t slot = h & (uint32_t)(self->head_count - 1);
+	e->hash_next = self->heads[slot];
+	self->heads[slot] = idx;
+	image_cache_lru_push_front(self, idx);
+	self->used_bytes += bytes;
+	self->live++;
+	return image;
+}
@@ -41,6 +41,82 @@ static float quantize_factor(float v, int steps) {
 	return roundf(v * s) / s;
 }
 
+static uint32_t hash_u32(uint32_t x) {
+	// SplitMix32
+	x += 0x9E3779B9u;
+	x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+	x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+	return x ^ (x >> 16);
+}
+
+static float rand01(uint32_t seed) {
+	uint32_t x = hash_u32(seed);
+	return (float)(x & 0x00FFFFFFu) / (float)0x01000000u;
+}
+
+static float smoothstep(float t) {
+	if (t < 0.0f) {
+		return 0.0f;
+	}
+	if (t > 1.0f) {
+		return 1.0f;
+	}
+	return t * t * (3.0f - 2.0f * t);
+}
+
+static float flicker_factor_flame(uint32_t seed, float time_s) {
+	// Smooth value-noise: ~8 Hz.
+	const float freq = 8.0f;
+	float t = time_s * freq;
+	float ti = floorf(t);
+	float tf = t - ti;
+	uint32_t step = (uint32_t)ti;
+	float a = rand01(seed ^ (step * 0xA511E9B3u));
+	float b = rand01(seed ^ ((step + 1u) * 0xA511E9B3u));
+	float n = a + (b - a) * smoothstep(tf);
+	// Bias bright with occasional dips.
+	return 0.65f + 0.45f * (n * n);
+}
+
+static float flicker_factor_malfunction(uint32_t seed, float time_s) {
+	// Abrupt spurts: mostly on, occasional off/strobe.
+	const float freq = 22.0f;
+	float t = time_s * freq;
+	float ti = floorf(t);
+	float tf = t - ti;
+	uint32_t step = (uint32_t)ti;
+	float r = rand01(seed ^ (step * 0xD1B54A35u));
+	if (r < 0.06f) {
+		return 0.0f;
+	}
+	if (r < 0.10f) {
+		float s = rand01(seed ^ (step * 0x94D049BBu));
+		float hz = 8.0f + 24.0f * s;
+		float p = sinf(tf * (float)M_PI * 2.0f * hz);
+		return (p > 0.0f) ? 1.0f : 0.0f;
+	}
+	return 0.90f + 0.10f * rand01(seed ^ (step * 0x9E3779B9u));
+}
+
+float lighting_flicker_factor(LightFlicker flicker, uint32_t seed, float time_s) {
+	float f = 1.0f;
+	switch (flicker) {
+		case LIGHT_FLICKER_NONE:
+			f = 1.0f;
+			break;
+		case LIGHT_FLICKER_FLAME:
+			f = flicker_factor_flame(seed, time_s);
+			break;
+		case LIGHT_FLICKER_MALFUNCTION:
+			f = flicker_factor_malfunction(seed, time_s);
+			break;
+		default:
+			f = 1.0f;
+			break;
+	}
+	return f < 0.0f ? 0.0f : f;
+}
+
 float lighting_distance_falloff(float dist) {
 	// Aggressive fog-to-black, but with a readable near range.
 	// 0..fog_start: no fog. fog_end+: fully black.
@@ -81,6 +157,20 @@ LightColor lighting_compute_multipliers(
 	int light_count,
 	float sample_x,
 	float sample_y
+) {
+	LightColor none = {0.0f, 0.0f, 0.0f};
+	return lighting_compute_multipliers_baked(dist, sector_intensity, sector_tint, lights, light_count, sample_x, sample_y, none);
+}
+
+LightColor lighting_compute_multipliers_baked(
+	float dist,
+	float sector_intensity,
+	LightColor sector_tint,
+	const PointLight* lights,
+	int light_count,
+	float sample_x,
+	float sample_y,
+	LightColor baked
 ) {
 	float fog = lighting_distance_falloff(dist);
 	const CoreConfig* cfg = core_config_get();
@@ -97,6 +187,11 @@ LightColor lighting_compute_multipliers(
 	float g_mul = amb * clampf(sector_tint.g, 0.0f, 1.0f);
 	float b_mul = amb * clampf(sector_tint.b, 0.0f, 1.0f);
 
+	// Precomputed static point-light contribution (already flicker-modulated).
+	r_mul += baked.r;
+	g_mul += baked.g;
+	b_mul += baked.b;
+
 	// Additive point lights (in multiplier space). These are also fogged by distance.
 	if (lights && light_count > 0) {
 		for (int i = 0; i < light_count; i++) {
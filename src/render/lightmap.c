@@ -0,0 +1,246 @@
+#include "render/lightmap.h"
+
+#include "core/log.h"
+
+#include "game/world.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static float clampf(float v, float lo, float hi) {
+	if (v < lo) {
+		return lo;
+	}
+	if (v > hi) {
+		return hi;
+	}
+	return v;
+}
+
+static uint8_t unit_to_u8(float v, float max) {
+	return (uint8_t)lroundf(clampf(v / max, 0.0f, 1.0f) * 255.0f);
+}
+
+static void sector_lightmap_destroy(SectorLightmap* lm) {
+	free(lm->steady);
+	free(lm->channel_light);
+	free(lm->channel_weight);
+	memset(lm, 0, sizeof(*lm));
+}
+
+void plane_lightmaps_init(PlaneLightmaps* self) {
+	memset(self, 0, sizeof(*self));
+}
+
+void plane_lightmaps_destroy(PlaneLightmaps* self) {
+	if (!self) {
+		return;
+	}
+	for (int i = 0; i < self->sector_count; i++) {
+		sector_lightmap_destroy(&self->sectors[i]);
+	}
+	free(self->sectors);
+	memset(self, 0, sizeof(*self));
+}
+
+static bool light_is_bakeable(const World* world, int i) {
+	if (world->light_alive && !world->light_alive[i]) {
+		return false;
+	}
+	const PointLight* L = &world->lights[i];
+	return L->radius > 0.0f && L->intensity > 0.0f;
+}
+
+static bool light_reaches_box(const PointLight* L, float min_x, float min_y, float max_x, float max_y) {
+	float cx = clampf(L->x, min_x, max_x);
+	float cy = clampf(L->y, min_y, max_y);
+	float dx = L->x - cx;
+	float dy = L->y - cy;
+	return dx * dx + dy * dy < L->radius * L->radius;
+}
+
+// Same falloff as lighting_compute_multipliers, without color.
+static float light_weight_at(const PointLight* L, float x, float y) {
+	float dx = x - L->x;
+	float dy = y - L->y;
+	float d2 = dx * dx + dy * dy;
+	if (d2 >= L->radius * L->radius) {
+		return 0.0f;
+	}
+	float t = 1.0f - sqrtf(d2) / L->radius;
+	return L->intensity * clampf(t * t, 0.0f, 1.0f);
+}
+
+static bool bake_sector(SectorLightmap* lm, const World* world, int sector, int light_count, int* scratch, size_t* bytes) {
+	float min_x = 0.0f, min_y = 0.0f, max_x = 0.0f, max_y = 0.0f;
+	if (!world_sector_bounds(world, sector, &min_x, &min_y, &max_x, &max_y)) {
+		return true;
+	}
+
+	int steady_n = 0;
+	int flicker_n = 0;
+	for (int i = 0; i < light_count; i++) {
+		if (!light_is_bakeable(world, i) || !light_reaches_box(&world->lights[i], min_x, min_y, max_x, max_y)) {
+			continue;
+		}
+		if (world->lights[i].flicker == LIGHT_FLICKER_NONE) {
+			steady_n++;
+		} else {
+			flicker_n++;
+		}
+		scratch[steady_n + flicker_n - 1] = i;
+	}
+	if (steady_n + flicker_n == 0) {
+		return true;
+	}
+
+	float ext = fmaxf(max_x - min_x, max_y - min_y);
+	float texel = PLANE_LIGHTMAP_TEXEL_SIZE;
+	if (ext / texel > (float)PLANE_LIGHTMAP_MAX_DIM) {
+		texel = ext / (float)PLANE_LIGHTMAP_MAX_DIM;
+	}
+	int w = (int)ceilf((max_x - min_x) / texel);
+	int h = (int)ceilf((max_y - min_y) / texel);
+	w = w < 1 ? 1 : w;
+	h = h < 1 ? 1 : h;
+	size_t texels = (size_t)w * (size_t)h;
+
+	lm->steady = (uint32_t*)calloc(texels, sizeof(uint32_t));
+	if (flicker_n > 0) {
+		lm->channel_light = (int*)malloc((size_t)flicker_n * sizeof(int));
+		lm->channel_weight = (uint8_t*)calloc((size_t)flicker_n * texels, sizeof(uint8_t));
+	}
+	if (!lm->steady || (flicker_n > 0 && (!lm->channel_light || !lm->channel_weight))) {
+		sector_lightmap_destroy(lm);
+		return false;
+	}
+	lm->origin_x = min_x;
+	lm->origin_y = min_y;
+	lm->inv_texel = 1.0f / texel;
+	lm->w = w;
+	lm->h = h;
+
+	for (int y = 0; y < h; y++) {
+		float py = min_y + ((float)y + 0.5f) * texel;
+		for (int x = 0; x < w; x++) {
+			float px = min_x + ((float)x + 0.5f) * texel;
+			size_t idx = (size_t)y * (size_t)w + (size_t)x;
+			float r = 0.0f;
+			float g = 0.0f;
+			float b = 0.0f;
+			int ch = 0;
+			for (int k = 0; k < steady_n + flicker_n; k++) {
+				const PointLight* L = &world->lights[scratch[k]];
+				float a = light_weight_at(L, px, py);
+				if (L->flicker == LIGHT_FLICKER_NONE) {
+					r += a * clampf(L->color.r, 0.0f, 1.0f);
+					g += a * clampf(L->color.g, 0.0f, 1.0f);
+					b += a * clampf(L->color.b, 0.0f, 1.0f);
+				} else {
+					lm->channel_weight[(size_t)ch * texels + idx] = unit_to_u8(a, PLANE_LIGHTMAP_WEIGHT_MAX);
+					ch++;
+				}
+			}
+			// The final multiplier clamps to 1, so a saturated steady term stays saturated.
+			lm->steady[idx] = (uint32_t)unit_to_u8(r, 1.0f) | ((uint32_t)unit_to_u8(g, 1.0f) << 8) | ((uint32_t)unit_to_u8(b, 1.0f) << 16);
+		}
+	}
+	for (int k = 0; k < steady_n + flicker_n; k++) {
+		if (world->lights[scratch[k]].flicker != LIGHT_FLICKER_NONE) {
+			lm->channel_light[lm->channel_count++] = scratch[k];
+		}
+	}
+	*bytes += texels * sizeof(uint32_t) + (size_t)flicker_n * (texels + sizeof(int));
+	return true;
+}
+
+bool plane_lightmaps_bake(PlaneLightmaps* self, const World* world) {
+	if (!self) {
+		return false;
+	}
+	plane_lightmaps_destroy(self);
+	if (!world || world->sector_count <= 0 || !world->lights || world->light_count <= 0) {
+		return true;
+	}
+
+	self->sectors = (SectorLightmap*)calloc((size_t)world->sector_count, sizeof(SectorLightmap));
+	int* scratch = (int*)malloc((size_t)world->light_count * sizeof(int));
+	if (!self->sectors || !scratch) {
+		free(scratch);
+		plane_lightmaps_destroy(self);
+		return false;
+	}
+	self->sector_count = world->sector_count;
+	self->baked_light_count = world->light_count;
+
+	for (int s = 0; s < world->sector_count; s++) {
+		if (!bake_sector(&self->sectors[s], world, s, world->light_count, scratch, &self->bytes)) {
+			log_error("lightmap: out of memory baking sector %d", s);
+			free(scratch);
+			plane_lightmaps_destroy(self);
+			return false;
+		}
+	}
+	free(scratch);
+	self->bytes += (size_t)self->sector_count * sizeof(SectorLightmap);
+	log_info_s("lightmap", "baked %d static lights into %d sectors (%.1f KiB)", self->baked_light_count, self->sector_count, (double)self->bytes / 1024.0);
+	return true;
+}
+
+void plane_lightmaps_frame_gains(const PlaneLightmaps* self, const World* world, float time_s, LightColor* out) {
+	if (!self || !world || !out) {
+		return;
+	}
+	const float scale = PLANE_LIGHTMAP_WEIGHT_MAX / 255.0f;
+	int n = self->baked_light_count < world->light_count ? self->baked_light_count : world->light_count;
+	for (int i = 0; i < n; i++) {
+		const PointLight* L = &world->lights[i];
+		LightColor g = {0.0f, 0.0f, 0.0f};
+		if (L->flicker != LIGHT_FLICKER_NONE && (!world->light_alive || world->light_alive[i])) {
+			uint32_t seed = L->seed ? L->seed : (uint32_t)i;
+			float f = lighting_flicker_factor(L->flicker, seed, time_s) * scale;
+			g.r = f * clampf(L->color.r, 0.0f, 1.0f);
+			g.g = f * clampf(L->color.g, 0.0f, 1.0f);
+			g.b = f * clampf(L->color.b, 0.0f, 1.0f);
+		}
+		out[i] = g;
+	}
+	for (int i = n; i < self->baked_light_count; i++) {
+		out[i].r = out[i].g = out[i].b = 0.0f;
+	}
+}
+
+const SectorLightmap* plane_lightmaps_sector(const PlaneLightmaps* self, int sector) {
+	if (!self || (unsigned)sector >= (unsigned)self->sector_count) {
+		return NULL;
+	}
+	const SectorLightmap* lm = &self->sectors[sector];
+	return lm->steady ? lm : NULL;
+}
+
+LightColor sector_lightmap_sample(const SectorLightmap* lm, const LightColor* gains, float wx, float wy) {
+	LightColor out = {0.0f, 0.0f, 0.0f};
+	int x = (int)((wx - lm->origin_x) * lm->inv_texel);
+	int y = (int)((wy - lm->origin_y) * lm->inv_texel);
+	x = x < 0 ? 0 : (x >= lm->w ? lm->w - 1 : x);
+	y = y < 0 ? 0 : (y >= lm->h ? lm->h - 1 : y);
+	size_t idx = (size_t)y * (size_t)lm->w + (size_t)x;
+
+	uint32_t s = lm->steady[idx];
+	const float inv255 = 1.0f / 255.0f;
+	out.r = (float)(s & 0xFFu) * inv255;
+	out.g = (float)((s >> 8) & 0xFFu) * inv255;
+	out.b = (float)((s >> 16) & 0xFFu) * inv255;
+	if (gains) {
+		size_t texels = (size_t)lm->w * (size_t)lm->h;
+		for (int c = 0; c < lm->channel_count; c++) {
+			float wgt = (float)lm->channel_weight[(size_t)c * texels + idx];
+			const LightColor* g = &gains[lm->channel_light[c]];
+			out.r += wgt * g->r;
+			out.g += wgt * g->g;
+			out.b += wgt * g->b;
+		}
+	}
+	return out;
+}
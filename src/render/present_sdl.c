@@ -1,11 +1,15 @@
 #include "render/present.h"
 
 #include "core/log.h"
+#include "render/draw.h"
+#include "render/vga_palette.h"
 
 #include <SDL.h>
 
+#include <string.h>
+
 bool present_init(Presenter* self, Window* window, const Framebuffer* fb) {
-	self->texture = NULL;
+	memset(self, 0, sizeof(*self));
 	SDL_Texture* tex = SDL_CreateTexture(window->renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, fb->width, fb->height);
 	if (!tex) {
 		log_error("SDL_CreateTexture failed: %s", SDL_GetError());
@@ -13,6 +17,8 @@ bool present_init(Presenter* self, Window* window, const Framebuffer* fb) {
 	}
 	SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE);
 	self->texture = tex;
+	self->tex_w = fb->width;
+	self->tex_h = fb->height;
 	return true;
 }
 
@@ -21,6 +27,65 @@ void present_shutdown(Presenter* self) {
 		SDL_DestroyTexture((SDL_Texture*)self->texture);
 		self->texture = NULL;
 	}
+	if (self->ui_texture) {
+		SDL_DestroyTexture((SDL_Texture*)self->ui_texture);
+		self->ui_texture = NULL;
+	}
+	for (int i = 0; i < 2; i++) {
+		if (self->lock_textures[i]) {
+			if (self->lock_active && i == self->lock_index) {
+				SDL_UnlockTexture((SDL_Texture*)self->lock_textures[i]);
+			}
+			SDL_DestroyTexture((SDL_Texture*)self->lock_textures[i]);
+			self->lock_textures[i] = NULL;
+		}
+	}
+	self->lock_active = false;
+	framebuffer_destroy(&self->composite);
+}
+
+static void lock_disable(Presenter* self, const char* why) {
+	log_warn("Locked present disabled (%s); using SDL_UpdateTexture", why);
+	self->lock_disabled = true;
+}
+
+Framebuffer* present_lock_frame(Presenter* self, Window* window, Framebuffer* fb) {
+	if (!self || !fb || self->lock_disabled || fb->width != self->tex_w || fb->height != self->tex_h) {
+		return fb;
+	}
+	if (self->lock_active) {
+		return &self->lock_view;
+	}
+	for (int i = 0; i < 2; i++) {
+		if (!self->lock_textures[i]) {
+			SDL_Texture* tex = SDL_CreateTexture(window->renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, self->tex_w, self->tex_h);
+			if (!tex) {
+				lock_disable(self, SDL_GetError());
+				return fb;
+			}
+			SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE);
+			self->lock_textures[i] = tex;
+		}
+	}
+
+	SDL_Texture* tex = (SDL_Texture*)self->lock_textures[self->lock_index];
+	void* pixels = NULL;
+	int pitch = 0;
+	if (SDL_LockTexture(tex, NULL, &pixels, &pitch) != 0) {
+		lock_disable(self, SDL_GetError());
+		return fb;
+	}
+	if (!pixels || pitch != self->tex_w * (int)sizeof(uint32_t)) {
+		// Padded rows: the renderer's draw loops assume stride == width.
+		SDL_UnlockTexture(tex);
+		lock_disable(self, "texture pitch does not match framebuffer stride");
+		return fb;
+	}
+	self->lock_view.width = self->tex_w;
+	self->lock_view.height = self->tex_h;
+	self->lock_view.pixels = (uint32_t*)pixels;
+	self->lock_active = true;
+	return &self->lock_view;
 }
 
 bool present_frame(Presenter* self, Window* window, const Framebuffer* fb) {
@@ -28,14 +93,217 @@ bool present_frame(Presenter* self, Window* window, const Framebuffer* fb) {
 	if (!tex) {
 		return false;
 	}
+	self->stats_ui_uploaded = false;
+	self->stats_ui_cpu_composite = false;
+	self->stats_locked = false;
 
-	if (SDL_UpdateTexture(tex, NULL, fb->pixels, fb->width * (int)sizeof(uint32_t)) != 0) {
+	if (self->lock_active && fb == &self->lock_view) {
+		SDL_Texture* locked = (SDL_Texture*)self->lock_textures[self->lock_index];
+		SDL_UnlockTexture(locked);
+		self->lock_active = false;
+		self->lock_index ^= 1;
+		self->stats_locked = true;
+		SDL_RenderClear(window->renderer);
+		SDL_RenderCopy(window->renderer, locked, NULL, NULL);
+		SDL_RenderPresent(window->renderer);
+		return true;
+	}
+	if (self->lock_active) {
+		// A frame was locked but something else is being presented; release it unused.
+		SDL_UnlockTexture((SDL_Texture*)self->lock_textures[self->lock_index]);
+		self->lock_active = false;
+	}
+
+	if (fb->width > self->tex_w || fb->height > self->tex_h) {
+		log_error("present_frame: framebuffer %dx%d exceeds target %dx%d", fb->width, fb->height, self->tex_w, self->tex_h);
+		return false;
+	}
+	// A smaller frame (scratch copy) fills the top-left of the texture and is scaled up.
+	SDL_Rect rect = {0, 0, fb->width, fb->height};
+	if (SDL_UpdateTexture(tex, &rect, fb->pixels, fb->width * (int)sizeof(uint32_t)) != 0) {
 		log_error("SDL_UpdateTexture failed: %s", SDL_GetError());
 		return false;
 	}
 
+	SDL_RenderClear(window->renderer);
+	SDL_RenderCopy(window->renderer, tex, &rect, NULL);
+	SDL_RenderPresent(window->renderer);
+	return true;
+}
+
+// Sizes the scratch framebuffer to w x h, reallocating only when it has to grow.
+static bool composite_reserve(Presenter* self, int w, int h) {
+	size_t need = (size_t)w * (size_t)h;
+	if (!self->composite.pixels || need > self->composite_cap) {
+		framebuffer_destroy(&self->composite);
+		self->composite_cap = 0;
+		if (!framebuffer_init(&self->composite, w, h)) {
+			framebuffer_destroy(&self->composite);
+			log_error("out of memory allocating present scratch buffer");
+			return false;
+		}
+		self->composite_cap = need;
+	}
+	self->composite.width = w;
+	self->composite.height = h;
+	return true;
+}
+
+bool present_frame_vga(Presenter* self, Window* window, const Framebuffer* fb) {
+	SDL_Texture* tex = (SDL_Texture*)self->texture;
+	if (!tex || !fb || !fb->pixels) {
+		return false;
+	}
+	if (self->lock_active && fb == &self->lock_view) {
+		vga_palette_remap(self->lock_view.pixels, self->lock_view.pixels, (size_t)fb->width * (size_t)fb->height);
+		return present_frame(self, window, fb);
+	}
+	void* pixels = NULL;
+	int pitch = 0;
+	if (fb->width != self->tex_w || fb->height != self->tex_h || SDL_LockTexture(tex, NULL, &pixels, &pitch) != 0) {
+		// Remap into a scratch copy and take the normal upload path.
+		if (!composite_reserve(self, fb->width, fb->height)) {
+			return false;
+		}
+		vga_palette_remap(self->composite.pixels, fb->pixels, (size_t)fb->width * (size_t)fb->height);
+		return present_frame(self, window, &self->composite);
+	}
+	self->stats_ui_uploaded = false;
+	self->stats_ui_cpu_composite = false;
+	self->stats_locked = false;
+	if (pitch == fb->width * (int)sizeof(uint32_t)) {
+		vga_palette_remap((uint32_t*)pixels, fb->pixels, (size_t)fb->width * (size_t)fb->height);
+	} else {
+		for (int y = 0; y < fb->height; y++) {
+			uint32_t* row = (uint32_t*)(void*)((uint8_t*)pixels + (size_t)y * (size_t)pitch);
+			vga_palette_remap(row, &fb->pixels[(size_t)y * (size_t)fb->width], (size_t)fb->width);
+		}
+	}
+	SDL_UnlockTexture(tex);
+
 	SDL_RenderClear(window->renderer);
 	SDL_RenderCopy(window->renderer, tex, NULL, NULL);
 	SDL_RenderPresent(window->renderer);
 	return true;
 }
+
+static bool ui_texture_create(Presenter* self, Window* window, int w, int h) {
+	if (self->ui_texture) {
+		SDL_DestroyTexture((SDL_Texture*)self->ui_texture);
+		self->ui_texture = NULL;
+	}
+	bool first = self->ui_w == 0 && self->ui_h == 0;
+	self->ui_w = w;
+	self->ui_h = h;
+	self->ui_current = false;
+	self->ui_premultiplied = false;
+	SDL_Texture* tex = SDL_CreateTexture(window->renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, w, h);
+	if (!tex) {
+		log_error("UI layer texture unavailable (%s)", SDL_GetError());
+		return false;
+	}
+	SDL_BlendMode premul = SDL_ComposeCustomBlendMode(
+		SDL_BLENDFACTOR_ONE,
+		SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+		SDL_BLENDOPERATION_ADD,
+		SDL_BLENDFACTOR_ONE,
+		SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+		SDL_BLENDOPERATION_ADD);
+	if (SDL_SetTextureBlendMode(tex, premul) == 0) {
+		self->ui_premultiplied = true;
+	} else {
+		// Keep the texture as the target for frames composited on the CPU.
+		if (first) {
+			log_warn("Renderer lacks premultiplied blending (%s); compositing UI layer on the CPU", SDL_GetError());
+		}
+		SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE);
+	}
+	self->ui_texture = tex;
+	return true;
+}
+
+// dst (opaque) = ui over dst, with ui in premultiplied alpha.
+static void composite_premultiplied(uint32_t* dst, const uint32_t* ui, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		uint32_t s = ui[i];
+		unsigned a = s >> 24;
+		if (a == 0u) {
+			continue;
+		}
+		if (a == 255u) {
+			dst[i] = s;
+			continue;
+		}
+		uint32_t d = dst[i];
+		unsigned inv = 255u - a;
+		unsigned r = (s & 0xFFu) + (((d & 0xFFu) * inv + 127u) / 255u);
+		unsigned g = ((s >> 8) & 0xFFu) + ((((d >> 8) & 0xFFu) * inv + 127u) / 255u);
+		unsigned b = ((s >> 16) & 0xFFu) + ((((d >> 16) & 0xFFu) * inv + 127u) / 255u);
+		r = r > 255u ? 255u : r;
+		g = g > 255u ? 255u : g;
+		b = b > 255u ? 255u : b;
+		dst[i] = 0xFF000000u | (b << 16) | (g << 8) | r;
+	}
+}
+
+bool present_frame_layers(Presenter* self, Window* window, const Framebuffer* world, const Framebuffer* ui, bool ui_changed) {
+	SDL_Texture* tex = (SDL_Texture*)self->texture;
+	if (!tex || !world || !ui || !world->pixels || !ui->pixels || ui->width <= 0 || ui->height <= 0) {
+		return false;
+	}
+	if (world->width > self->tex_w || world->height > self->tex_h) {
+		log_error("present_frame_layers: world layer %dx%d exceeds target %dx%d", world->width, world->height, self->tex_w, self->tex_h);
+		return false;
+	}
+	self->stats_ui_uploaded = false;
+	self->stats_ui_cpu_composite = false;
+	self->stats_locked = false;
+	if (ui->width != self->ui_w || ui->height != self->ui_h) {
+		if (!ui_texture_create(self, window, ui->width, ui->height)) {
+			return false;
+		}
+	}
+	if (!self->ui_texture) {
+		return false;
+	}
+	SDL_Texture* ui_tex = (SDL_Texture*)self->ui_texture;
+
+	SDL_Rect world_rect = {0, 0, world->width, world->height};
+	if (!self->ui_premultiplied) {
+		// Fallback: one opaque frame at the UI size, composited here.
+		if (!composite_reserve(self, ui->width, ui->height)) {
+			return false;
+		}
+		draw_blit_abgr8888_scaled_nearest(&self->composite, 0, 0, ui->width, ui->height, world->pixels, world->width, world->height);
+		composite_premultiplied(self->composite.pixels, ui->pixels, (size_t)ui->width * (size_t)ui->height);
+		if (SDL_UpdateTexture(ui_tex, NULL, self->composite.pixels, ui->width * (int)sizeof(uint32_t)) != 0) {
+			log_error("SDL_UpdateTexture failed: %s", SDL_GetError());
+			return false;
+		}
+		self->stats_ui_cpu_composite = true;
+		SDL_RenderClear(window->renderer);
+		SDL_RenderCopy(window->renderer, ui_tex, NULL, NULL);
+		SDL_RenderPresent(window->renderer);
+		return true;
+	}
+
+	if (SDL_UpdateTexture(tex, &world_rect, world->pixels, world->width * (int)sizeof(uint32_t)) != 0) {
+		log_error("SDL_UpdateTexture failed: %s", SDL_GetError());
+		return false;
+	}
+	if (ui_changed || !self->ui_current) {
+		if (SDL_UpdateTexture(ui_tex, NULL, ui->pixels, ui->width * (int)sizeof(uint32_t)) != 0) {
+			log_error("SDL_UpdateTexture failed: %s", SDL_GetError());
+			self->ui_current = false;
+			return false;
+		}
+		self->ui_current = true;
+		self->stats_ui_uploaded = true;
+	}
+
+	SDL_RenderClear(window->renderer);
+	SDL_RenderCopy(window->renderer, tex, &world_rect, NULL);
+	SDL_RenderCopy(window->renderer, ui_tex, NULL, NULL);
+	SDL_RenderPresent(window->renderer);
+	return true;
+}
@@ -1,13 +1,20 @@
 #include "render/raycast.h"
 
+#include "render/depth_spans.h"
 #include "render/draw.h"
+#include "render/floor_decals.h"
 #include "render/lighting.h"
+#include "render/lightmap.h"
+#include "render/simd.h"
+#include "render/sky_cache.h"
+#include "render/vga_palette.h"
 
 #include "platform/time.h"
 
 #include "game/world.h"
 
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -20,69 +27,142 @@
 #define MAX_ACTIVE_LIGHTS_WALLS MAX_VISIBLE_LIGHTS
 #define MAX_ACTIVE_LIGHTS_PLANES 6
 
+// Planes recompute lighting every PLANE_LIGHT_STEP rows of a column and reuse it in between.
+#define PLANE_LIGHT_STEP 4
+// Wall spans are lit in chunks of this many pixels per SIMD call.
+#define WALL_SPAN_CHUNK 64
+
 static float deg_to_rad(float deg);
 
 static bool g_point_lights_enabled = true;
+static bool g_palette_mode = false;
+
+// Renderer-owned caches that persist across frames. Released by raycast_shutdown.
+static SkyCache g_sky_cache;
+
+// Gouraud endpoint multipliers for one wall side, valid while `stamp` matches the
+// current render pass. Each wall has two slots (front/back) because the sector
+// light differs on either side.
+typedef struct WallLightCacheEntry {
+	uint32_t stamp;
+	LightColor mul_v0;
+	LightColor mul_v1;
+} WallLightCacheEntry;
+
+static WallLightCacheEntry* g_wall_light_cache;
+static int g_wall_light_cache_cap; // in entries (2 per wall)
+static uint32_t g_wall_light_stamp;
+
+// Per-frame baked plane lighting state: the world's lightmaps (NULL when point lights
+// are off or nothing was baked) and this frame's flicker gain per baked light.
+static const PlaneLightmaps* g_frame_lightmaps;
+static LightColor* g_baked_light_gain; // length g_baked_light_gain_cap
+static int g_baked_light_gain_cap;
+
+// Caller-owned depth span output for the current frame (NULL when not requested).
+static DepthSpans* g_frame_depth_spans;
+
+// Sectors the last textured render entered with some screen area left (one byte per
+// sector). g_visible_world/g_visible_sector_count identify the world it belongs to.
+static uint8_t* g_visible_sectors;
+static int g_visible_sector_cap;
+static int g_visible_sector_count;
+static const World* g_visible_world;
 
 void raycast_set_point_lights_enabled(bool enabled) {
 	g_point_lights_enabled = enabled;
 }
 
-static uint32_t hash_u32(uint32_t x) {
-	// SplitMix32
-	x += 0x9E3779B9u;
-	x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
-	x = (x ^ (x >> 13)) * 0xC2B2AE35u;
-	return x ^ (x >> 16);
+void raycast_set_palette_mode(bool enabled) {
+	g_palette_mode = enabled;
 }
 
-static float rand01(uint32_t seed) {
-	uint32_t x = hash_u32(seed);
-	return (float)(x & 0x00FFFFFFu) / (float)0x01000000u;
+void raycast_shutdown(void) {
+	sky_cache_destroy(&g_sky_cache);
+	free(g_wall_light_cache);
+	g_wall_light_cache = NULL;
+	g_wall_light_cache_cap = 0;
+	g_wall_light_stamp = 0u;
+	free(g_baked_light_gain);
+	g_baked_light_gain = NULL;
+	g_baked_light_gain_cap = 0;
+	g_frame_lightmaps = NULL;
+	free(g_visible_sectors);
+	g_visible_sectors = NULL;
+	g_visible_sector_cap = 0;
+	g_visible_sector_count = 0;
+	g_visible_world = NULL;
 }
 
-static float smoothstep(float t) {
-	if (t < 0.0f) {
-		return 0.0f;
+const uint8_t* raycast_visible_sectors(const World* world, int* out_count) {
+	if (out_count) {
+		*out_count = 0;
 	}
-	if (t > 1.0f) {
-		return 1.0f;
+	if (!world || world != g_visible_world || world->sector_count != g_visible_sector_count || !g_visible_sectors) {
+		return NULL;
 	}
-	return t * t * (3.0f - 2.0f * t);
+	if (out_count) {
+		*out_count = g_visible_sector_count;
+	}
+	return g_visible_sectors;
 }
 
-static float flicker_factor_flame(uint32_t seed, float time_s) {
-	// Smooth value-noise: ~8 Hz.
-	const float freq = 8.0f;
-	float t = time_s * freq;
-	float ti = floorf(t);
-	float tf = t - ti;
-	uint32_t step = (uint32_t)ti;
-	float a = rand01(seed ^ (step * 0xA511E9B3u));
-	float b = rand01(seed ^ ((step + 1u) * 0xA511E9B3u));
-	float n = a + (b - a) * smoothstep(tf);
-	// Bias bright with occasional dips.
-	return 0.65f + 0.45f * (n * n);
+// Clears the visible-sector set for a new render; on allocation failure the set is
+// reported as unavailable until a later render succeeds.
+static void visible_sectors_begin(const World* world) {
+	g_visible_world = NULL;
+	g_visible_sector_count = 0;
+	int n = world->sector_count;
+	if (n > g_visible_sector_cap) {
+		uint8_t* next = (uint8_t*)realloc(g_visible_sectors, (size_t)n);
+		if (!next) {
+			return;
+		}
+		g_visible_sectors = next;
+		g_visible_sector_cap = n;
+	}
+	if (n > 0) {
+		memset(g_visible_sectors, 0, (size_t)n);
+	}
+	g_visible_world = world;
+	g_visible_sector_count = n;
 }
 
-static float flicker_factor_malfunction(uint32_t seed, float time_s) {
-	// Abrupt spurts: mostly on, occasional off/strobe.
-	const float freq = 22.0f;
-	float t = time_s * freq;
-	float ti = floorf(t);
-	float tf = t - ti;
-	uint32_t step = (uint32_t)ti;
-	float r = rand01(seed ^ (step * 0xD1B54A35u));
-	if (r < 0.06f) {
-		return 0.0f;
+static bool baked_light_gain_reserve(int count) {
+	if (count <= g_baked_light_gain_cap) {
+		return true;
 	}
-	if (r < 0.10f) {
-		float s = rand01(seed ^ (step * 0x94D049BBu));
-		float hz = 8.0f + 24.0f * s;
-		float p = sinf(tf * (float)M_PI * 2.0f * hz);
-		return (p > 0.0f) ? 1.0f : 0.0f;
+	LightColor* next = (LightColor*)realloc(g_baked_light_gain, (size_t)count * sizeof(LightColor));
+	if (!next) {
+		return false;
+	}
+	g_baked_light_gain = next;
+	g_baked_light_gain_cap = count;
+	return true;
+}
+
+// Starts a new render pass for the wall lighting cache. Entries from earlier passes
+// become stale; on allocation failure the cache is disabled for this pass.
+static void wall_light_cache_begin(int wall_count) {
+	int need = wall_count > 0 ? wall_count * 2 : 0;
+	if (need > g_wall_light_cache_cap) {
+		WallLightCacheEntry* next = (WallLightCacheEntry*)realloc(g_wall_light_cache, (size_t)need * sizeof(WallLightCacheEntry));
+		if (!next) {
+			free(g_wall_light_cache);
+			g_wall_light_cache = NULL;
+			g_wall_light_cache_cap = 0;
+			return;
+		}
+		memset(next + g_wall_light_cache_cap, 0, (size_t)(need - g_wall_light_cache_cap) * sizeof(WallLightCacheEntry));
+		g_wall_light_cache = next;
+		g_wall_light_cache_cap = need;
+	}
+	g_wall_light_stamp++;
+	if (g_wall_light_stamp == 0u) {
+		// Stamp wrapped: clear so no entry from 2^32 passes ago looks current.
+		memset(g_wall_light_cache, 0, (size_t)g_wall_light_cache_cap * sizeof(WallLightCacheEntry));
+		g_wall_light_stamp = 1u;
 	}
-	return 0.90f + 0.10f * rand01(seed ^ (step * 0x9E3779B9u));
 }
 
 static float light_score_for_camera(const PointLight* L, float cam_x, float cam_y) {
@@ -176,12 +256,14 @@ static int limit_visible_lights(
 	return n;
 }
 
+// Lights with index < first_light are skipped (used to leave out baked static lights).
 static int build_visible_lights_uncapped(
 	PointLight* out,
 	int out_cap,
 	const World* world,
 	const Camera* cam,
-	float time_s
+	float time_s,
+	int first_light
 ) {
 	if (!out || out_cap <= 0 || !world || !cam || !world->lights || world->light_count <= 0) {
 		return 0;
@@ -195,7 +277,7 @@ static int build_visible_lights_uncapped(
 	float cos_min = cosf(fov_half + margin);
 
 	int n = 0;
-	for (int i = 0; i < world->light_count && n < out_cap; i++) {
+	for (int i = first_light > 0 ? first_light : 0; i < world->light_count && n < out_cap; i++) {
 		if (world->light_alive && !world->light_alive[i]) {
 			continue;
 		}
@@ -221,24 +303,7 @@ static int build_visible_lights_uncapped(
 
 		PointLight tmp = *L;
 		uint32_t seed = tmp.seed ? tmp.seed : (uint32_t)i;
-		float f = 1.0f;
-		switch (tmp.flicker) {
-			case LIGHT_FLICKER_NONE:
-				f = 1.0f;
-				break;
-			case LIGHT_FLICKER_FLAME:
-				f = flicker_factor_flame(seed, time_s);
-				break;
-			case LIGHT_FLICKER_MALFUNCTION:
-				f = flicker_factor_malfunction(seed, time_s);
-				break;
-			default:
-				f = 1.0f;
-				break;
-		}
-		if (f < 0.0f) {
-			f = 0.0f;
-		}
+		float f = lighting_flicker_factor(tmp.flicker, seed, time_s);
 		tmp.intensity *= f;
 		out[n++] = tmp;
 	}
@@ -252,7 +317,7 @@ static int build_visible_lights(
 	const Camera* cam,
 	float time_s
 ) {
-	int n = build_visible_lights_uncapped(out, out_cap, world, cam, time_s);
+	int n = build_visible_lights_uncapped(out, out_cap, world, cam, time_s, 0);
 	// Cap after view culling to keep per-pixel lighting work bounded.
 	return limit_visible_lights(out, n, MAX_ACTIVE_LIGHTS_WALLS, cam->x, cam->y);
 }
@@ -292,25 +357,26 @@ static float clampf(float v, float lo, float hi) {
 	return v;
 }
 
-static uint8_t clamp_u8(int v) {
-	if (v < 0) {
-		return 0;
+// Lights a run of plane pixels with one multiplier set and scatters it down column x.
+// Byte 2 (bits 16-23) takes the "r" multiplier, matching the wall path.
+static void flush_lit_column_span(Framebuffer* fb, int x, const SimdKernels* simd, uint32_t* span, const int* span_y, int n, int r_mul_i, int g_mul_i, int b_mul_i) {
+	if (n <= 0) {
+		return;
 	}
-	if (v > 255) {
-		return 255;
+	simd->mul_u8x3(span, span, n, b_mul_i, g_mul_i, r_mul_i);
+	for (int i = 0; i < n; i++) {
+		fb->pixels[span_y[i] * fb->width + x] = span[i];
 	}
-	return (uint8_t)v;
 }
 
-static uint32_t apply_lighting_mul_u8(uint32_t rgba, int r_mul_i, int g_mul_i, int b_mul_i) {
-	uint8_t a = (uint8_t)((rgba >> 24) & 0xFF);
-	uint8_t r = (uint8_t)((rgba >> 16) & 0xFF);
-	uint8_t g = (uint8_t)((rgba >> 8) & 0xFF);
-	uint8_t b = (uint8_t)(rgba & 0xFF);
-	int rr = (r * r_mul_i + 128) >> 8;
-	int gg = (g * g_mul_i + 128) >> 8;
-	int bb = (b * b_mul_i + 128) >> 8;
-	return ((uint32_t)a << 24) | ((uint32_t)clamp_u8(rr) << 16) | ((uint32_t)clamp_u8(gg) << 8) | (uint32_t)clamp_u8(bb);
+// Colormap row for the paletted path (render.vga_mode), or NULL when the pixel must
+// take the RGB path: paletted mode off, no index plane, or colored light (the
+// colormap only holds gray levels).
+static const uint32_t* palette_lit_row(const Texture* tex, int r_mul_i, int g_mul_i, int b_mul_i) {
+	if (!g_palette_mode || !tex || !tex->indices || r_mul_i != g_mul_i || g_mul_i != b_mul_i) {
+		return NULL;
+	}
+	return vga_colormap_row((r_mul_i + 4) >> 3);
 }
 
 static float fractf(float v) {
@@ -637,11 +703,12 @@ static void draw_sector_ceiling_column(
 	float corr,
 	float ceil_z,
 	const Texture* ceil_tex,
-	const Texture* sky_tex,
+	const SkyCache* sky,
 	float sector_intensity,
 	LightColor sector_tint,
 	const PointLight* lights,
 	int light_count,
+	const SectorLightmap* lightmap,
 	RaycastPerf* perf
 ) {
 	if (!fb || x < 0 || x >= fb->width) {
@@ -660,22 +727,21 @@ static void draw_sector_ceiling_column(
 		perf->pixels_ceil += (uint32_t)(y_bot - y_top);
 	}
 
-	// Skybox: cylindrical mapping, no perspective floor-plane math.
-	if (sky_tex) {
-		if (y_top < 0) {
-			y_top = 0;
-		}
-		if (y_bot > fb->height) {
-			y_bot = fb->height;
+	// Skybox: cylindrical mapping via the pre-resampled strip (see render/sky_cache.h).
+	if (sky) {
+		const uint32_t* col = sky_cache_column(sky, sky->x_to_column[x]);
+		int strip_end = y_bot < sky->height ? y_bot : sky->height;
+		uint32_t* dst = &fb->pixels[y_top * fb->width + x];
+		int y = y_top;
+		for (; y < strip_end; y++) {
+			*dst = col[y];
+			dst += fb->width;
 		}
-		float ang = atan2f(dy, dx);
-		float u = (ang + (float)M_PI) / (2.0f * (float)M_PI);
-		// y in [0, half_h] -> v in [0, 1]
-		float inv_half = half_h > 1e-6f ? (1.0f / half_h) : 1.0f;
-		for (int y = y_top; y < y_bot; y++) {
-			float v = ((float)y + 0.5f) * inv_half;
-			v = clampf(v, 0.0f, 1.0f);
-			fb->pixels[y * fb->width + x] = texture_sample_nearest(sky_tex, u, v);
+		// Below the horizon the panorama is clamped to its bottom row.
+		uint32_t bottom = sky->height > 0 ? col[sky->height - 1] : 0xFF0B0E14u;
+		for (; y < y_bot; y++) {
+			*dst = bottom;
+			dst += fb->width;
 		}
 		return;
 	}
@@ -691,10 +757,18 @@ static void draw_sector_ceiling_column(
 		const float plane_uv_scale = 0.25f; // 1 repeat per 4 world units
 		int cy0 = y_top;
 		int cy1 = y_bot < y_horizon ? y_bot : y_horizon;
-		const int light_step = 4;
+		const int light_step = PLANE_LIGHT_STEP;
+		const SimdKernels* simd = simd_kernels();
+		uint32_t span[PLANE_LIGHT_STEP];
+		int span_y[PLANE_LIGHT_STEP];
+		int span_n = 0;
 		int r_mul_i = 256;
 		int g_mul_i = 256;
 		int b_mul_i = 256;
+		const uint32_t* lit_row = NULL;
+		// 1/row_dist = (half_h - y) / ((ceil_z - cam_z) * proj_dist), linear in y.
+		float inv_k = 1.0f / ((ceil_z - cam_z) * proj_dist);
+		depth_spans_push_linear(g_frame_depth_spans, x, cy0, cy1, half_h * inv_k, -inv_k);
 		for (int y = cy0; y < cy1; y++) {
 			float denom = half_h - (float)y;
 			if (denom <= 0.001f) {
@@ -707,10 +781,15 @@ static void draw_sector_ceiling_column(
 			float wy = cam_y + dy * t;
 			float tu = fractf(wx * plane_uv_scale);
 			float tv = fractf(wy * plane_uv_scale);
-			uint32_t c = ceil_tex ? texture_sample_nearest(ceil_tex, tu, tv) : 0xFF0B0E14u;
-			if (lights && light_count > 0) {
+			if ((lights && light_count > 0) || lightmap) {
 				if (((y - cy0) % light_step) == 0) {
-					LightColor mul = lighting_compute_multipliers(row_dist, sector_intensity, sector_tint, lights, light_count, wx, wy);
+					flush_lit_column_span(fb, x, simd, span, span_y, span_n, r_mul_i, g_mul_i, b_mul_i);
+					span_n = 0;
+					LightColor baked = {0.0f, 0.0f, 0.0f};
+					if (lightmap) {
+						baked = sector_lightmap_sample(lightmap, g_baked_light_gain, wx, wy);
+					}
+					LightColor mul = lighting_compute_multipliers_baked(row_dist, sector_intensity, sector_tint, lights, light_count, wx, wy, baked);
 					float r_mul = lighting_quantize_factor(mul.r);
 					float g_mul = lighting_quantize_factor(mul.g);
 					float b_mul = lighting_quantize_factor(mul.b);
@@ -735,21 +814,29 @@ static void draw_sector_ceiling_column(
 					if (b_mul_i > 256) {
 						b_mul_i = 256;
 					}
+					lit_row = palette_lit_row(ceil_tex, r_mul_i, g_mul_i, b_mul_i);
 					if (perf) {
 						perf->lighting_apply_calls++;
 						perf->lighting_apply_light_iters += (uint64_t)light_count;
 					}
 				}
-				c = apply_lighting_mul_u8(c, r_mul_i, g_mul_i, b_mul_i);
+				if (lit_row) {
+					fb->pixels[y * fb->width + x] = lit_row[texture_sample_index_nearest(ceil_tex, tu, tv)];
+					continue;
+				}
+				span[span_n] = ceil_tex ? texture_sample_nearest(ceil_tex, tu, tv) : 0xFF0B0E14u;
+				span_y[span_n++] = y;
+				continue;
 			} else {
 				if (perf) {
 					perf->lighting_apply_calls++;
 					perf->lighting_apply_light_iters += 0;
 				}
-				c = lighting_apply(c, row_dist, sector_intensity, sector_tint, NULL, 0, wx, wy);
+				uint32_t c = ceil_tex ? texture_sample_nearest(ceil_tex, tu, tv) : 0xFF0B0E14u;
+				fb->pixels[y * fb->width + x] = lighting_apply(c, row_dist, sector_intensity, sector_tint, NULL, 0, wx, wy);
 			}
-			fb->pixels[y * fb->width + x] = c;
 		}
+		flush_lit_column_span(fb, x, simd, span, span_y, span_n, r_mul_i, g_mul_i, b_mul_i);
 	}
 }
 
@@ -773,6 +860,8 @@ static void draw_sector_floor_column(
 	LightColor sector_tint,
 	const PointLight* lights,
 	int light_count,
+	const SectorLightmap* lightmap,
+	const SectorFloorDecals* decals,
 	RaycastPerf* perf
 ) {
 	if (!fb || x < 0 || x >= fb->width) {
@@ -799,10 +888,17 @@ static void draw_sector_floor_column(
 		const float plane_uv_scale = 0.25f; // 1 repeat per 4 world units
 		int fy0 = y_top > y_horizon ? y_top : y_horizon;
 		int fy1 = y_bot;
-		const int light_step = 4;
+		const int light_step = PLANE_LIGHT_STEP;
+		const SimdKernels* simd = simd_kernels();
+		uint32_t span[PLANE_LIGHT_STEP];
+		int span_y[PLANE_LIGHT_STEP];
+		int span_n = 0;
 		int r_mul_i = 256;
 		int g_mul_i = 256;
 		int b_mul_i = 256;
+		const uint32_t* lit_row = NULL;
+		float inv_k = 1.0f / ((cam_z - floor_z) * proj_dist);
+		depth_spans_push_linear(g_frame_depth_spans, x, fy0, fy1, -half_h * inv_k, inv_k);
 		for (int y = fy0; y < fy1; y++) {
 			float denom = (float)y - half_h;
 			if (denom <= 0.001f) {
@@ -815,10 +911,15 @@ static void draw_sector_floor_column(
 			float wy = cam_y + dy * t;
 			float tu = fractf(wx * plane_uv_scale);
 			float tv = fractf(wy * plane_uv_scale);
-			uint32_t c = floor_tex ? texture_sample_nearest(floor_tex, tu, tv) : 0xFF121018u;
-			if (lights && light_count > 0) {
+			if ((lights && light_count > 0) || lightmap) {
 				if (((y - fy0) % light_step) == 0) {
-					LightColor mul = lighting_compute_multipliers(row_dist, sector_intensity, sector_tint, lights, light_count, wx, wy);
+					flush_lit_column_span(fb, x, simd, span, span_y, span_n, r_mul_i, g_mul_i, b_mul_i);
+					span_n = 0;
+					LightColor baked = {0.0f, 0.0f, 0.0f};
+					if (lightmap) {
+						baked = sector_lightmap_sample(lightmap, g_baked_light_gain, wx, wy);
+					}
+					LightColor mul = lighting_compute_multipliers_baked(row_dist, sector_intensity, sector_tint, lights, light_count, wx, wy, baked);
 					float r_mul = lighting_quantize_factor(mul.r);
 					float g_mul = lighting_quantize_factor(mul.g);
 					float b_mul = lighting_quantize_factor(mul.b);
@@ -843,21 +944,34 @@ static void draw_sector_floor_column(
 					if (b_mul_i > 256) {
 						b_mul_i = 256;
 					}
+					lit_row = palette_lit_row(floor_tex, r_mul_i, g_mul_i, b_mul_i);
 					if (perf) {
 						perf->lighting_apply_calls++;
 						perf->lighting_apply_light_iters += (uint64_t)light_count;
 					}
 				}
-				c = apply_lighting_mul_u8(c, r_mul_i, g_mul_i, b_mul_i);
+				// Decal texels are not palette indices, so they take the multiply path.
+				uint32_t decal = decals ? sector_floor_decals_sample(decals, wx, wy) : 0u;
+				if (lit_row && !decal) {
+					fb->pixels[y * fb->width + x] = lit_row[texture_sample_index_nearest(floor_tex, tu, tv)];
+					continue;
+				}
+				span[span_n] = decal ? decal : (floor_tex ? texture_sample_nearest(floor_tex, tu, tv) : 0xFF121018u);
+				span_y[span_n++] = y;
+				continue;
 			} else {
 				if (perf) {
 					perf->lighting_apply_calls++;
 					perf->lighting_apply_light_iters += 0;
 				}
-				c = lighting_apply(c, row_dist, sector_intensity, sector_tint, NULL, 0, wx, wy);
+				uint32_t c = decals ? sector_floor_decals_sample(decals, wx, wy) : 0u;
+				if (!c) {
+					c = floor_tex ? texture_sample_nearest(floor_tex, tu, tv) : 0xFF121018u;
+				}
+				fb->pixels[y * fb->width + x] = lighting_apply(c, row_dist, sector_intensity, sector_tint, NULL, 0, wx, wy);
 			}
-			fb->pixels[y * fb->width + x] = c;
 		}
+		flush_lit_column_span(fb, x, simd, span, span_y, span_n, r_mul_i, g_mul_i, b_mul_i);
 	}
 }
 
@@ -937,28 +1051,50 @@ static void render_wall_span_textured(
 		b_mul_i = 256;
 	}
 
+	// Paletted path: the light level picks a colormap row and texels are fetched as
+	// palette indices, so no per-pixel multiply.
+	const uint32_t* lit_row = palette_lit_row(tex, r_mul_i, g_mul_i, b_mul_i);
+
 	// Wall texture mapping: tile in world-space; do not scale with wall height.
 	// We derive world-space Z at each screen pixel and wrap it.
 	const float wall_uv_scale_u = 0.25f; // 1 repeat per 4 world units
 	const float wall_uv_scale_v = 0.25f; // 1 repeat per 4 world units
 	float uu = fractf(u_tex * wall_uv_scale_u);
+	TextureColumn tex_col;
+	bool has_col = tex && texture_column_nearest(tex, uu, &tex_col);
 	float yf0 = (float)y_top + 0.5f;
 	float z0 = cam_z + (half_h - yf0) * dist * inv_proj;
 	float dz = -dist * inv_proj;
 
-	for (int y = y_top; y < y_bot; y++) {
-		depth_pixels_write_min(out_depth_pixels, fb->width, x, y, dist);
-		float vv = fractf((z0 - tex_v_origin_z) * wall_uv_scale_v);
-		uint32_t c = tex ? texture_sample_nearest(tex, uu, vv) : base;
-		uint8_t a = (uint8_t)((c >> 24) & 0xFF);
-		uint8_t r = (uint8_t)((c >> 16) & 0xFF);
-		uint8_t g = (uint8_t)((c >> 8) & 0xFF);
-		uint8_t b = (uint8_t)(c & 0xFF);
-		int rr = (r * r_mul_i + 128) >> 8;
-		int gg = (g * g_mul_i + 128) >> 8;
-		int bb = (b * b_mul_i + 128) >> 8;
-		fb->pixels[y * fb->width + x] = ((uint32_t)a << 24) | ((uint32_t)clamp_u8(rr) << 16) | ((uint32_t)clamp_u8(gg) << 8) | (uint32_t)clamp_u8(bb);
-		z0 += dz;
+	depth_spans_push_const(g_frame_depth_spans, x, y_top, y_bot, dist);
+
+	// Sample a chunk of texels, light it in one SIMD call, then scatter down the column.
+	const SimdKernels* simd = simd_kernels();
+	uint32_t span[WALL_SPAN_CHUNK];
+	for (int y = y_top; y < y_bot;) {
+		int n = y_bot - y;
+		if (n > WALL_SPAN_CHUNK) {
+			n = WALL_SPAN_CHUNK;
+		}
+		for (int i = 0; i < n; i++) {
+			depth_pixels_write_min(out_depth_pixels, fb->width, x, y + i, dist);
+			float vv = fractf((z0 - tex_v_origin_z) * wall_uv_scale_v);
+			if (lit_row && has_col) {
+				span[i] = lit_row[texture_column_sample_index_nearest(&tex_col, vv)];
+			} else {
+				span[i] = has_col ? texture_column_sample_nearest(&tex_col, vv) : base;
+			}
+			z0 += dz;
+		}
+		if (!lit_row || !has_col) {
+			simd->mul_u8x3(span, span, n, b_mul_i, g_mul_i, r_mul_i);
+		}
+		uint32_t* dst = &fb->pixels[y * fb->width + x];
+		for (int i = 0; i < n; i++) {
+			*dst = span[i];
+			dst += fb->width;
+		}
+		y += n;
 	}
 }
 
@@ -980,11 +1116,13 @@ static void draw_sector_planes_column(
 	float ceil_z,
 	const Texture* floor_tex,
 	const Texture* ceil_tex,
-	const Texture* sky_tex,
+	const SkyCache* sky,
 	float sector_intensity,
 	LightColor sector_tint,
 	const PointLight* lights,
 	int light_count,
+	const SectorLightmap* lightmap,
+	const SectorFloorDecals* decals,
 	RaycastPerf* perf
 ) {
 	draw_sector_ceiling_column(
@@ -1003,11 +1141,12 @@ static void draw_sector_planes_column(
 		corr,
 		ceil_z,
 		ceil_tex,
-		sky_tex,
+		sky,
 		sector_intensity,
 		sector_tint,
 		lights,
 		light_count,
+		lightmap,
 		perf
 	);
 	draw_sector_floor_column(
@@ -1030,17 +1169,63 @@ static void draw_sector_planes_column(
 		sector_tint,
 		lights,
 		light_count,
+		lightmap,
+		decals,
 		perf
 	);
 }
 
+static void wall_endpoint_multipliers(
+	int wall_index,
+	int side,
+	Vertex a,
+	Vertex b,
+	const Camera* cam,
+	float sector_intensity,
+	LightColor sector_tint,
+	const PointLight* wall_lights,
+	int wall_light_count,
+	LightColor* out_v0,
+	LightColor* out_v1,
+	RaycastPerf* perf
+) {
+	WallLightCacheEntry* e = NULL;
+	int slot = wall_index * 2 + side;
+	if (perf) {
+		perf->wall_light_lookups++;
+	}
+	if (slot >= 0 && slot < g_wall_light_cache_cap) {
+		e = &g_wall_light_cache[slot];
+		if (e->stamp == g_wall_light_stamp) {
+			*out_v0 = e->mul_v0;
+			*out_v1 = e->mul_v1;
+			return;
+		}
+	}
+
+	float da = hypotf(a.x - cam->x, a.y - cam->y);
+	float db = hypotf(b.x - cam->x, b.y - cam->y);
+	*out_v0 = lighting_compute_multipliers(da, sector_intensity, sector_tint, wall_lights, wall_light_count, a.x, a.y);
+	*out_v1 = lighting_compute_multipliers(db, sector_intensity, sector_tint, wall_lights, wall_light_count, b.x, b.y);
+	if (perf) {
+		perf->wall_light_unique++;
+		perf->lighting_mul_calls += 2u;
+		perf->lighting_mul_light_iters += 2u * (uint64_t)(wall_light_count > 0 ? wall_light_count : 0);
+	}
+	if (e) {
+		e->stamp = g_wall_light_stamp;
+		e->mul_v0 = *out_v0;
+		e->mul_v1 = *out_v1;
+	}
+}
+
 static void render_column_textured_recursive(
 	Framebuffer* fb,
 	const World* world,
 	const Camera* cam,
 	TextureRegistry* texreg,
 	const AssetPaths* paths,
-	const Texture* sky_tex,
+	const SkyCache* sky,
 	const PointLight* plane_lights,
 	int plane_light_count,
 	const PointLight* wall_lights,
@@ -1086,19 +1271,24 @@ static void render_column_textured_recursive(
 	if (y_clip_top >= y_clip_bot) {
 		return;
 	}
+	if (g_visible_world == world) {
+		g_visible_sectors[sector] = 1u;
+	}
 
 	const Sector* s = &world->sectors[sector];
 	float sector_intensity = s->light;
 	LightColor sector_tint = s->light_color;
+	const SectorLightmap* plane_lm = plane_lightmaps_sector(g_frame_lightmaps, sector);
+	const SectorFloorDecals* plane_decals = floor_decals_sector(&world->floor_decals, sector);
 	const Texture* floor_tex = NULL;
 	const Texture* ceil_tex = NULL;
 	bool ceil_is_sky = is_sky_sentinel(s->ceil_tex);
 	if (texreg && paths) {
 		if (s->floor_tex[0] != '\0') {
-			floor_tex = texture_registry_get(texreg, paths, s->floor_tex);
+			floor_tex = texture_registry_get_layout(texreg, paths, s->floor_tex, TEXTURE_LAYOUT_MORTON);
 		}
 		if (s->ceil_tex[0] != '\0' && !ceil_is_sky) {
-			ceil_tex = texture_registry_get(texreg, paths, s->ceil_tex);
+			ceil_tex = texture_registry_get_layout(texreg, paths, s->ceil_tex, TEXTURE_LAYOUT_MORTON);
 		}
 	}
 
@@ -1134,11 +1324,13 @@ static void render_column_textured_recursive(
 			s->ceil_z,
 			floor_tex,
 			ceil_tex,
-			(ceil_is_sky ? sky_tex : NULL),
+			(ceil_is_sky ? sky : NULL),
 			sector_intensity,
 			sector_tint,
 			plane_lights,
 			plane_light_count,
+			plane_lm,
+			plane_decals,
 			perf
 		);
 		if (perf) {
@@ -1166,38 +1358,27 @@ static void render_column_textured_recursive(
 	float wall_len = hypotf(b.x - a.x, b.y - a.y);
 	float u_tex = u * wall_len;
 
-	// Per-vertex wall lighting multipliers (Gouraud). Compute once and reuse for spans.
-	float da = hypotf(a.x - cam->x, a.y - cam->y);
-	float db = hypotf(b.x - cam->x, b.y - cam->y);
-	LightColor wall_mul_v0 = lighting_compute_multipliers(
-		da,
-		sector_intensity,
-		sector_tint,
-		wall_lights,
-		wall_light_count,
-		a.x,
-		a.y
-	);
-	if (perf) {
-		perf->lighting_mul_calls++;
-		perf->lighting_mul_light_iters += (uint64_t)(wall_light_count > 0 ? wall_light_count : 0);
-	}
-	LightColor wall_mul_v1 = lighting_compute_multipliers(
-		db,
+	// Per-vertex wall lighting multipliers (Gouraud). Computed once per wall side per
+	// render pass; every other column hitting the same wall reuses them.
+	LightColor wall_mul_v0;
+	LightColor wall_mul_v1;
+	wall_endpoint_multipliers(
+		hit_wall,
+		w->front_sector == sector ? 0 : 1,
+		a,
+		b,
+		cam,
 		sector_intensity,
 		sector_tint,
 		wall_lights,
 		wall_light_count,
-		b.x,
-		b.y
+		&wall_mul_v0,
+		&wall_mul_v1,
+		perf
 	);
-	if (perf) {
-		perf->lighting_mul_calls++;
-		perf->lighting_mul_light_iters += (uint64_t)(wall_light_count > 0 ? wall_light_count : 0);
-	}
 	const Texture* wall_tex = NULL;
 	if (texreg && paths) {
-		wall_tex = texture_registry_get(texreg, paths, w->tex);
+		wall_tex = texture_registry_get_layout(texreg, paths, w->tex, TEXTURE_LAYOUT_COLUMN_MAJOR);
 	}
 	uint32_t base = 0xFFB0B0B0u;
 
@@ -1253,7 +1434,7 @@ static void render_column_textured_recursive(
 				cam,
 				texreg,
 				paths,
-				sky_tex,
+				sky,
 				plane_lights,
 				plane_light_count,
 				wall_lights,
@@ -1302,11 +1483,13 @@ static void render_column_textured_recursive(
 					s->ceil_z,
 					floor_tex,
 					ceil_tex,
-					(ceil_is_sky ? sky_tex : NULL),
+					(ceil_is_sky ? sky : NULL),
 					sector_intensity,
 					sector_tint,
 					plane_lights,
 					plane_light_count,
+					plane_lm,
+					plane_decals,
 					perf
 				);
 			}
@@ -1329,11 +1512,13 @@ static void render_column_textured_recursive(
 					s->ceil_z,
 					floor_tex,
 					ceil_tex,
-					(ceil_is_sky ? sky_tex : NULL),
+					(ceil_is_sky ? sky : NULL),
 					sector_intensity,
 					sector_tint,
 					plane_lights,
 					plane_light_count,
+					plane_lm,
+					plane_decals,
 					perf
 				);
 			}
@@ -1356,11 +1541,13 @@ static void render_column_textured_recursive(
 				s->ceil_z,
 				floor_tex,
 				ceil_tex,
-				(ceil_is_sky ? sky_tex : NULL),
+				(ceil_is_sky ? sky : NULL),
 				sector_intensity,
 				sector_tint,
 				plane_lights,
 				plane_light_count,
+				plane_lm,
+				plane_decals,
 				perf
 			);
 		}
@@ -1463,11 +1650,13 @@ static void render_column_textured_recursive(
 					s->ceil_z,
 					floor_tex,
 					ceil_tex,
-					(ceil_is_sky ? sky_tex : NULL),
+					(ceil_is_sky ? sky : NULL),
 					sector_intensity,
 					sector_tint,
 					plane_lights,
 					plane_light_count,
+					plane_lm,
+					plane_decals,
 					perf
 				);
 			}
@@ -1490,11 +1679,13 @@ static void render_column_textured_recursive(
 					s->ceil_z,
 					floor_tex,
 					ceil_tex,
-					(ceil_is_sky ? sky_tex : NULL),
+					(ceil_is_sky ? sky : NULL),
 					sector_intensity,
 					sector_tint,
 					plane_lights,
 					plane_light_count,
+					plane_lm,
+					plane_decals,
 					perf
 				);
 			}
@@ -1517,11 +1708,13 @@ static void render_column_textured_recursive(
 				s->ceil_z,
 				floor_tex,
 				ceil_tex,
-				(ceil_is_sky ? sky_tex : NULL),
+				(ceil_is_sky ? sky : NULL),
 				sector_intensity,
 				sector_tint,
 				plane_lights,
 				plane_light_count,
+				plane_lm,
+				plane_decals,
 				perf
 			);
 		}
@@ -1604,7 +1797,7 @@ static void render_column_textured_recursive(
 			cam,
 			texreg,
 			paths,
-			sky_tex,
+			sky,
 			plane_lights,
 			plane_light_count,
 			wall_lights,
@@ -1652,11 +1845,13 @@ static void render_column_textured_recursive(
 				s->ceil_z,
 				floor_tex,
 				ceil_tex,
-				(ceil_is_sky ? sky_tex : NULL),
+				(ceil_is_sky ? sky : NULL),
 				sector_intensity,
 				sector_tint,
 				plane_lights,
 				plane_light_count,
+				plane_lm,
+				plane_decals,
 				perf
 			);
 		}
@@ -1679,11 +1874,13 @@ static void render_column_textured_recursive(
 				s->ceil_z,
 				floor_tex,
 				ceil_tex,
-				(ceil_is_sky ? sky_tex : NULL),
+				(ceil_is_sky ? sky : NULL),
 				sector_intensity,
 				sector_tint,
 				plane_lights,
 				plane_light_count,
+				plane_lm,
+				plane_decals,
 				perf
 			);
 		}
@@ -1706,11 +1903,13 @@ static void render_column_textured_recursive(
 			s->ceil_z,
 			floor_tex,
 			ceil_tex,
-			(ceil_is_sky ? sky_tex : NULL),
+			(ceil_is_sky ? sky : NULL),
 			sector_intensity,
 			sector_tint,
 			plane_lights,
 			plane_light_count,
+			plane_lm,
+			plane_decals,
 			perf
 		);
 	}
@@ -1803,6 +2002,7 @@ static void raycast_render_textured_from_sector_internal(
 	const char* sky_filename,
 	float* out_depth,
 	float* out_depth_pixels,
+	DepthSpans* out_depth_spans,
 	int start_sector,
 	RaycastPerf* out_perf
 ) {
@@ -1820,6 +2020,9 @@ static void raycast_render_textured_from_sector_internal(
 			out_depth_pixels[i] = 1e30f;
 		}
 	}
+	if (out_depth_spans && fb) {
+		(void)depth_spans_begin(out_depth_spans, fb->width, fb->height);
+	}
 
 	if (!world || world->wall_count <= 0 || world->vertex_count <= 0) {
 		if (out_depth) {
@@ -1835,6 +2038,7 @@ static void raycast_render_textured_from_sector_internal(
 		}
 		return;
 	}
+	g_frame_depth_spans = out_depth_spans;
 
 	float angle0 = cam->angle_deg - cam->fov_deg * 0.5f;
 	float inv_w = fb->width > 1 ? (1.0f / (float)(fb->width - 1)) : 0.0f;
@@ -1850,11 +2054,17 @@ static void raycast_render_textured_from_sector_internal(
 	}
 	float cam_z = camera_z_for_sector(world, start, cam->z);
 	float cam_rad = deg_to_rad(cam->angle_deg);
-	const Texture* sky_tex = NULL;
+	const SkyCache* sky = NULL;
 	if (texreg && paths && sky_filename && sky_filename[0] != '\0') {
-		sky_tex = texture_registry_get(texreg, paths, sky_filename);
+		const Texture* sky_tex = texture_registry_get_layout(texreg, paths, sky_filename, TEXTURE_LAYOUT_COLUMN_MAJOR);
+		if (sky_cache_update(&g_sky_cache, sky_tex, cam->fov_deg, fb->width, fb->height)) {
+			sky = &g_sky_cache;
+		}
 	}
 
+	wall_light_cache_begin(world->wall_count);
+	visible_sectors_begin(world);
+
 	PointLight vis_lights_uncapped[MAX_VISIBLE_LIGHTS];
 	PointLight vis_lights_walls[MAX_VISIBLE_LIGHTS];
 	PointLight vis_lights_planes[MAX_VISIBLE_LIGHTS];
@@ -1870,11 +2080,20 @@ static void raycast_render_textured_from_sector_internal(
 	int vis_planes = 0;
 	if (g_point_lights_enabled) {
 		float t = (float)platform_time_seconds();
-		vis_uncapped = build_visible_lights_uncapped(vis_lights_uncapped, MAX_VISIBLE_LIGHTS, world, cam, t);
+		vis_uncapped = build_visible_lights_uncapped(vis_lights_uncapped, MAX_VISIBLE_LIGHTS, world, cam, t, 0);
 		memcpy(vis_lights_walls, vis_lights_uncapped, (size_t)vis_uncapped * sizeof(PointLight));
-		memcpy(vis_lights_planes, vis_lights_uncapped, (size_t)vis_uncapped * sizeof(PointLight));
 		vis_walls = limit_visible_lights(vis_lights_walls, vis_uncapped, MAX_ACTIVE_LIGHTS_WALLS, cam->x, cam->y);
-		vis_planes = limit_visible_lights(vis_lights_planes, vis_uncapped, MAX_ACTIVE_LIGHTS_PLANES, cam->x, cam->y);
+		const PlaneLightmaps* lm = &world->lightmaps;
+		if (lm->sectors && lm->baked_light_count > 0 && baked_light_gain_reserve(lm->baked_light_count)) {
+			// Static lights come from the lightmaps; only dynamic ones stay on the per-pixel plane path.
+			plane_lightmaps_frame_gains(lm, world, t, g_baked_light_gain);
+			g_frame_lightmaps = lm;
+			int vis_dynamic = build_visible_lights_uncapped(vis_lights_planes, MAX_VISIBLE_LIGHTS, world, cam, t, lm->baked_light_count);
+			vis_planes = limit_visible_lights(vis_lights_planes, vis_dynamic, MAX_ACTIVE_LIGHTS_PLANES, cam->x, cam->y);
+		} else {
+			memcpy(vis_lights_planes, vis_lights_uncapped, (size_t)vis_uncapped * sizeof(PointLight));
+			vis_planes = limit_visible_lights(vis_lights_planes, vis_uncapped, MAX_ACTIVE_LIGHTS_PLANES, cam->x, cam->y);
+		}
 		wall_lights_ptr = vis_lights_walls;
 		plane_lights_ptr = vis_lights_planes;
 	}
@@ -1895,6 +2114,9 @@ static void raycast_render_textured_from_sector_internal(
 		float dx = cosf(ray_rad);
 		float dy = sinf(ray_rad);
 		float corr = cosf(ray_rad - cam_rad);
+		if (sky) {
+			g_sky_cache.x_to_column[x] = sky_cache_column_for_angle(&g_sky_cache, ray_rad);
+		}
 
 		render_column_textured_recursive(
 			fb,
@@ -1902,7 +2124,7 @@ static void raycast_render_textured_from_sector_internal(
 			cam,
 			texreg,
 			paths,
-			sky_tex,
+			sky,
 			plane_lights_ptr,
 			vis_planes,
 			wall_lights_ptr,
@@ -1925,6 +2147,8 @@ static void raycast_render_textured_from_sector_internal(
 			out_perf
 		);
 	}
+	g_frame_lightmaps = NULL;
+	g_frame_depth_spans = NULL;
 
 	if (out_perf) {
 		out_perf->tex_lookup_ms = texperf.get_ms;
@@ -1957,7 +2181,7 @@ void raycast_render_textured_from_sector(
 	float* out_depth_pixels,
 	int start_sector
 ) {
-	raycast_render_textured_from_sector_internal(fb, world, cam, texreg, paths, sky_filename, out_depth, out_depth_pixels, start_sector, NULL);
+	raycast_render_textured_from_sector_internal(fb, world, cam, texreg, paths, sky_filename, out_depth, out_depth_pixels, NULL, start_sector, NULL);
 }
 
 void raycast_render_textured_from_sector_profiled(
@@ -1969,8 +2193,9 @@ void raycast_render_textured_from_sector_profiled(
 	const char* sky_filename,
 	float* out_depth,
 	float* out_depth_pixels,
+	DepthSpans* out_depth_spans,
 	int start_sector,
 	RaycastPerf* out_perf
 ) {
-	raycast_render_textured_from_sector_internal(fb, world, cam, texreg, paths, sky_filename, out_depth, out_depth_pixels, start_sector, out_perf);
+	raycast_render_textured_from_sector_internal(fb, world, cam, texreg, paths, sky_filename, out_depth, out_depth_pixels, out_depth_spans, start_sector, out_perf);
 }
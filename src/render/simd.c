@@ -0,0 +1,514 @@
+#include "render/simd.h"
+
+#include <stddef.h>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define MORTUM_SIMD_X86 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+// AVX2 kernels are compiled per-function (target attribute) so the rest of the
+// binary keeps the baseline ISA; they only run after a CPUID check.
+#define MORTUM_SIMD_AVX2 1
+#include <immintrin.h>
+#define MORTUM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#define MORTUM_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Scalar reference (also handles the tails of the vector kernels).
+
+static void mul_u8x3_scalar(uint32_t* dst, const uint32_t* src, int n, int mul0, int mul1, int mul2) {
+	for (int i = 0; i < n; i++) {
+		uint32_t c = src[i];
+		uint32_t b0 = ((c & 0xFFu) * (uint32_t)mul0 + 128u) >> 8;
+		uint32_t b1 = (((c >> 8) & 0xFFu) * (uint32_t)mul1 + 128u) >> 8;
+		uint32_t b2 = (((c >> 16) & 0xFFu) * (uint32_t)mul2 + 128u) >> 8;
+		dst[i] = (c & 0xFF000000u) | (b2 << 16) | (b1 << 8) | b0;
+	}
+}
+
+static inline uint32_t blend_over_px(uint32_t src, uint32_t dst) {
+	unsigned a = (unsigned)(src >> 24) & 0xFFu;
+	if (a == 0u) {
+		return dst;
+	}
+	if (a == 255u) {
+		return src;
+	}
+
+	unsigned inv_a = 255u - a;
+	unsigned out_r = (((unsigned)src & 0xFFu) * a + ((unsigned)dst & 0xFFu) * inv_a + 127u) / 255u;
+	unsigned out_g = (((unsigned)(src >> 8) & 0xFFu) * a + ((unsigned)(dst >> 8) & 0xFFu) * inv_a + 127u) / 255u;
+	unsigned out_b = (((unsigned)(src >> 16) & 0xFFu) * a + ((unsigned)(dst >> 16) & 0xFFu) * inv_a + 127u) / 255u;
+	unsigned out_a = (255u * a + ((unsigned)(dst >> 24) & 0xFFu) * inv_a + 127u) / 255u;
+	return (out_a << 24) | (out_b << 16) | (out_g << 8) | out_r;
+}
+
+static void blend_const_scalar(uint32_t* dst, int n, uint32_t abgr) {
+	for (int i = 0; i < n; i++) {
+		dst[i] = blend_over_px(abgr, dst[i]);
+	}
+}
+
+static void blend_over_scalar(uint32_t* dst, const uint32_t* src, int n) {
+	for (int i = 0; i < n; i++) {
+		dst[i] = blend_over_px(src[i], dst[i]);
+	}
+}
+
+static inline uint32_t rgb555_key(uint32_t c) {
+	return (((c >> 3) & 0x1Fu) << 10) | (((c >> 11) & 0x1Fu) << 5) | ((c >> 19) & 0x1Fu);
+}
+
+static void remap_rgb555_scalar(uint32_t* dst, const uint32_t* src, int n, const uint32_t* lut) {
+	for (int i = 0; i < n; i++) {
+		uint32_t c = src[i];
+		dst[i] = (lut[rgb555_key(c)] & 0x00FFFFFFu) | (c & 0xFF000000u);
+	}
+}
+
+static void add_u32_scalar(uint32_t* v, int n, uint32_t add) {
+	for (int i = 0; i < n; i++) {
+		v[i] += add;
+	}
+}
+
+static int find_ge_u32_scalar(const uint32_t* a, const uint32_t* b, int n) {
+	int i = 0;
+	while (i < n && a[i] < b[i]) {
+		i++;
+	}
+	return i;
+}
+
+// ---------------------------------------------------------------------------
+// SSE2 (baseline on x86-64). 4 pixels per iteration, channels widened to u16.
+//
+// All blend intermediates stay <= 255*255 + 127 = 65152, so floor(x / 255) is
+// computed exactly as (x + 1 + (x >> 8)) >> 8 without leaving 16-bit lanes.
+
+#if MORTUM_SIMD_X86
+static inline __m128i div255_epu16_sse2(__m128i x) {
+	return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+static void mul_u8x3_sse2(uint32_t* dst, const uint32_t* src, int n, int mul0, int mul1, int mul2) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mul = _mm_setr_epi16((short)mul0, (short)mul1, (short)mul2, 256, (short)mul0, (short)mul1, (short)mul2, 256);
+	const __m128i bias = _mm_set1_epi16(128);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i px = _mm_loadu_si128((const __m128i*)(const void*)(src + i));
+		__m128i lo = _mm_unpacklo_epi8(px, zero);
+		__m128i hi = _mm_unpackhi_epi8(px, zero);
+		lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(lo, mul), bias), 8);
+		hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(hi, mul), bias), 8);
+		_mm_storeu_si128((__m128i*)(void*)(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	mul_u8x3_scalar(dst + i, src + i, n - i, mul0, mul1, mul2);
+}
+
+static void blend_const_sse2(uint32_t* dst, int n, uint32_t abgr) {
+	unsigned a = (abgr >> 24) & 0xFFu;
+	if (a == 0u) {
+		return;
+	}
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i inv = _mm_set1_epi16((short)(255u - a));
+	// src * a + 127, per channel, for two pixels (the alpha lane uses 255 * a).
+	__m128i s = _mm_unpacklo_epi8(_mm_set1_epi32((int)(abgr | 0xFF000000u)), zero);
+	const __m128i sa = _mm_add_epi16(_mm_mullo_epi16(s, _mm_set1_epi16((short)a)), _mm_set1_epi16(127));
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i d = _mm_loadu_si128((const __m128i*)(const void*)(dst + i));
+		__m128i lo = div255_epu16_sse2(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv), sa));
+		__m128i hi = div255_epu16_sse2(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv), sa));
+		_mm_storeu_si128((__m128i*)(void*)(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	blend_const_scalar(dst + i, n - i, abgr);
+}
+
+static inline __m128i blend_half_sse2(__m128i s, __m128i d) {
+	// s/d: two pixels widened to u16. Broadcast each pixel's alpha to its 4 lanes,
+	// then weight the alpha lane by 255 so it computes a + dst_a * (255 - a) / 255.
+	__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+	__m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+	s = _mm_or_si128(s, _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255));
+	__m128i x = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, inv)), _mm_set1_epi16(127));
+	return div255_epu16_sse2(x);
+}
+
+static void blend_over_sse2(uint32_t* dst, const uint32_t* src, int n) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i amask = _mm_set1_epi32((int)0xFF000000u);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i s = _mm_loadu_si128((const __m128i*)(const void*)(src + i));
+		__m128i d = _mm_loadu_si128((const __m128i*)(const void*)(dst + i));
+		__m128i lo = blend_half_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+		__m128i hi = blend_half_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+		__m128i out = _mm_packus_epi16(lo, hi);
+		// Fully transparent source leaves dst untouched (including its alpha).
+		__m128i keep = _mm_cmpeq_epi32(_mm_and_si128(s, amask), zero);
+		out = _mm_or_si128(_mm_and_si128(keep, d), _mm_andnot_si128(keep, out));
+		_mm_storeu_si128((__m128i*)(void*)(dst + i), out);
+	}
+	blend_over_scalar(dst + i, src + i, n - i);
+}
+
+static inline __m128i rgb555_key_sse2(__m128i c) {
+	const __m128i m5 = _mm_set1_epi32(0x1F);
+	__m128i k0 = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(c, 3), m5), 10);
+	__m128i k1 = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(c, 11), m5), 5);
+	__m128i k2 = _mm_and_si128(_mm_srli_epi32(c, 19), m5);
+	return _mm_or_si128(_mm_or_si128(k0, k1), k2);
+}
+
+static void remap_rgb555_sse2(uint32_t* dst, const uint32_t* src, int n, const uint32_t* lut) {
+	// No gather on SSE2: keys are computed 4 at a time, lookups stay scalar.
+	const __m128i amask = _mm_set1_epi32((int)0xFF000000u);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i c = _mm_loadu_si128((const __m128i*)(const void*)(src + i));
+		uint32_t k[4];
+		_mm_storeu_si128((__m128i*)(void*)k, rgb555_key_sse2(c));
+		__m128i q = _mm_setr_epi32((int)lut[k[0]], (int)lut[k[1]], (int)lut[k[2]], (int)lut[k[3]]);
+		__m128i out = _mm_or_si128(_mm_andnot_si128(amask, q), _mm_and_si128(c, amask));
+		_mm_storeu_si128((__m128i*)(void*)(dst + i), out);
+	}
+	remap_rgb555_scalar(dst + i, src + i, n - i, lut);
+}
+
+static void add_u32_sse2(uint32_t* v, int n, uint32_t add) {
+	const __m128i d = _mm_set1_epi32((int)add);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(const void*)(v + i));
+		_mm_storeu_si128((__m128i*)(void*)(v + i), _mm_add_epi32(x, d));
+	}
+	add_u32_scalar(v + i, n - i, add);
+}
+
+static int find_ge_u32_sse2(const uint32_t* a, const uint32_t* b, int n) {
+	// Unsigned b > a via a signed compare on bias-flipped values.
+	const __m128i bias = _mm_set1_epi32((int)0x80000000u);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(const void*)(a + i)), bias);
+		__m128i y = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(const void*)(b + i)), bias);
+		if (_mm_movemask_epi8(_mm_cmpgt_epi32(y, x)) != 0xFFFF) {
+			break;
+		}
+	}
+	return i + find_ge_u32_scalar(a + i, b + i, n - i);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// AVX2: same math as SSE2, 8 pixels per iteration. Unpack/pack work per 128-bit
+// lane, which preserves pixel order. GCC does not insert vzeroupper for target("avx2")
+// functions, so each kernel clears the upper halves itself before the SSE2 tail;
+// otherwise every later SSE instruction in the caller pays the transition penalty.
+
+#if MORTUM_SIMD_AVX2
+MORTUM_TARGET_AVX2 static inline __m256i div255_epu16_avx2(__m256i x) {
+	return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+MORTUM_TARGET_AVX2 static void mul_u8x3_avx2(uint32_t* dst, const uint32_t* src, int n, int mul0, int mul1, int mul2) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i mul = _mm256_setr_epi16(
+		(short)mul0, (short)mul1, (short)mul2, 256, (short)mul0, (short)mul1, (short)mul2, 256,
+		(short)mul0, (short)mul1, (short)mul2, 256, (short)mul0, (short)mul1, (short)mul2, 256);
+	const __m256i bias = _mm256_set1_epi16(128);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i px = _mm256_loadu_si256((const __m256i*)(const void*)(src + i));
+		__m256i lo = _mm256_unpacklo_epi8(px, zero);
+		__m256i hi = _mm256_unpackhi_epi8(px, zero);
+		lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(lo, mul), bias), 8);
+		hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(hi, mul), bias), 8);
+		_mm256_storeu_si256((__m256i*)(void*)(dst + i), _mm256_packus_epi16(lo, hi));
+	}
+	_mm256_zeroupper();
+	mul_u8x3_sse2(dst + i, src + i, n - i, mul0, mul1, mul2);
+}
+
+MORTUM_TARGET_AVX2 static void blend_const_avx2(uint32_t* dst, int n, uint32_t abgr) {
+	unsigned a = (abgr >> 24) & 0xFFu;
+	if (a == 0u) {
+		return;
+	}
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i inv = _mm256_set1_epi16((short)(255u - a));
+	__m256i s = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)(abgr | 0xFF000000u)), zero);
+	const __m256i sa = _mm256_add_epi16(_mm256_mullo_epi16(s, _mm256_set1_epi16((short)a)), _mm256_set1_epi16(127));
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i d = _mm256_loadu_si256((const __m256i*)(const void*)(dst + i));
+		__m256i lo = div255_epu16_avx2(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv), sa));
+		__m256i hi = div255_epu16_avx2(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv), sa));
+		_mm256_storeu_si256((__m256i*)(void*)(dst + i), _mm256_packus_epi16(lo, hi));
+	}
+	_mm256_zeroupper();
+	blend_const_sse2(dst + i, n - i, abgr);
+}
+
+MORTUM_TARGET_AVX2 static inline __m256i blend_half_avx2(__m256i s, __m256i d) {
+	__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+	__m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+	s = _mm256_or_si256(s, _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255));
+	__m256i x = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, inv)), _mm256_set1_epi16(127));
+	return div255_epu16_avx2(x);
+}
+
+MORTUM_TARGET_AVX2 static void blend_over_avx2(uint32_t* dst, const uint32_t* src, int n) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i amask = _mm256_set1_epi32((int)0xFF000000u);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i s = _mm256_loadu_si256((const __m256i*)(const void*)(src + i));
+		__m256i d = _mm256_loadu_si256((const __m256i*)(const void*)(dst + i));
+		__m256i lo = blend_half_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+		__m256i hi = blend_half_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+		__m256i out = _mm256_packus_epi16(lo, hi);
+		__m256i keep = _mm256_cmpeq_epi32(_mm256_and_si256(s, amask), zero);
+		out = _mm256_blendv_epi8(out, d, keep);
+		_mm256_storeu_si256((__m256i*)(void*)(dst + i), out);
+	}
+	_mm256_zeroupper();
+	blend_over_sse2(dst + i, src + i, n - i);
+}
+
+MORTUM_TARGET_AVX2 static void remap_rgb555_avx2(uint32_t* dst, const uint32_t* src, int n, const uint32_t* lut) {
+	const __m256i m5 = _mm256_set1_epi32(0x1F);
+	const __m256i amask = _mm256_set1_epi32((int)0xFF000000u);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i c = _mm256_loadu_si256((const __m256i*)(const void*)(src + i));
+		__m256i k0 = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(c, 3), m5), 10);
+		__m256i k1 = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(c, 11), m5), 5);
+		__m256i k2 = _mm256_and_si256(_mm256_srli_epi32(c, 19), m5);
+		__m256i k = _mm256_or_si256(_mm256_or_si256(k0, k1), k2);
+		__m256i q = _mm256_i32gather_epi32((const int*)(const void*)lut, k, 4);
+		__m256i out = _mm256_or_si256(_mm256_andnot_si256(amask, q), _mm256_and_si256(c, amask));
+		_mm256_storeu_si256((__m256i*)(void*)(dst + i), out);
+	}
+	_mm256_zeroupper();
+	remap_rgb555_sse2(dst + i, src + i, n - i, lut);
+}
+
+MORTUM_TARGET_AVX2 static void add_u32_avx2(uint32_t* v, int n, uint32_t add) {
+	const __m256i d = _mm256_set1_epi32((int)add);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i x = _mm256_loadu_si256((const __m256i*)(const void*)(v + i));
+		_mm256_storeu_si256((__m256i*)(void*)(v + i), _mm256_add_epi32(x, d));
+	}
+	_mm256_zeroupper();
+	add_u32_sse2(v + i, n - i, add);
+}
+
+MORTUM_TARGET_AVX2 static int find_ge_u32_avx2(const uint32_t* a, const uint32_t* b, int n) {
+	const __m256i bias = _mm256_set1_epi32((int)0x80000000u);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(const void*)(a + i)), bias);
+		__m256i y = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(const void*)(b + i)), bias);
+		if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(y, x)) != -1) {
+			break;
+		}
+	}
+	_mm256_zeroupper();
+	return i + find_ge_u32_sse2(a + i, b + i, n - i);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// NEON (baseline on ARM64). Pixels are little-endian ABGR8888, so byte 0 of each
+// pixel is bits 0-7 and byte 3 is alpha.
+
+#if MORTUM_SIMD_NEON
+static inline uint16x8_t div255_u16_neon(uint16x8_t x) {
+	return vshrq_n_u16(vaddq_u16(vaddq_u16(x, vdupq_n_u16(1)), vshrq_n_u16(x, 8)), 8);
+}
+
+static void mul_u8x3_neon(uint32_t* dst, const uint32_t* src, int n, int mul0, int mul1, int mul2) {
+	const uint16_t mul_lanes[8] = {
+		(uint16_t)mul0, (uint16_t)mul1, (uint16_t)mul2, 256, (uint16_t)mul0, (uint16_t)mul1, (uint16_t)mul2, 256,
+	};
+	const uint16x8_t mul = vld1q_u16(mul_lanes);
+	const uint16x8_t bias = vdupq_n_u16(128);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		uint8x16_t px = vld1q_u8((const uint8_t*)(const void*)(src + i));
+		uint16x8_t lo = vmovl_u8(vget_low_u8(px));
+		uint16x8_t hi = vmovl_u8(vget_high_u8(px));
+		lo = vshrq_n_u16(vaddq_u16(vmulq_u16(lo, mul), bias), 8);
+		hi = vshrq_n_u16(vaddq_u16(vmulq_u16(hi, mul), bias), 8);
+		vst1q_u8((uint8_t*)(void*)(dst + i), vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+	}
+	mul_u8x3_scalar(dst + i, src + i, n - i, mul0, mul1, mul2);
+}
+
+static void blend_const_neon(uint32_t* dst, int n, uint32_t abgr) {
+	unsigned a = (abgr >> 24) & 0xFFu;
+	if (a == 0u) {
+		return;
+	}
+	const uint8x8_t inv = vdup_n_u8((uint8_t)(255u - a));
+	uint16x8_t sa[4];
+	for (int c = 0; c < 3; c++) {
+		sa[c] = vdupq_n_u16((uint16_t)(((abgr >> (8 * c)) & 0xFFu) * a + 127u));
+	}
+	sa[3] = vdupq_n_u16((uint16_t)(255u * a + 127u));
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		uint8x8x4_t d = vld4_u8((const uint8_t*)(const void*)(dst + i));
+		uint8x8x4_t out;
+		for (int c = 0; c < 4; c++) {
+			out.val[c] = vmovn_u16(div255_u16_neon(vmlal_u8(sa[c], d.val[c], inv)));
+		}
+		vst4_u8((uint8_t*)(void*)(dst + i), out);
+	}
+	blend_const_scalar(dst + i, n - i, abgr);
+}
+
+static void blend_over_neon(uint32_t* dst, const uint32_t* src, int n) {
+	const uint16x8_t bias = vdupq_n_u16(127);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		uint8x8x4_t s = vld4_u8((const uint8_t*)(const void*)(src + i));
+		uint8x8x4_t d = vld4_u8((const uint8_t*)(const void*)(dst + i));
+		uint8x8_t a = s.val[3];
+		uint8x8_t inv = vmvn_u8(a);
+		uint8x8_t keep = vceq_u8(a, vdup_n_u8(0));
+		uint8x8x4_t out;
+		for (int c = 0; c < 3; c++) {
+			uint16x8_t x = vaddq_u16(vmlal_u8(vmull_u8(s.val[c], a), d.val[c], inv), bias);
+			out.val[c] = vbsl_u8(keep, d.val[c], vmovn_u16(div255_u16_neon(x)));
+		}
+		uint16x8_t xa = vaddq_u16(vmlal_u8(vmull_u8(vdup_n_u8(255), a), d.val[3], inv), bias);
+		out.val[3] = vbsl_u8(keep, d.val[3], vmovn_u16(div255_u16_neon(xa)));
+		vst4_u8((uint8_t*)(void*)(dst + i), out);
+	}
+	blend_over_scalar(dst + i, src + i, n - i);
+}
+
+static void remap_rgb555_neon(uint32_t* dst, const uint32_t* src, int n, const uint32_t* lut) {
+	const uint32x4_t m5 = vdupq_n_u32(0x1F);
+	const uint32x4_t amask = vdupq_n_u32(0xFF000000u);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		uint32x4_t c = vld1q_u32(src + i);
+		uint32x4_t k0 = vshlq_n_u32(vandq_u32(vshrq_n_u32(c, 3), m5), 10);
+		uint32x4_t k1 = vshlq_n_u32(vandq_u32(vshrq_n_u32(c, 11), m5), 5);
+		uint32x4_t k2 = vandq_u32(vshrq_n_u32(c, 19), m5);
+		uint32_t k[4];
+		vst1q_u32(k, vorrq_u32(vorrq_u32(k0, k1), k2));
+		const uint32_t q_lanes[4] = {lut[k[0]], lut[k[1]], lut[k[2]], lut[k[3]]};
+		uint32x4_t q = vld1q_u32(q_lanes);
+		vst1q_u32(dst + i, vorrq_u32(vbicq_u32(q, amask), vandq_u32(c, amask)));
+	}
+	remap_rgb555_scalar(dst + i, src + i, n - i, lut);
+}
+
+static void add_u32_neon(uint32_t* v, int n, uint32_t add) {
+	const uint32x4_t d = vdupq_n_u32(add);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		vst1q_u32(v + i, vaddq_u32(vld1q_u32(v + i), d));
+	}
+	add_u32_scalar(v + i, n - i, add);
+}
+
+static int find_ge_u32_neon(const uint32_t* a, const uint32_t* b, int n) {
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		uint64x2_t ge = vreinterpretq_u64_u32(vcgeq_u32(vld1q_u32(a + i), vld1q_u32(b + i)));
+		if ((vgetq_lane_u64(ge, 0) | vgetq_lane_u64(ge, 1)) != 0u) {
+			break;
+		}
+	}
+	return i + find_ge_u32_scalar(a + i, b + i, n - i);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Dispatch.
+
+static const SimdKernels k_scalar = {SIMD_LEVEL_SCALAR, "scalar", mul_u8x3_scalar, blend_const_scalar, blend_over_scalar, remap_rgb555_scalar, add_u32_scalar, find_ge_u32_scalar};
+#if MORTUM_SIMD_X86
+static const SimdKernels k_sse2 = {SIMD_LEVEL_SSE2, "sse2", mul_u8x3_sse2, blend_const_sse2, blend_over_sse2, remap_rgb555_sse2, add_u32_sse2, find_ge_u32_sse2};
+#endif
+#if MORTUM_SIMD_AVX2
+static const SimdKernels k_avx2 = {SIMD_LEVEL_AVX2, "avx2", mul_u8x3_avx2, blend_const_avx2, blend_over_avx2, remap_rgb555_avx2, add_u32_avx2, find_ge_u32_avx2};
+#endif
+#if MORTUM_SIMD_NEON
+static const SimdKernels k_neon = {SIMD_LEVEL_NEON, "neon", mul_u8x3_neon, blend_const_neon, blend_over_neon, remap_rgb555_neon, add_u32_neon, find_ge_u32_neon};
+#endif
+
+static const SimdKernels* g_active;
+
+static const SimdKernels* kernels_for_level(SimdLevel level) {
+	switch (level) {
+		case SIMD_LEVEL_SCALAR:
+			return &k_scalar;
+#if MORTUM_SIMD_X86
+		case SIMD_LEVEL_SSE2:
+			return &k_sse2;
+#endif
+#if MORTUM_SIMD_AVX2
+		case SIMD_LEVEL_AVX2:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") ? &k_avx2 : NULL;
+#endif
+#if MORTUM_SIMD_NEON
+		case SIMD_LEVEL_NEON:
+			return &k_neon;
+#endif
+		default:
+			return NULL;
+	}
+}
+
+bool simd_level_supported(SimdLevel level) {
+	return kernels_for_level(level) != NULL;
+}
+
+bool simd_select(SimdLevel level) {
+	const SimdKernels* k = kernels_for_level(level);
+	if (!k) {
+		return false;
+	}
+	g_active = k;
+	return true;
+}
+
+const SimdKernels* simd_kernels(void) {
+	if (!g_active) {
+		const SimdLevel order[] = {SIMD_LEVEL_AVX2, SIMD_LEVEL_NEON, SIMD_LEVEL_SSE2, SIMD_LEVEL_SCALAR};
+		for (size_t i = 0; i < sizeof(order) / sizeof(order[0]) && !g_active; i++) {
+			g_active = kernels_for_level(order[i]);
+		}
+	}
+	return g_active;
+}
+
+const char* simd_level_name(SimdLevel level) {
+	switch (level) {
+		case SIMD_LEVEL_SCALAR:
+			return "scalar";
+		case SIMD_LEVEL_SSE2:
+			return "sse2";
+		case SIMD_LEVEL_AVX2:
+			return "avx2";
+		case SIMD_LEVEL_NEON:
+			return "neon";
+		default:
+			return "unknown";
+	}
+}
@@ -0,0 +1,93 @@
+#include "render/sky_cache.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+void sky_cache_init(SkyCache* self) {
+	memset(self, 0, sizeof(*self));
+}
+
+void sky_cache_destroy(SkyCache* self) {
+	if (!self) {
+		return;
+	}
+	free(self->pixels);
+	free(self->x_to_column);
+	memset(self, 0, sizeof(*self));
+}
+
+static bool sky_cache_key_matches(const SkyCache* self, const Texture* sky, float fov_deg, int fb_width, int fb_height) {
+	return self->pixels && self->source == sky && self->fov_deg == fov_deg && self->fb_width == fb_width && self->fb_height == fb_height;
+}
+
+bool sky_cache_update(SkyCache* self, const Texture* sky, float fov_deg, int fb_width, int fb_height) {
+	if (!self || !sky || !sky->pixels || sky->width <= 0 || sky->height <= 0 || fb_width <= 0 || fb_height <= 1 || fov_deg <= 0.0f) {
+		return false;
+	}
+	if (self->x_capacity < fb_width) {
+		int* xm = (int*)realloc(self->x_to_column, (size_t)fb_width * sizeof(int));
+		if (!xm) {
+			return false;
+		}
+		self->x_to_column = xm;
+		self->x_capacity = fb_width;
+	}
+	if (sky_cache_key_matches(self, sky, fov_deg, fb_width, fb_height)) {
+		return true;
+	}
+
+	float fov_rad = fov_deg * (float)M_PI / 180.0f;
+	int columns = (int)lroundf(2.0f * (float)M_PI * (float)fb_width / fov_rad);
+	if (columns < 1) {
+		columns = 1;
+	}
+	int height = fb_height / 2;
+	uint32_t* px = (uint32_t*)malloc((size_t)columns * (size_t)height * sizeof(uint32_t));
+	if (!px) {
+		return false;
+	}
+
+	// Same v mapping as the per-pixel path: screen y in [0, half_h] -> v in [0, 1].
+	float half_h = 0.5f * (float)fb_height;
+	float inv_half = 1.0f / half_h;
+	for (int c = 0; c < columns; c++) {
+		float u = ((float)c + 0.5f) / (float)columns;
+		TextureColumn src;
+		uint32_t* dst = &px[(size_t)c * (size_t)height];
+		if (!texture_column_nearest(sky, u, &src)) {
+			memset(dst, 0, (size_t)height * sizeof(uint32_t));
+			continue;
+		}
+		for (int y = 0; y < height; y++) {
+			dst[y] = texture_column_sample_nearest(&src, ((float)y + 0.5f) * inv_half);
+		}
+	}
+
+	free(self->pixels);
+	self->pixels = px;
+	self->columns = columns;
+	self->height = height;
+	self->source = sky;
+	self->fov_deg = fov_deg;
+	self->fb_width = fb_width;
+	self->fb_height = fb_height;
+	return true;
+}
+
+int sky_cache_column_for_angle(const SkyCache* self, float ang_rad) {
+	if (!self || self->columns <= 0) {
+		return 0;
+	}
+	// u = (ang + pi) / 2pi, wrapped into [0, 1) (matches atan2-based mapping).
+	float u = (ang_rad + (float)M_PI) / (2.0f * (float)M_PI);
+	u -= floorf(u);
+	int c = (int)(u * (float)self->columns);
+	if (c >= self->columns) {
+		c = self->columns - 1;
+	}
+	if (c < 0) {
+		c = 0;
+	}
+	return c;
+}
@@ -6,6 +6,8 @@
 
 #include "platform/time.h"
 
+#include "render/vga_palette.h"
+
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -73,20 +75,26 @@ void texture_registry_destroy(TextureRegistry* self) {
 		}
 		free(t->pixels);
 		t->pixels = NULL;
+		free(t->post_start);
+		free(t->posts);
+		free(t->indices);
 		free(t);
 		self->items[i] = NULL;
 	}
 	free(self->items);
+	free(self->requested);
 	memset(self, 0, sizeof(*self));
 }
 
-static Texture* registry_find(TextureRegistry* self, const char* filename) {
+// Entries are keyed by (filename, requested layout). The requested layout is kept
+// separately from Texture.layout because a texture may fall back to row-major.
+static Texture* registry_find(TextureRegistry* self, const char* filename, TextureLayout layout) {
 	for (int i = 0; i < self->count; i++) {
 		if (g_perf) {
 			g_perf->registry_string_compares++;
 		}
 		Texture* t = self->items[i];
-		if (!t) {
+		if (!t || self->requested[i] != layout) {
 			continue;
 		}
 		if (strncmp(t->name, filename, sizeof(t->name)) == 0) {
@@ -96,7 +104,126 @@ static Texture* registry_find(TextureRegistry* self, const char* filename) {
 	return NULL;
 }
 
-static Texture* registry_push(TextureRegistry* self) {
+static bool is_pow2(int v) {
+	return v > 0 && (v & (v - 1)) == 0;
+}
+
+// Reorders row-major texels in place (via a scratch copy) into `layout`.
+// Returns the layout actually applied.
+static TextureLayout texture_apply_layout(uint32_t* pixels, int w, int h, TextureLayout layout) {
+	if (!pixels || w <= 0 || h <= 0 || layout == TEXTURE_LAYOUT_ROW_MAJOR) {
+		return TEXTURE_LAYOUT_ROW_MAJOR;
+	}
+	if (layout == TEXTURE_LAYOUT_SPRITE_POSTS) {
+		layout = TEXTURE_LAYOUT_COLUMN_MAJOR;
+	}
+	if (layout == TEXTURE_LAYOUT_MORTON && (w != h || !is_pow2(w) || w > 65536)) {
+		return TEXTURE_LAYOUT_ROW_MAJOR;
+	}
+	size_t count = (size_t)w * (size_t)h;
+	uint32_t* src = (uint32_t*)malloc(count * sizeof(uint32_t));
+	if (!src) {
+		return TEXTURE_LAYOUT_ROW_MAJOR;
+	}
+	memcpy(src, pixels, count * sizeof(uint32_t));
+	for (int y = 0; y < h; y++) {
+		const uint32_t* row = &src[(size_t)y * (size_t)w];
+		for (int x = 0; x < w; x++) {
+			size_t di = 0;
+			if (layout == TEXTURE_LAYOUT_COLUMN_MAJOR) {
+				di = (size_t)x * (size_t)h + (size_t)y;
+			} else {
+				di = (size_t)(texture_morton_spread((uint32_t)x) | (texture_morton_spread((uint32_t)y) << 1));
+			}
+			pixels[di] = row[x];
+		}
+	}
+	free(src);
+	return layout;
+}
+
+static bool texel_is_opaque(uint32_t c) {
+	return (c & 0x00FFFFFFu) != 0x00FF00FFu && (c & 0xFF000000u) != 0u;
+}
+
+// Builds the opaque-run index of a column-major texture. Leaves posts NULL when the
+// texture is too tall for 16-bit runs or allocation fails (callers then fall back
+// to per-texel alpha tests).
+static void texture_build_posts(Texture* t) {
+	if (t->layout != TEXTURE_LAYOUT_COLUMN_MAJOR || t->height > UINT16_MAX) {
+		return;
+	}
+	int count = 0;
+	for (int x = 0; x < t->width; x++) {
+		const uint32_t* col = &t->pixels[(size_t)x * (size_t)t->height];
+		bool in_run = false;
+		for (int y = 0; y < t->height; y++) {
+			bool opaque = texel_is_opaque(col[y]);
+			count += (opaque && !in_run) ? 1 : 0;
+			in_run = opaque;
+		}
+	}
+	t->post_start = (int*)malloc(((size_t)t->width + 1u) * sizeof(int));
+	t->posts = (TexturePost*)malloc((size_t)(count > 0 ? count : 1) * sizeof(TexturePost));
+	if (!t->post_start || !t->posts) {
+		free(t->post_start);
+		free(t->posts);
+		t->post_start = NULL;
+		t->posts = NULL;
+		return;
+	}
+	int n = 0;
+	for (int x = 0; x < t->width; x++) {
+		const uint32_t* col = &t->pixels[(size_t)x * (size_t)t->height];
+		t->post_start[x] = n;
+		int y = 0;
+		while (y < t->height) {
+			if (!texel_is_opaque(col[y])) {
+				y++;
+				continue;
+			}
+			int top = y;
+			while (y < t->height && texel_is_opaque(col[y])) {
+				y++;
+			}
+			t->posts[n].top = (uint16_t)top;
+			t->posts[n].length = (uint16_t)(y - top);
+			n++;
+		}
+	}
+	t->post_start[t->width] = n;
+}
+
+static void texture_build_indices(Texture* t) {
+	if (!t->pixels || t->indices) {
+		return;
+	}
+	size_t count = (size_t)t->width * (size_t)t->height;
+	t->indices = (uint8_t*)malloc(count);
+	if (!t->indices) {
+		return;
+	}
+	for (size_t i = 0; i < count; i++) {
+		t->indices[i] = vga_palette_index_of(t->pixels[i]);
+	}
+}
+
+void texture_registry_set_indexed(TextureRegistry* self, bool indexed) {
+	if (!self || self->indexed == indexed) {
+		return;
+	}
+	self->indexed = indexed;
+	if (!indexed) {
+		return;
+	}
+	for (int i = 0; i < self->count; i++) {
+		if (self->items[i]) {
+			texture_build_indices(self->items[i]);
+		}
+	}
+}
+
+static Texture* registry_push(TextureRegistry* self, TextureLayout requested) {
 	if (self->count >= self->capacity) {
 		int new_cap = self->capacity == 0 ? 8 : self->capacity * 2;
 		Texture** n = (Texture**)realloc(self->items, (size_t)new_cap * sizeof(Texture*));
@@ -104,17 +231,28 @@ static Texture* registry_push(TextureRegistry* self) {
 			return NULL;
 		}
 		self->items = n;
+		// If this one fails, items is just longer than capacity; both stay usable.
+		TextureLayout* r = (TextureLayout*)realloc(self->requested, (size_t)new_cap * sizeof(TextureLayout));
+		if (!r) {
+			return NULL;
+		}
+		self->requested = r;
 		self->capacity = new_cap;
 	}
 	Texture* t = (Texture*)calloc(1, sizeof(Texture));
 	if (!t) {
 		return NULL;
 	}
+	self->requested[self->count] = requested;
 	self->items[self->count++] = t;
 	return t;
 }
 
 const Texture* texture_registry_get(TextureRegistry* self, const AssetPaths* paths, const char* filename) {
+	return texture_registry_get_layout(self, paths, filename, TEXTURE_LAYOUT_ROW_MAJOR);
+}
+
+const Texture* texture_registry_get_layout(TextureRegistry* self, const AssetPaths* paths, const char* filename, TextureLayout layout) {
 	double t0 = 0.0;
 	if (g_perf) {
 		g_perf->get_calls++;
@@ -127,7 +265,7 @@ const Texture* texture_registry_get(TextureRegistry* self, const AssetPaths* pat
 		return NULL;
 	}
 
-	Texture* existing = registry_find(self, filename);
+	Texture* existing = registry_find(self, filename, layout);
 	if (existing) {
 		// Cache negative lookups as entries with NULL pixels.
 		if (g_perf) {
@@ -192,7 +330,7 @@ const Texture* texture_registry_get(TextureRegistry* self, const AssetPaths* pat
 			sky_s,
 			fallback_s);
 		// Cache miss to avoid repeated disk I/O and log spam every frame.
-		Texture* miss = registry_push(self);
+		Texture* miss = registry_push(self, layout);
 		if (miss) {
 			strncpy(miss->name, filename, sizeof(miss->name) - 1);
 			miss->name[sizeof(miss->name) - 1] = '\0';
@@ -214,7 +352,7 @@ const Texture* texture_registry_get(TextureRegistry* self, const AssetPaths* pat
 	free(sky);
 	free(fallback);
 
-	Texture* t = registry_push(self);
+	Texture* t = registry_push(self, layout);
 	if (!t) {
 		image_destroy(&img);
 		if (g_perf) {
@@ -227,6 +365,13 @@ const Texture* texture_registry_get(TextureRegistry* self, const AssetPaths* pat
 	t->height = img.height;
 	t->pixels = img.pixels;
 	img.pixels = NULL;
+	t->layout = texture_apply_layout(t->pixels, t->width, t->height, layout);
+	if (layout == TEXTURE_LAYOUT_SPRITE_POSTS) {
+		texture_build_posts(t);
+	}
+	if (self->indexed) {
+		texture_build_indices(t);
+	}
 	strncpy(t->name, filename, sizeof(t->name) - 1);
 	t->name[sizeof(t->name) - 1] = '\0';
 	if (g_perf) {
@@ -245,5 +390,37 @@ uint32_t texture_sample_nearest(const Texture* t, float u, float v) {
 	int y = (int)(v * (float)(t->height - 1) + 0.5f);
 	x = clampi(x, 0, t->width - 1);
 	y = clampi(y, 0, t->height - 1);
-	return t->pixels[y * t->width + x];
+	return texture_texel(t, x, y);
+}
+
+uint8_t texture_sample_index_nearest(const Texture* t, float u, float v) {
+	if (!t || !t->indices || t->width <= 0 || t->height <= 0) {
+		return 0;
+	}
+	u = clampf(u, 0.0f, 1.0f);
+	v = clampf(v, 0.0f, 1.0f);
+	int x = clampi((int)(u * (float)(t->width - 1) + 0.5f), 0, t->width - 1);
+	int y = clampi((int)(v * (float)(t->height - 1) + 0.5f), 0, t->height - 1);
+	return t->indices[texture_texel_offset(t, x, y)];
+}
+
+bool texture_column_nearest(const Texture* t, float u, TextureColumn* out) {
+	if (!out) {
+		return false;
+	}
+	memset(out, 0, sizeof(*out));
+	if (!t || !t->pixels || t->width <= 0 || t->height <= 0) {
+		return false;
+	}
+	u = clampf(u, 0.0f, 1.0f);
+	int x = clampi((int)(u * (float)(t->width - 1) + 0.5f), 0, t->width - 1);
+	out->t = t;
+	out->x = x;
+	if (t->layout == TEXTURE_LAYOUT_COLUMN_MAJOR) {
+		out->col = &t->pixels[x * t->height];
+		if (t->indices) {
+			out->col_index = &t->indices[x * t->height];
+		}
+	}
+	return true;
 }
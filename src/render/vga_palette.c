@@ -1,5 +1,8 @@
 #include "render/vga_palette.h"
 
+#include "render/simd.h"
+
+#include <stdbool.h>
 #include <stddef.h>
 
 static inline uint8_t abgr_a(uint32_t abgr) {
@@ -84,46 +87,173 @@ static inline uint8_t expand5(uint8_t v5) {
 	return (uint8_t)((v5 << 3) | (v5 >> 2));
 }
 
+static inline uint8_t expand6(uint8_t v6) {
+	// 0..63 -> 0..255
+	return (uint8_t)((v6 << 2) | (v6 >> 4));
+}
+
+static uint8_t g_vga_pal[256][3];
+static uint32_t g_vga_pal_abgr[256];
+static bool g_vga_pal_ready = false;
+
 static uint32_t g_vga_lut_abgr[1u << 15];
 static bool g_vga_lut_ready = false;
 
+// Palette indices for the higher-precision keys (RGB565 / RGB666), built for
+// g_vga_lut_wide_bits only.
+static uint8_t g_vga_lut_wide[1u << 18];
+static int g_vga_lut_wide_bits = 0;
+
+static int g_vga_lut_bits = VGA_LUT_BITS_DEFAULT;
+
+// Lit colors per light level (see VGA_COLORMAP_LEVELS), as palette indices and
+// expanded to ABGR.
+static uint8_t g_vga_colormap[VGA_COLORMAP_LEVELS][256];
+static uint32_t g_vga_colormap_abgr[VGA_COLORMAP_LEVELS][256];
+static bool g_vga_colormap_ready = false;
+
+static void ensure_vga_pal(void) {
+	if (g_vga_pal_ready) {
+		return;
+	}
+	build_vga256_palette(g_vga_pal);
+	for (int p = 0; p < 256; p++) {
+		g_vga_pal_abgr[p] = abgr_pack(0xFFu, g_vga_pal[p][0], g_vga_pal[p][1], g_vga_pal[p][2]);
+	}
+	g_vga_pal_ready = true;
+}
+
+static inline void consider(uint8_t r, uint8_t g, uint8_t b, int p, int* best_d, uint8_t* best) {
+	int d = dist2_rgb(r, g, b, g_vga_pal[p][0], g_vga_pal[p][1], g_vga_pal[p][2]);
+	if (d < *best_d) {
+		*best_d = d;
+		*best = (uint8_t)p;
+	}
+}
+
+// Nearest palette entry, identical to a linear scan over all 256 entries (lowest
+// index wins ties) but using the palette's structure, ~20 distances instead of 256:
+// - the 16 EGA colors are tested directly
+// - the 6x6x6 cube is a separable grid, so its nearest entry is the nearest level
+//   per channel (levels are 51 apart, so a channel is never exactly between two)
+// - the distance to gray v is 3 * (v - mean)^2 + const, so the nearest ramp entry
+//   is within one step of the mean
+// Candidates are visited in index order so ties resolve like the scan.
+static uint8_t nearest_index(uint8_t r, uint8_t g, uint8_t b) {
+	int best_d = 0x7FFFFFFF;
+	uint8_t best = 0;
+	for (int p = 0; p < 16; p++) {
+		consider(r, g, b, p, &best_d, &best);
+	}
+	int r6 = ((int)r + 25) / 51;
+	int g6 = ((int)g + 25) / 51;
+	int b6 = ((int)b + 25) / 51;
+	consider(r, g, b, 16 + r6 * 36 + g6 * 6 + b6, &best_d, &best);
+	int sum = (int)r + (int)g + (int)b;
+	int gi = (sum * 23 + 382) / 765; // round(mean * 23 / 255)
+	int g0 = gi > 0 ? gi - 1 : 0;
+	int g1 = gi < 23 ? gi + 1 : 23;
+	for (int i = g0; i <= g1; i++) {
+		consider(r, g, b, 232 + i, &best_d, &best);
+	}
+	return best;
+}
+
 static void ensure_vga_lut(void) {
 	if (g_vga_lut_ready) {
 		return;
 	}
-
-	uint8_t pal[256][3];
-	build_vga256_palette(pal);
+	ensure_vga_pal();
 
 	for (unsigned idx = 0; idx < (1u << 15); idx++) {
 		uint8_t r5 = (uint8_t)((idx >> 10) & 31u);
 		uint8_t g5 = (uint8_t)((idx >> 5) & 31u);
 		uint8_t b5 = (uint8_t)(idx & 31u);
-		uint8_t r = expand5(r5);
-		uint8_t g = expand5(g5);
-		uint8_t b = expand5(b5);
+		g_vga_lut_abgr[idx] = g_vga_pal_abgr[nearest_index(expand5(r5), expand5(g5), expand5(b5))];
+	}
+
+	g_vga_lut_ready = true;
+}
+
+static void ensure_vga_lut_wide(int bits) {
+	if (g_vga_lut_wide_bits == bits) {
+		return;
+	}
+	ensure_vga_pal();
+
+	if (bits == 16) {
+		for (unsigned idx = 0; idx < (1u << 16); idx++) {
+			uint8_t r5 = (uint8_t)((idx >> 11) & 31u);
+			uint8_t g6 = (uint8_t)((idx >> 5) & 63u);
+			uint8_t b5 = (uint8_t)(idx & 31u);
+			g_vga_lut_wide[idx] = nearest_index(expand5(r5), expand6(g6), expand5(b5));
+		}
+	} else {
+		for (unsigned idx = 0; idx < (1u << 18); idx++) {
+			uint8_t r6 = (uint8_t)((idx >> 12) & 63u);
+			uint8_t g6 = (uint8_t)((idx >> 6) & 63u);
+			uint8_t b6 = (uint8_t)(idx & 63u);
+			g_vga_lut_wide[idx] = nearest_index(expand6(r6), expand6(g6), expand6(b6));
+		}
+	}
 
-		int best_d = 0x7FFFFFFF;
-		uint8_t best_r = 0, best_g = 0, best_b = 0;
+	g_vga_lut_wide_bits = bits;
+}
+
+static void ensure_vga_colormap(void) {
+	if (g_vga_colormap_ready) {
+		return;
+	}
+	ensure_vga_pal();
+
+	for (int level = 0; level < VGA_COLORMAP_LEVELS; level++) {
+		// Same rounding as the renderer's 8.8 multiply (simd mul_u8x3).
+		uint32_t mul = (uint32_t)level * (256u / (VGA_COLORMAP_LEVELS - 1));
 		for (int p = 0; p < 256; p++) {
-			uint8_t pr = pal[p][0];
-			uint8_t pg = pal[p][1];
-			uint8_t pb = pal[p][2];
-			int d = dist2_rgb(r, g, b, pr, pg, pb);
-			if (d < best_d) {
-				best_d = d;
-				best_r = pr;
-				best_g = pg;
-				best_b = pb;
-				if (d == 0) {
-					break;
-				}
-			}
+			uint8_t r = (uint8_t)((g_vga_pal[p][0] * mul + 128u) >> 8);
+			uint8_t g = (uint8_t)((g_vga_pal[p][1] * mul + 128u) >> 8);
+			uint8_t b = (uint8_t)((g_vga_pal[p][2] * mul + 128u) >> 8);
+			uint8_t lit = level == VGA_COLORMAP_LEVELS - 1 ? (uint8_t)p : nearest_index(r, g, b);
+			g_vga_colormap[level][p] = lit;
+			g_vga_colormap_abgr[level][p] = g_vga_pal_abgr[lit];
 		}
-		g_vga_lut_abgr[idx] = abgr_pack(0xFFu, best_r, best_g, best_b);
 	}
 
-	g_vga_lut_ready = true;
+	g_vga_colormap_ready = true;
+}
+
+const uint32_t* vga_palette_colors(void) {
+	ensure_vga_pal();
+	return g_vga_pal_abgr;
+}
+
+uint8_t vga_palette_index_of(uint32_t abgr) {
+	ensure_vga_pal();
+	return nearest_index(abgr_r(abgr), abgr_g(abgr), abgr_b(abgr));
+}
+
+void vga_palette_set_lut_bits(int bits) {
+	g_vga_lut_bits = (bits == 16 || bits == 18) ? bits : 15;
+}
+
+void vga_palette_prepare(void) {
+	if (g_vga_lut_bits == 15) {
+		ensure_vga_lut();
+	} else {
+		ensure_vga_lut_wide(g_vga_lut_bits);
+	}
+}
+
+const uint8_t* vga_colormap_indices(int level) {
+	ensure_vga_colormap();
+	level = level < 0 ? 0 : (level > VGA_COLORMAP_LEVELS - 1 ? VGA_COLORMAP_LEVELS - 1 : level);
+	return g_vga_colormap[level];
+}
+
+const uint32_t* vga_colormap_row(int level) {
+	ensure_vga_colormap();
+	level = level < 0 ? 0 : (level > VGA_COLORMAP_LEVELS - 1 ? VGA_COLORMAP_LEVELS - 1 : level);
+	return g_vga_colormap_abgr[level];
 }
 
 void vga_palette_apply(Framebuffer* fb) {
@@ -131,17 +261,39 @@ void vga_palette_apply(Framebuffer* fb) {
 		return;
 	}
 
-	ensure_vga_lut();
+	vga_palette_remap(fb->pixels, fb->pixels, (size_t)fb->width * (size_t)fb->height);
+}
 
-	size_t count = (size_t)fb->width * (size_t)fb->height;
-	for (size_t i = 0; i < count; i++) {
-		uint32_t p = fb->pixels[i];
-		uint8_t a = abgr_a(p);
-		uint8_t r5 = (uint8_t)(abgr_r(p) >> 3);
-		uint8_t g5 = (uint8_t)(abgr_g(p) >> 3);
-		uint8_t b5 = (uint8_t)(abgr_b(p) >> 3);
-		unsigned key = ((unsigned)r5 << 10) | ((unsigned)g5 << 5) | (unsigned)b5;
-		uint32_t q = g_vga_lut_abgr[key];
-		fb->pixels[i] = (q & 0x00FFFFFFu) | ((uint32_t)a << 24);
+void vga_palette_remap(uint32_t* dst, const uint32_t* src, size_t count) {
+	if (!dst || !src) {
+		return;
+	}
+	if (g_vga_lut_bits == 16) {
+		ensure_vga_lut_wide(16);
+		for (size_t i = 0; i < count; i++) {
+			uint32_t c = src[i];
+			unsigned key = ((c >> 3) & 0x1Fu) << 11 | ((c >> 10) & 0x3Fu) << 5 | ((c >> 19) & 0x1Fu);
+			dst[i] = (g_vga_pal_abgr[g_vga_lut_wide[key]] & 0x00FFFFFFu) | (c & 0xFF000000u);
+		}
+		return;
+	}
+	if (g_vga_lut_bits == 18) {
+		ensure_vga_lut_wide(18);
+		for (size_t i = 0; i < count; i++) {
+			uint32_t c = src[i];
+			unsigned key = ((c >> 2) & 0x3Fu) << 12 | ((c >> 10) & 0x3Fu) << 6 | ((c >> 18) & 0x3Fu);
+			dst[i] = (g_vga_pal_abgr[g_vga_lut_wide[key]] & 0x00FFFFFFu) | (c & 0xFF000000u);
+		}
+		return;
+	}
+	ensure_vga_lut();
+	const SimdKernels* k = simd_kernels();
+	// Kernel counts are int; go in chunks so huge buffers cannot overflow them.
+	while (count > 0) {
+		int n = count > (size_t)(1 << 24) ? (1 << 24) : (int)count;
+		k->remap_rgb555(dst, src, n, g_vga_lut_abgr);
+		dst += n;
+		src += n;
+		count -= (size_t)n;
 	}
 }
@@ -0,0 +1,358 @@
+// Offline benchmark for the SFX mixer (platform/sfx_mixer.h); needs no audio device.
+//
+// Mixes synthetic voices (mostly looping ambience, some one-shots that retire and are
+// restarted; stereo and mono int16 sources) into 1024-frame stereo buffers, as the SDL
+// callback does at 48 kHz, and reports the cost per buffer and as a share of the
+// buffer's real-time duration. The previous per-frame mixer (scan every slot, per-sample
+// end-of-sample test, separate clamp pass, stereo float32 samples) is kept here as the
+// reference: its output is checked against the new mixer first, and it is timed at the
+// old 16-voice limit for comparison. The check also plays one voice through a stream
+// ring that the benchmark refills between buffers, as the stream reader does. The new
+// mixer is driven through the command ring the way the game drives it: voices start with
+// a PLAY command, and every buffer each voice gets a gain and a pan update.
+//
+// Usage: make bench   (or build/bench_sfx_mixer [iterations])
+
+#include "platform/sfx_mixer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RATE 48000
+#define BENCH_BUFFER_FRAMES 1024
+#define BENCH_SOURCES 8
+
+typedef struct BenchSource {
+	int16_t* frames;     // as the game stores samples: int16, native channel count
+	uint8_t channels;
+	float* ref_frames;   // as the reference stores them: stereo float32
+	uint32_t frame_count;
+} BenchSource;
+
+// Stands in for the stream reader: loops a source into a ring.
+typedef struct BenchStream {
+	SfxStreamRing ring;
+	int16_t frames[4096 * 2];
+	const BenchSource* src;
+	uint32_t src_pos;
+} BenchStream;
+
+// State of one voice in the reference mixer.
+typedef struct RefVoice {
+	bool alive;
+	const BenchSource* src;
+	uint32_t frame_pos;
+	float gain;
+	bool looping;
+} RefVoice;
+
+static double now_seconds(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint32_t xorshift32(uint32_t* s) {
+	uint32_t x = *s;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*s = x;
+	return x;
+}
+
+// Lengths cover loops shorter than a buffer (several wraps per mix) up to multi-second ambience.
+static bool make_sources(BenchSource* out) {
+	const uint32_t lengths[BENCH_SOURCES] = {300u, 1500u, 4096u, 9000u, 24000u, 48000u, 96000u, 250000u};
+	uint32_t rng = 0xA5A5A5u;
+	for (int i = 0; i < BENCH_SOURCES; i++) {
+		uint8_t ch = (i % 3 == 1) ? 1u : 2u;
+		out[i].frame_count = lengths[i];
+		out[i].channels = ch;
+		out[i].frames = (int16_t*)malloc((size_t)lengths[i] * ch * sizeof(int16_t));
+		out[i].ref_frames = (float*)malloc((size_t)lengths[i] * 2u * sizeof(float));
+		if (!out[i].frames || !out[i].ref_frames) {
+			return false;
+		}
+		float hz = 110.0f * (float)(i + 1);
+		for (uint32_t f = 0; f < lengths[i]; f++) {
+			float t = (float)f / (float)BENCH_RATE;
+			float noise = (float)(xorshift32(&rng) & 0xFFFFu) / 65535.0f - 0.5f;
+			float l = 0.6f * sinf(6.2831853f * hz * t) + 0.2f * noise;
+			float r = 0.6f * cosf(6.2831853f * hz * t) - 0.2f * noise;
+			int16_t ql = (int16_t)lrintf(l * 32767.0f);
+			int16_t qr = ch == 2u ? (int16_t)lrintf(r * 32767.0f) : ql;
+			out[i].frames[f * ch] = ql;
+			if (ch == 2u) {
+				out[i].frames[f * ch + 1u] = qr;
+			}
+			out[i].ref_frames[f * 2u + 0u] = (float)ql / 32768.0f;
+			out[i].ref_frames[f * 2u + 1u] = (float)qr / 32768.0f;
+		}
+	}
+	return true;
+}
+
+// Voice i: every fourth is a one-shot, the rest loop; gains vary and some are silent.
+static void voice_params(int i, const BenchSource* sources, const BenchSource** src, float* gain, bool* looping) {
+	*src = &sources[(i * 5) % BENCH_SOURCES];
+	*gain = (i % 7 == 6) ? 0.0f : 0.15f + 0.05f * (float)(i % 5);
+	*looping = (i % 4) != 3;
+}
+
+static void ref_mix(RefVoice* voices, int voice_cap, float* out, int frames, float master) {
+	memset(out, 0, (size_t)frames * 2u * sizeof(float));
+	for (int vi = 0; vi < voice_cap; vi++) {
+		RefVoice* v = &voices[vi];
+		if (!v->alive) {
+			continue;
+		}
+		float gain = v->gain * master;
+		if (gain <= 0.0001f) {
+			continue;
+		}
+		uint32_t pos = v->frame_pos;
+		for (int of = 0; of < frames; of++) {
+			if (pos >= v->src->frame_count) {
+				if (v->looping) {
+					pos = 0;
+				} else {
+					v->alive = false;
+					break;
+				}
+			}
+			out[of * 2 + 0] += v->src->ref_frames[pos * 2u + 0u] * gain;
+			out[of * 2 + 1] += v->src->ref_frames[pos * 2u + 1u] * gain;
+			pos++;
+		}
+		v->frame_pos = pos;
+	}
+	for (int i = 0; i < frames * 2; i++) {
+		float x = out[i];
+		if (x > 1.0f) {
+			x = 1.0f;
+		} else if (x < -1.0f) {
+			x = -1.0f;
+		}
+		out[i] = x;
+	}
+}
+
+static void ref_start_all(RefVoice* voices, int count, const BenchSource* sources) {
+	for (int i = 0; i < count; i++) {
+		memset(&voices[i], 0, sizeof(voices[i]));
+		voice_params(i, sources, &voices[i].src, &voices[i].gain, &voices[i].looping);
+		voices[i].alive = true;
+	}
+}
+
+// Starts voice i on its source, or on `stream` when one is given.
+static void mixer_start_voice(SfxCommandRing* ring, int i, uint16_t generation, const BenchSource* sources, BenchStream* stream) {
+	const BenchSource* src = NULL;
+	float gain = 0.0f;
+	bool looping = false;
+	voice_params(i, sources, &src, &gain, &looping);
+	SfxCommand cmd;
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.kind = SFX_CMD_PLAY;
+	cmd.looping = looping;
+	cmd.voice = (uint16_t)i;
+	cmd.generation = generation;
+	cmd.value = gain;
+	cmd.src.channels = src->channels;
+	if (stream) {
+		cmd.src.stream = &stream->ring;
+		cmd.src.session = 1u;
+	} else {
+		cmd.src.frames = src->frames;
+		cmd.src.frame_count = src->frame_count;
+	}
+	(void)sfx_command_ring_push(ring, &cmd);
+}
+
+static void bench_stream_init(BenchStream* self, const BenchSource* src) {
+	memset(self->frames, 0, sizeof(self->frames));
+	self->ring.frames = self->frames;
+	self->ring.capacity = (uint32_t)(sizeof(self->frames) / sizeof(self->frames[0]) / 2u);
+	atomic_init(&self->ring.ready_session, 1u);
+	atomic_init(&self->ring.finished_session, 0u);
+	atomic_init(&self->ring.in_use, true);
+	atomic_init(&self->ring.underruns, 0u);
+	atomic_init(&self->ring.write_pos, 0u);
+	atomic_init(&self->ring.read_pos, 0u);
+	self->src = src;
+	self->src_pos = 0u;
+}
+
+// Tops the ring up, wrapping at the end of the source like a looping stream.
+static void bench_stream_fill(BenchStream* self) {
+	SfxStreamRing* r = &self->ring;
+	uint32_t ch = self->src->channels;
+	uint32_t wr = atomic_load(&r->write_pos);
+	uint32_t space = r->capacity - (wr - atomic_load(&r->read_pos));
+	for (uint32_t i = 0; i < space; i++) {
+		memcpy(&r->frames[((wr + i) & (r->capacity - 1u)) * ch], &self->src->frames[self->src_pos * ch], ch * sizeof(int16_t));
+		self->src_pos = (self->src_pos + 1u) % self->src->frame_count;
+	}
+	atomic_store(&r->write_pos, wr + space);
+}
+
+// Mixes the same audible voices through both mixers for a few seconds and compares.
+// Silent voices are left out: the reference freezes them, the new mixer advances them.
+// Voice STREAM_VOICE (looping, mono) plays through a stream ring.
+static bool verify(const BenchSource* sources) {
+	enum { VOICES = 24, STREAM_VOICE = 5 };
+	static RefVoice ref[VOICES];
+	static SfxMixer m;
+	static SfxCommandRing ring;
+	static BenchStream stream;
+	static float a[BENCH_BUFFER_FRAMES * 2];
+	static float b[BENCH_BUFFER_FRAMES * 2];
+	ref_start_all(ref, VOICES, sources);
+	sfx_mixer_init(&m);
+	sfx_command_ring_init(&ring);
+	bench_stream_init(&stream, ref[STREAM_VOICE].src);
+	for (int i = 0; i < VOICES; i++) {
+		if (ref[i].gain <= 0.0f) {
+			ref[i].alive = false;
+			continue;
+		}
+		mixer_start_voice(&ring, i, 1u, sources, i == STREAM_VOICE ? &stream : NULL);
+	}
+	(void)sfx_mixer_drain(&m, &ring);
+	// Odd buffer sizes put wraps and one-shot ends at arbitrary offsets.
+	const int sizes[] = {1024, 333, 7, 1000, 64, 517};
+	for (int it = 0; it < 120; it++) {
+		int n = sizes[it % (int)(sizeof(sizes) / sizeof(sizes[0]))];
+		ref_mix(ref, VOICES, a, n, 0.8f);
+		bench_stream_fill(&stream);
+		sfx_mixer_mix(&m, b, n, 0.8f);
+		for (int i = 0; i < n * 2; i++) {
+			if (fabsf(a[i] - b[i]) > 1e-5f) {
+				fprintf(stderr, "sfx mixer mismatch (buffer %d, sample %d): %f vs %f\n", it, i, (double)a[i], (double)b[i]);
+				return false;
+			}
+		}
+		for (int i = 0; i < VOICES; i++) {
+			// The reference only retires a one-shot on the buffer after its last frame.
+			bool ref_live = ref[i].alive && (ref[i].looping || ref[i].frame_pos < ref[i].src->frame_count);
+			if (ref[i].gain > 0.0f && ref_live == sfx_mixer_voice_ended(&m, (uint16_t)i, 1u)) {
+				fprintf(stderr, "sfx mixer voice %d lifetime mismatch (buffer %d)\n", i, it);
+				return false;
+			}
+		}
+	}
+	if (atomic_load(&stream.ring.underruns) != 0u || !atomic_load(&stream.ring.in_use)) {
+		fprintf(stderr, "sfx mixer stream voice underran or was released\n");
+		return false;
+	}
+	sfx_mixer_stop(&m, (uint16_t)STREAM_VOICE);
+	if (atomic_load(&stream.ring.in_use)) {
+		fprintf(stderr, "sfx mixer kept the stream after the voice stopped\n");
+		return false;
+	}
+	return true;
+}
+
+static void report(const char* name, int voices, int iters, double seconds) {
+	double us = seconds / (double)iters * 1e6;
+	double budget_us = (double)BENCH_BUFFER_FRAMES / (double)BENCH_RATE * 1e6;
+	printf("%-9s %3d voices  %8.2f us/buffer  %6.3f%% of real time\n", name, voices, us, us / budget_us * 100.0);
+}
+
+static double bench_reference(const BenchSource* sources, int voices, int iters, float* out) {
+	static RefVoice ref[SFX_MAX_VOICES > 16 ? SFX_MAX_VOICES : 16];
+	ref_start_all(ref, voices, sources);
+	double t0 = now_seconds();
+	for (int it = 0; it < iters; it++) {
+		ref_mix(ref, voices, out, BENCH_BUFFER_FRAMES, 0.8f);
+		// Restart finished one-shots so the voice count stays constant.
+		for (int i = 0; i < voices; i++) {
+			if (!ref[i].alive) {
+				ref[i].alive = true;
+				ref[i].frame_pos = 0u;
+			}
+		}
+	}
+	return now_seconds() - t0;
+}
+
+static double bench_mixer(const BenchSource* sources, int voices, int iters, float* out) {
+	static SfxMixer m;
+	static SfxCommandRing ring;
+	static uint16_t generation[SFX_MAX_VOICES];
+	sfx_mixer_init(&m);
+	sfx_command_ring_init(&ring);
+	for (int i = 0; i < voices; i++) {
+		generation[i] = 1u;
+		mixer_start_voice(&ring, i, generation[i], sources, NULL);
+	}
+	double t0 = now_seconds();
+	for (int it = 0; it < iters; it++) {
+		(void)sfx_mixer_drain(&m, &ring);
+		sfx_mixer_mix(&m, out, BENCH_BUFFER_FRAMES, 0.8f);
+		for (int i = 0; i < voices; i++) {
+			if (sfx_mixer_voice_ended(&m, (uint16_t)i, generation[i])) {
+				generation[i]++;
+				mixer_start_voice(&ring, i, generation[i], sources, NULL);
+				continue;
+			}
+			SfxCommand cmd;
+			memset(&cmd, 0, sizeof(cmd));
+			cmd.voice = (uint16_t)i;
+			cmd.generation = generation[i];
+			cmd.kind = SFX_CMD_SET_GAIN;
+			cmd.value = 0.2f + 0.1f * (float)((it + i) & 3);
+			(void)sfx_command_ring_push(&ring, &cmd);
+			cmd.kind = SFX_CMD_SET_PAN;
+			cmd.value = (float)((it + i) % 9 - 4) * 0.25f;
+			(void)sfx_command_ring_push(&ring, &cmd);
+		}
+	}
+	return now_seconds() - t0;
+}
+
+int main(int argc, char** argv) {
+	int iters = 2000;
+	if (argc > 1) {
+		iters = atoi(argv[1]);
+		if (iters <= 0) {
+			iters = 2000;
+		}
+	}
+	BenchSource sources[BENCH_SOURCES];
+	memset(sources, 0, sizeof(sources));
+	static float out[BENCH_BUFFER_FRAMES * 2];
+	int rc = 0;
+	if (!make_sources(sources)) {
+		fprintf(stderr, "out of memory\n");
+		rc = 1;
+	} else if (!verify(sources)) {
+		rc = 1;
+	} else {
+		size_t s16_bytes = 0;
+		size_t f32_bytes = 0;
+		for (int i = 0; i < BENCH_SOURCES; i++) {
+			s16_bytes += (size_t)sources[i].frame_count * sources[i].channels * sizeof(int16_t);
+			f32_bytes += (size_t)sources[i].frame_count * 2u * sizeof(float);
+		}
+		printf("sfx mixer: %d-frame stereo buffers at %d Hz\n", BENCH_BUFFER_FRAMES, BENCH_RATE);
+		printf("sample memory: %zu KB int16 (native channels), %zu KB as stereo float32\n", s16_bytes / 1024u, f32_bytes / 1024u);
+		report("reference", 16, iters, bench_reference(sources, 16, iters, out));
+		const int counts[] = {16, 32, SFX_MAX_VOICES};
+		for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+			if (i > 0 && counts[i] == counts[i - 1]) {
+				continue;
+			}
+			report("mixer", counts[i], iters, bench_mixer(sources, counts[i], iters, out));
+		}
+	}
+	for (int i = 0; i < BENCH_SOURCES; i++) {
+		free(sources[i].frames);
+		free(sources[i].ref_frames);
+	}
+	return rc;
+}